@@ -2,85 +2,60 @@
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+#include "ingress-filter.h"
+#include "spoof-flood-app.h"
 
 using namespace ns3;
 
 /* ============================================================
- * TRUE INGRESS FILTER (DETECTION ONLY)
+ * INGRESS FILTER REPORT
  * ============================================================ */
-static void IngressFilterRx (
+// The filtering itself lives in ingress-filter.h; this only reports what
+// it caught.
+static void SpoofedRx (
   Ptr<const Packet> packet,
-  Ptr<Ipv4> ipv4,
+  const Ipv4Header &ip,
   uint32_t interface)
 {
-  // Only attacker-facing interface (router interface 1)
-  if (interface != 1)
-    return;
-
-  Ptr<Packet> p = packet->Copy ();
-  Ipv4Header ip;
-  if (!p->PeekHeader (ip))
-    return;
-
-  // Only UDP packets (our attacker traffic)
-  if (ip.GetProtocol () != 17)
-    return;
-
-  Ipv4Address src = ip.GetSource ();
-
-  // Ignore router-originated packets
-  if (ipv4->IsDestinationAddress (src, interface))
-    return;
-
-  // Interface subnet
-  Ipv4InterfaceAddress ifAddr =
-      ipv4->GetAddress (interface, 0);
-
-  Ipv4Address ifaceSubnet =
-      ifAddr.GetLocal ().CombineMask (ifAddr.GetMask ());
-
-  // TRUE ingress filtering rule
-  if (src.CombineMask (ifAddr.GetMask ()) != ifaceSubnet)
-    {
-      std::cout << Simulator::Now ().GetSeconds ()
-                << "s  INGRESS FILTER: DETECTED spoofed packet from "
-                << src
-                << " on interface "
-                << interface
-                << std::endl;
-    }
-}
-
-/* ============================================================
- * SEND SPOOFED PACKETS (RAW SOCKET)
- * ============================================================ */
-static void
-SendSpoofedPacket (
-  Ptr<Socket> socket,
-  Ipv4Address spoofedSrc,
-  Ipv4Address dst)
-{
-  Ptr<Packet> pkt = Create<Packet> (512);
-
-  Ipv4Header ip;
-  ip.SetSource (spoofedSrc);
-  ip.SetDestination (dst);
-  ip.SetProtocol (17); // UDP
-  ip.SetPayloadSize (512);
-  ip.SetTtl (64);
-
-  pkt->AddHeader (ip);
-  socket->SendTo (pkt, 0, InetSocketAddress (dst, 9));
+  std::cout << Simulator::Now ().GetSeconds ()
+            << "s  INGRESS FILTER: spoofed packet from "
+            << ip.GetSource ()
+            << " on interface "
+            << interface
+            << std::endl;
 }
 
 /* ============================================================
  * MAIN
  * ============================================================ */
-int main ()
+int main (int argc, char *argv[])
 {
+  bool enforce = true;
+
+  // Optional DDoS: extra attackers flooding with random spoofed sources
+  uint32_t floodAttackers = 0;
+  double floodRate = 10000;            // packets/s per attacker
+  std::string floodPattern = "constant";
+  std::string floodSources = "random";
+  uint32_t floodPool = 4096;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("enforce", "Drop spoofed packets (false = detect only)", enforce);
+  cmd.AddValue ("floodAttackers", "Extra flooding attacker nodes", floodAttackers);
+  cmd.AddValue ("floodRate", "Packets per second per flooding attacker", floodRate);
+  cmd.AddValue ("floodPattern", "constant, poisson or pulse", floodPattern);
+  cmd.AddValue ("floodSources", "fixed, pool or random spoofed sources", floodSources);
+  cmd.AddValue ("floodPool", "Spoofed source addresses per flooding attacker", floodPool);
+  cmd.Parse (argc, argv);
+
   NodeContainer nodes;
   nodes.Create (3); // 0=attacker, 1=router, 2=victim
 
+  NodeContainer flooders;
+  flooders.Create (floodAttackers);
+
   PointToPointHelper p2p;
   p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
   p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
@@ -90,6 +65,10 @@ int main ()
   NetDeviceContainer d12 =
       p2p.Install (nodes.Get (1), nodes.Get (2));
 
+  std::vector<NetDeviceContainer> dFlood;
+  for (uint32_t i = 0; i < floodAttackers; i++)
+    dFlood.push_back (p2p.Install (flooders.Get (i), nodes.Get (1)));
+
   InternetStackHelper internet;
   internet.InstallAll ();
 
@@ -103,49 +82,102 @@ int main ()
   addr.SetBase ("10.1.2.0", "255.255.255.0");
   Ipv4InterfaceContainer if12 = addr.Assign (d12);
 
+  // Flooding attackers ↔ Router: 10.3.x.0/24
+  addr.SetBase ("10.3.1.0", "255.255.255.0");
+  for (auto &d : dFlood)
+    {
+      addr.Assign (d);
+      addr.NewNetwork ();
+    }
+
   Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
   /* Attach ingress filter to router */
-  Ptr<Ipv4> ipv4Router =
-      nodes.Get (1)->GetObject<Ipv4> ();
-      
- //It connects your function IngressFilterRx() to the router’s IPv4 receive event.So whenever any IPv4 packet is received by the router, your function is automatically called.
-  ipv4Router->TraceConnectWithoutContext (
-      "Rx",
-      MakeCallback (&IngressFilterRx));
-
-  /* RAW socket on attacker */
-  Ptr<Socket> raw =
-      Socket::CreateSocket (
-          nodes.Get (0),
-          Ipv4RawSocketFactory::GetTypeId ());
-
-  raw->SetAttribute ("Protocol", UintegerValue (17));
-  raw->SetAttribute ("IpHeaderInclude", BooleanValue (true));
-  raw->BindToNetDevice (d01.Get (0));
-
-  /* Schedule spoofed packets */
-  for (double t = 1.0; t <= 2.0; t += 0.2)
+  // BCP38 on every attacker-facing interface: only sources inside that
+  // link's own subnet may enter there.
+  Ptr<Ipv4> ipv4Router = nodes.Get (1)->GetObject<Ipv4> ();
+  Ptr<IngressFilter> filter =
+      InstallIngressFilter (nodes.Get (1), enforce);
+  filter->EnableInterface (
+      ipv4Router->GetInterfaceForDevice (d01.Get (1)));
+  for (auto &d : dFlood)
+    filter->EnableInterface (
+        ipv4Router->GetInterfaceForDevice (d.Get (1)));
+
+  // Per-packet report only for the small demo; floods just get counters
+  if (floodAttackers == 0)
+    filter->TraceConnectWithoutContext (
+        "Spoofed",
+        MakeCallback (&SpoofedRx));
+
+  /* Victim */
+  PacketSinkHelper sinkHelper (
+      "ns3::UdpSocketFactory",
+      InetSocketAddress (Ipv4Address::GetAny (), 9));
+  ApplicationContainer sinkApp = sinkHelper.Install (nodes.Get (2));
+  sinkApp.Start (Seconds (0.0));
+
+  /* Spoofed packets from attacker 0 (raw socket, IP header included) */
+  // Every 0.2 s from 1.0 s to 2.0 s: same-subnet spoof (allowed) and,
+  // 0.1 s later, a victim-subnet spoof (filtered)
+  Ptr<SpoofedFloodApplication> allowed =
+      CreateObject<SpoofedFloodApplication> ();
+  allowed->SetAttribute ("Remote", Ipv4AddressValue (if12.GetAddress (1)));
+  allowed->SetAttribute ("SpoofedSource", Ipv4AddressValue ("10.1.1.10"));
+  allowed->SetAttribute ("PacketRate", DoubleValue (5));
+  allowed->SetAttribute ("MaxPackets", UintegerValue (6));
+  allowed->SetAttribute ("Device", PointerValue (d01.Get (0)));
+  allowed->SetStartTime (Seconds (1.0));
+  nodes.Get (0)->AddApplication (allowed);
+
+  Ptr<SpoofedFloodApplication> spoofed =
+      CreateObject<SpoofedFloodApplication> ();
+  spoofed->SetAttribute ("Remote", Ipv4AddressValue (if12.GetAddress (1)));
+  spoofed->SetAttribute ("SpoofedSource", Ipv4AddressValue ("10.1.2.10"));
+  spoofed->SetAttribute ("PacketRate", DoubleValue (5));
+  spoofed->SetAttribute ("MaxPackets", UintegerValue (6));
+  spoofed->SetAttribute ("Device", PointerValue (d01.Get (0)));
+  spoofed->SetStartTime (Seconds (1.1));
+  nodes.Get (0)->AddApplication (spoofed);
+
+  /* Flooding attackers */
+  uint64_t floodSent = 0;
+  std::vector<Ptr<SpoofedFloodApplication>> floods;
+  for (uint32_t i = 0; i < floodAttackers; i++)
     {
-      // Same subnet spoof → allowed
-      Simulator::Schedule (
-          Seconds (t),
-          &SendSpoofedPacket,
-          raw,
-          Ipv4Address ("10.1.1.10"),
-          if12.GetAddress (1));
-
-      // Different subnet spoof → detected
-      Simulator::Schedule (
-          Seconds (t + 0.1),
-          &SendSpoofedPacket,
-          raw,
-          Ipv4Address ("10.1.2.10"),
-          if12.GetAddress (1));
+      Ptr<SpoofedFloodApplication> app =
+          CreateObject<SpoofedFloodApplication> ();
+      app->SetAttribute ("Remote", Ipv4AddressValue (if12.GetAddress (1)));
+      app->SetAttribute ("PacketRate", DoubleValue (floodRate));
+      app->SetAttribute ("Pattern", StringValue (floodPattern));
+      app->SetAttribute ("SourceMode", StringValue (floodSources));
+      app->SetAttribute ("PoolSize", UintegerValue (floodPool));
+      app->SetAttribute ("Device", PointerValue (dFlood[i].Get (0)));
+      app->SetStartTime (Seconds (1.0));
+      app->SetStopTime (Seconds (2.0));
+      flooders.Get (i)->AddApplication (app);
+      floods.push_back (app);
     }
 
+  // Fixed streams: the spoofed pools and gaps depend only on --RngRun
+  int64_t stream = 1;
+  stream += allowed->AssignStreams (stream);
+  stream += spoofed->AssignStreams (stream);
+  for (auto &app : floods)
+    stream += app->AssignStreams (stream);
+
   Simulator::Stop (Seconds (3.0));
   Simulator::Run ();
+
+  for (auto &app : floods)
+    floodSent += app->GetSent ();
+
+  filter->PrintCounters (std::cout);
+  std::cout << "Sent: " << allowed->GetSent () + spoofed->GetSent ()
+            << " demo + " << floodSent << " flood packets, victim received "
+            << DynamicCast<PacketSink> (sinkApp.Get (0))->GetTotalRx () / 512
+            << " packets" << std::endl;
+
   Simulator::Destroy ();
 
   return 0;
@@ -8,85 +8,40 @@
 #include "ns3/netanim-module.h"
 #include "ns3/traffic-control-module.h"
 
+#include "dumbbell-helper.h"
+#include "drop-logger.h"
+#include "stats-registry.h"
+
 using namespace ns3;
 using namespace std;
 
-/* ---------- TX COUNTERS ---------- */
-uint64_t client1TxPackets = 0;
-uint64_t client2TxPackets = 0;
-
-/* ---------- APP TX TRACE ---------- */
-void
-Client1TxTrace (Ptr<const Packet> packet)
-{
-    client1TxPackets++;
-}
-
-void
-Client2TxTrace (Ptr<const Packet> packet)
-{
-    client2TxPackets++;
-}
-
-/* ---------- QUEUE DROP TRACE ---------- */
-uint64_t totalQueueDrops = 0;
-
-void
-QueueDiscDropTrace (Ptr<const QueueDiscItem> item)
-{
-    totalQueueDrops++;
-
-    cout << "[QUEUE DROP] Time = "
-         << Simulator::Now().GetSeconds()
-         << " s, Packet Size = "
-         << item->GetPacket()->GetSize()
-         << " bytes" << endl;
-}
-
 int
 main (int argc, char *argv[])
 {
+    // Drops go to a binary log (decode with drop-log-decode) instead of
+    // one flushed line per drop on stdout.
+    std::string dropLog = "tcp-drops.droplog";
+    double dropHistogram = 0.0;
+    // Per-client, sink and queue statistics, dumped as JSON (or CSV for a
+    // .csv name) at the end
+    std::string statsFile = "";
+    DumbbellConfig cfg;
+
     CommandLine cmd;
+    cmd.AddValue("dropLog", "Binary drop log file (empty = count only)", dropLog);
+    cmd.AddValue("dropHistogram", "If > 0, also count drops per bucket of this many seconds", dropHistogram);
+    cmd.AddValue("clients", "Number of TCP clients", cfg.nClients);
+    cmd.AddValue("stats", "Statistics dump, JSON or .csv (empty = none)", statsFile);
     cmd.Parse(argc, argv);
 
-    /* ---------- NODES ---------- */
-    NodeContainer clients, router, server;
-    clients.Create(2);
-    router.Create(1);
-    server.Create(1);
-
-    
-
-    /* ---------- LINKS ---------- */
-    PointToPointHelper access;
-    access.SetDeviceAttribute("DataRate", StringValue("10Mbps"));
-    access.SetChannelAttribute("Delay", StringValue("2ms"));
-
-    PointToPointHelper bottleneck;
-    bottleneck.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
-    bottleneck.SetChannelAttribute("Delay", StringValue("10ms"));
+    /* ---------- TOPOLOGY ---------- */
+    // N clients --10Mbps/2ms-- router --5Mbps/10ms-- server
+    Dumbbell dumbbell = BuildDumbbell(cfg);
 
-    NetDeviceContainer d0r = access.Install(clients.Get(0), router.Get(0));
-    NetDeviceContainer d1r = access.Install(clients.Get(1), router.Get(0));
-    NetDeviceContainer drs = bottleneck.Install(router.Get(0), server.Get(0));
-
-    /* ---------- INTERNET ---------- */
-    InternetStackHelper stack;
-    stack.InstallAll();
-
-    /* ---------- IP ADDRESSING ---------- */
-    Ipv4AddressHelper addr;
-
-    addr.SetBase("10.1.1.0", "255.255.255.0");
-    addr.Assign(d0r);
-
-    addr.SetBase("10.1.2.0", "255.255.255.0");
-    addr.Assign(d1r);
-
-    addr.SetBase("10.1.3.0", "255.255.255.0");
-    Ipv4InterfaceContainer serverIf = addr.Assign(drs);
-
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    NodeContainer &clients = dumbbell.clients;
+    NodeContainer &server = dumbbell.server;
+    NetDeviceContainer &drs = dumbbell.bottleneckDevices;
+    Ipv4InterfaceContainer &serverIf = dumbbell.bottleneckInterfaces;
 
     /* ---------- TRAFFIC CONTROL ---------- */
     TrafficControlHelper tch;
@@ -98,70 +53,65 @@ main (int argc, char *argv[])
     );
 
     QueueDiscContainer qdiscs = tch.Install(drs.Get(0));
-    qdiscs.Get(0)->TraceConnectWithoutContext(
-        "Drop", MakeCallback(&QueueDiscDropTrace));
-
-    /* ---------- APPLICATIONS (TCP) ---------- */
-    uint16_t port1 = 5000;
-    uint16_t port2 = 5001;
 
-    // TCP Sinks
-    PacketSinkHelper sink1(
-        "ns3::TcpSocketFactory",
-        InetSocketAddress(Ipv4Address::GetAny(), port1));
+    DropLogger dropLogger(dropLog);
+    if (dropHistogram > 0)
+        dropLogger.EnableHistogram(Seconds(dropHistogram));
+    dropLogger.Attach(qdiscs.Get(0));
 
-    PacketSinkHelper sink2(
-        "ns3::TcpSocketFactory",
-        InetSocketAddress(Ipv4Address::GetAny(), port2));
+    StatsRegistry stats;
+    std::string queueOwner = StatsOwner(drs.Get(0));
+    // Filled from dropLogger after the run: one Drop hook, one count
+    StatsRegistry::StatId queueDrops = stats.AddCounter(queueOwner, "drops");
+    stats.Connect(qdiscs.Get(0), "PacketsInQueue", stats.AddHistogram(queueOwner, "backlog", 1, 6),
+                  &TracedNewValue<uint32_t>);
 
+    /* ---------- APPLICATIONS (TCP) ---------- */
+    // Client i sends to its own sink on port 5000 + i
+    uint16_t basePort = 5000;
     ApplicationContainer sinkApps;
-    sinkApps.Add(sink1.Install(server.Get(0)));
-    sinkApps.Add(sink2.Install(server.Get(0)));
+    ApplicationContainer clientApps;
+    std::vector<StatsRegistry::StatId> clientTx;
+    for (uint32_t i = 0; i < clients.GetN(); i++)
+    {
+        PacketSinkHelper sink("ns3::TcpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), basePort + i));
+        ApplicationContainer sinkApp = sink.Install(server.Get(0));
+        sinkApps.Add(sinkApp);
+
+        BulkSendHelper bulk("ns3::TcpSocketFactory", InetSocketAddress(serverIf.GetAddress(1), basePort + i));
+        bulk.SetAttribute("MaxBytes", UintegerValue(0));
+        ApplicationContainer app = bulk.Install(clients.Get(i));
+        clientApps.Add(app);
+
+        std::string owner = StatsOwner(app.Get(0));
+        clientTx.push_back(stats.AddCounter(owner, "txPackets"));
+        stats.Connect<Ptr<const Packet>>(app.Get(0), "Tx", clientTx.back());
+        stats.Connect(app.Get(0), "Tx", stats.AddCounter(owner, "txBytes"), &PacketBytes);
+        stats.Connect(sinkApp.Get(0), "Rx", stats.AddCounter(StatsOwner(sinkApp.Get(0)), "rxBytes"),
+                      &PacketBytesFrom);
+    }
     sinkApps.Start(Seconds(0.5));
     sinkApps.Stop(Seconds(3.0));
-
-    // TCP BulkSend clients
-    BulkSendHelper bulk1(
-        "ns3::TcpSocketFactory",
-        InetSocketAddress(serverIf.GetAddress(1), port1));
-
-    BulkSendHelper bulk2(
-        "ns3::TcpSocketFactory",
-        InetSocketAddress(serverIf.GetAddress(1), port2));
-
-    bulk1.SetAttribute("MaxBytes", UintegerValue(0));
-    bulk2.SetAttribute("MaxBytes", UintegerValue(0));
-
-    ApplicationContainer app1 = bulk1.Install(clients.Get(0));
-    ApplicationContainer app2 = bulk2.Install(clients.Get(1));
-
-    app1.Start(Seconds(1.0));
-    app2.Start(Seconds(1.0));
-    app1.Stop(Seconds(2.0));
-    app2.Stop(Seconds(2.0));
-
-    // Attach TX traces SAFELY
-    Ptr<BulkSendApplication> b1 =
-        DynamicCast<BulkSendApplication>(app1.Get(0));
-    Ptr<BulkSendApplication> b2 =
-        DynamicCast<BulkSendApplication>(app2.Get(0));
-
-    b1->TraceConnectWithoutContext("Tx", MakeCallback(&Client1TxTrace));
-    b2->TraceConnectWithoutContext("Tx", MakeCallback(&Client2TxTrace));
-
-    
+    clientApps.Start(Seconds(1.0));
+    clientApps.Stop(Seconds(2.0));
 
     /* ---------- RUN ---------- */
     Simulator::Stop(Seconds(3.0));
     Simulator::Run();
 
     /* ---------- RESULTS ---------- */
+    stats.Increment(queueDrops, dropLogger.GetTotalDrops());
     cout << "\n=== TCP TRANSMISSION SUMMARY ===\n";
-    cout << "Client 1 TX packets: " << client1TxPackets << endl;
-    cout << "Client 2 TX packets: " << client2TxPackets << endl;
-    cout << "Total TX packets   : "
-         << (client1TxPackets + client2TxPackets) << endl;
-    cout << "Total queue drops  : " << totalQueueDrops << endl;
+    for (uint32_t i = 0; i < clientTx.size(); i++)
+        cout << "Client " << i + 1 << " TX packets: " << stats.GetCounter(clientTx[i]) << endl;
+    cout << "Total TX packets   : " << stats.Total("txPackets") << endl;
+    cout << "Total queue drops  : " << stats.GetCounter(queueDrops) << endl;
+    if (!statsFile.empty())
+        stats.Write(statsFile);
+
+    if (dropHistogram > 0)
+        PrintDropHistogram(dropLogger, cout);
+    dropLogger.Close();
 
     Simulator::Destroy();
     return 0;
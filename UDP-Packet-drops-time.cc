@@ -3,92 +3,44 @@
 #include "ns3/internet-module.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/applications-module.h"
-#include "ns3/flow-monitor-module.h"
 #include "ns3/mobility-module.h"
 #include "ns3/netanim-module.h"
 #include "ns3/traffic-control-module.h"
 
+#include "dumbbell-helper.h"
+#include "drop-logger.h"
+#include "stats-registry.h"
+
 using namespace ns3;
 using namespace std;
 
-/* ---------- TX COUNTERS ---------- */
-uint64_t client1TxPackets = 0;
-uint64_t client2TxPackets = 0;
-
-/* ---------- QUEUE DROP COUNTER ---------- */
-uint64_t totalQueueDrops = 0;
-
-/* ---------- TX TRACE CALLBACKS ---------- */
-void
-Client1TxTrace(Ptr<const Packet> packet)
-{
-    client1TxPackets++;
-}
-
-void
-Client2TxTrace(Ptr<const Packet> packet)
-{
-    client2TxPackets++;
-}
-
-/* ---------- QUEUE DROP TRACE ---------- */
-void
-QueueDiscDropTrace(Ptr<const QueueDiscItem> item)
-{
-    totalQueueDrops++;
-
-    cout << "[QUEUE DROP] "
-         << "Time = " << Simulator::Now().GetSeconds()
-         << " s, Packet Size = "
-         << item->GetPacket()->GetSize()
-         << " bytes"
-         << endl;
-}
-
 int
 main(int argc, char *argv[])
 {
+    // Drops go to a binary log (decode with drop-log-decode) instead of
+    // one flushed line per drop on stdout.
+    std::string dropLog = "udp-drops.droplog";
+    double dropHistogram = 0.0;
+    // Per-client, sink and queue statistics, dumped as JSON (or CSV for a
+    // .csv name) at the end
+    std::string statsFile = "";
+    DumbbellConfig cfg;
+
     CommandLine cmd;
+    cmd.AddValue("dropLog", "Binary drop log file (empty = count only)", dropLog);
+    cmd.AddValue("dropHistogram", "If > 0, also count drops per bucket of this many seconds", dropHistogram);
+    cmd.AddValue("clients", "Number of UDP clients", cfg.nClients);
+    cmd.AddValue("stats", "Statistics dump, JSON or .csv (empty = none)", statsFile);
     cmd.Parse(argc, argv);
 
-    /* ---------- NODES ---------- */
-    NodeContainer clients, router, server;
-    clients.Create(2);
-    router.Create(1);
-    server.Create(1);
-
+    /* ---------- TOPOLOGY ---------- */
+    // N clients --10Mbps/2ms-- router --5Mbps/10ms-- server
+    Dumbbell dumbbell = BuildDumbbell(cfg);
 
-
-    /* ---------- LINKS ---------- */
-    PointToPointHelper access;
-    access.SetDeviceAttribute("DataRate", StringValue("10Mbps"));
-    access.SetChannelAttribute("Delay", StringValue("2ms"));
-
-    PointToPointHelper bottleneck;
-    bottleneck.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
-    bottleneck.SetChannelAttribute("Delay", StringValue("10ms"));
-
-    NetDeviceContainer d0r = access.Install(clients.Get(0), router.Get(0));
-    NetDeviceContainer d1r = access.Install(clients.Get(1), router.Get(0));
-    NetDeviceContainer drs = bottleneck.Install(router.Get(0), server.Get(0));
-
-    /* ---------- INTERNET ---------- */
-    InternetStackHelper stack;
-    stack.InstallAll();
-
-    /* ---------- IP ADDRESSING ---------- */
-    Ipv4AddressHelper addr;
-
-    addr.SetBase("10.1.1.0", "255.255.255.0");
-    addr.Assign(d0r);
-
-    addr.SetBase("10.1.2.0", "255.255.255.0");
-    addr.Assign(d1r);
-
-    addr.SetBase("10.1.3.0", "255.255.255.0");
-    Ipv4InterfaceContainer serverIf = addr.Assign(drs);
-
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    NodeContainer &clients = dumbbell.clients;
+    NodeContainer &server = dumbbell.server;
+    NetDeviceContainer &drs = dumbbell.bottleneckDevices;
+    Ipv4InterfaceContainer &serverIf = dumbbell.bottleneckInterfaces;
 
     /* ---------- TRAFFIC CONTROL ---------- */
     TrafficControlHelper tch;
@@ -100,70 +52,64 @@ main(int argc, char *argv[])
     );
 
     QueueDiscContainer qdiscs = tch.Install(drs.Get(0));
-    qdiscs.Get(0)->TraceConnectWithoutContext(
-        "Drop", MakeCallback(&QueueDiscDropTrace));
+
+    DropLogger dropLogger(dropLog);
+    if (dropHistogram > 0)
+        dropLogger.EnableHistogram(Seconds(dropHistogram));
+    dropLogger.Attach(qdiscs.Get(0));
+
+    StatsRegistry stats;
+    std::string queueOwner = StatsOwner(drs.Get(0));
+    // Filled from dropLogger after the run: one Drop hook, one count
+    StatsRegistry::StatId queueDrops = stats.AddCounter(queueOwner, "drops");
+    stats.Connect(qdiscs.Get(0), "PacketsInQueue", stats.AddHistogram(queueOwner, "backlog", 1, 6),
+                  &TracedNewValue<uint32_t>);
 
     /* ---------- APPLICATIONS ---------- */
-    uint16_t port1 = 5000;
-    uint16_t port2 = 5001;
-
-    OnOffHelper onoff1("ns3::UdpSocketFactory",
-        Address(InetSocketAddress(serverIf.GetAddress(1), port1)));
-    OnOffHelper onoff2("ns3::UdpSocketFactory",
-        Address(InetSocketAddress(serverIf.GetAddress(1), port2)));
-
-    onoff1.SetAttribute("DataRate", StringValue("20Mbps"));
-    onoff1.SetAttribute("PacketSize", UintegerValue(1472));
-    onoff1.SetAttribute("OnTime",
-        StringValue("ns3::ConstantRandomVariable[Constant=1]"));
-    onoff1.SetAttribute("OffTime",
-        StringValue("ns3::ConstantRandomVariable[Constant=0]"));
-
-    onoff2.SetAttribute("DataRate", StringValue("20Mbps"));
-    onoff2.SetAttribute("PacketSize", UintegerValue(1472));
-    onoff2.SetAttribute("OnTime",
-        StringValue("ns3::ConstantRandomVariable[Constant=1]"));
-    onoff2.SetAttribute("OffTime",
-        StringValue("ns3::ConstantRandomVariable[Constant=0]"));
-
-    ApplicationContainer app1 = onoff1.Install(clients.Get(0));
-    ApplicationContainer app2 = onoff2.Install(clients.Get(1));
-
-    app1.Start(Seconds(1.0));
-    app2.Start(Seconds(1.0));
-    app1.Stop(Seconds(2.0));
-    app2.Stop(Seconds(2.0));
-
-    Ptr<OnOffApplication> app1Ptr =
-        DynamicCast<OnOffApplication>(app1.Get(0));
-    Ptr<OnOffApplication> app2Ptr =
-        DynamicCast<OnOffApplication>(app2.Get(0));
-//whenever onoff application sends a packet,Client1TxTrace/Client12TxTrace will be called 
-    app1Ptr->TraceConnectWithoutContext(
-        "Tx", MakeCallback(&Client1TxTrace));
-    app2Ptr->TraceConnectWithoutContext(
-        "Tx", MakeCallback(&Client2TxTrace));
-
-    /* ---------- FLOW MONITOR ---------- */
-    FlowMonitorHelper flowmon;
-    Ptr<FlowMonitor> monitor = flowmon.InstallAll();
-
-    
+    // Client i floods port 5000 + i at 20 Mbps
+    uint16_t basePort = 5000;
+    ApplicationContainer clientApps;
+    std::vector<StatsRegistry::StatId> clientTx;
+    for (uint32_t i = 0; i < clients.GetN(); i++)
+    {
+        OnOffHelper onoff("ns3::UdpSocketFactory",
+            Address(InetSocketAddress(serverIf.GetAddress(1), basePort + i)));
+        onoff.SetAttribute("DataRate", StringValue("20Mbps"));
+        onoff.SetAttribute("PacketSize", UintegerValue(1472));
+        onoff.SetAttribute("OnTime",
+            StringValue("ns3::ConstantRandomVariable[Constant=1]"));
+        onoff.SetAttribute("OffTime",
+            StringValue("ns3::ConstantRandomVariable[Constant=0]"));
+        ApplicationContainer app = onoff.Install(clients.Get(i));
+        clientApps.Add(app);
+
+        // Every packet the OnOff application sends
+        std::string owner = StatsOwner(app.Get(0));
+        clientTx.push_back(stats.AddCounter(owner, "txPackets"));
+        stats.Connect<Ptr<const Packet>>(app.Get(0), "Tx", clientTx.back());
+        stats.Connect(app.Get(0), "Tx", stats.AddCounter(owner, "txBytes"), &PacketBytes);
+    }
+    clientApps.Start(Seconds(1.0));
+    clientApps.Stop(Seconds(2.0));
 
     /* ---------- RUN ---------- */
     Simulator::Stop(Seconds(3.0));
     Simulator::Run();
 
     /* ---------- RESULTS ---------- */
-    monitor->CheckForLostPackets();
-
+    stats.Increment(queueDrops, dropLogger.GetTotalDrops());
     cout << "\n=== TRANSMISSION SUMMARY ===\n";
-    cout << "Client 1 TX packets: " << client1TxPackets << endl;
-    cout << "Client 2 TX packets: " << client2TxPackets << endl;
-    cout << "Total TX packets   : "
-         << (client1TxPackets + client2TxPackets) << endl;
+    for (uint32_t i = 0; i < clientTx.size(); i++)
+        cout << "Client " << i + 1 << " TX packets: " << stats.GetCounter(clientTx[i]) << endl;
+    cout << "Total TX packets   : " << stats.Total("txPackets") << endl;
+
+    cout << "\nTotal queue drops: " << stats.GetCounter(queueDrops) << endl;
+    if (!statsFile.empty())
+        stats.Write(statsFile);
 
-    cout << "\nTotal queue drops: " << totalQueueDrops << endl;
+    if (dropHistogram > 0)
+        PrintDropHistogram(dropLogger, cout);
+    dropLogger.Close();
 
     Simulator::Destroy();
     return 0;
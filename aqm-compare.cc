@@ -0,0 +1,171 @@
+/*
+ * AQM comparison on the aqmred bottleneck.
+ *
+ * Runs the same BulkSend traffic (same sources, same RngRun streams) over
+ * each queue disc in --aqms, all with the same buffer limit, and measures
+ * at the queue disc itself (aqm-scenario.h): per-packet sojourn time,
+ * time-weighted and maximum queue length, drops and ECN marks, plus
+ * goodput at the sink. red-ecn and dctcp also switch the senders to ECN
+ * (and DCTCP), so marks replace drops; compare their marks/drops columns.
+ *
+ * Every (AQM, replication) pair is one process. The report gives, per
+ * AQM, the mean over replications of every metric with the confidence
+ * half-width of goodput and p99 sojourn; --output keeps the per-run rows.
+ *
+ * Example:
+ *   ./ns3 run "aqm-compare --aqms=red,ared,codel,fqcodel,pie,cobalt --replications=5"
+ *   ./ns3 run "aqm-compare --aqms=red,red-ecn,dctcp"
+ */
+
+#include "ns3/core-module.h"
+
+#include "aqm-scenario.h"
+#include "parallel-runner.h"
+#include "replication.h"
+
+#include <fstream>
+#include <iomanip>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("AqmCompare");
+
+int main(int argc, char *argv[])
+{
+    // --- 1. CONFIGURATION ---
+    std::string aqms = "fifo,red,ared,red-ecn,dctcp,codel,fqcodel,pie,cobalt";
+    std::string limit = "20p";
+    uint32_t clients = 2;
+    std::string bottleneckRate = "5Mbps";
+    std::string bottleneckDelay = "10ms";
+    double stopTime = 20.0;
+    uint32_t replications = 3;
+    uint32_t firstRun = 1;
+    double confidence = 0.95;
+    std::string output = "aqm-compare.csv";
+    uint32_t jobs = DefaultParallelJobs();
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("aqms", "Comma-separated queue discs: fifo,red,ared,red-ecn,dctcp,codel,fqcodel,pie,cobalt", aqms);
+    cmd.AddValue("limit", "Buffer limit given to every queue disc", limit);
+    cmd.AddValue("clients", "BulkSend sources", clients);
+    cmd.AddValue("bottleneckRate", "Bottleneck link rate", bottleneckRate);
+    cmd.AddValue("bottleneckDelay", "Bottleneck link delay", bottleneckDelay);
+    cmd.AddValue("stopTime", "Simulated seconds per run", stopTime);
+    cmd.AddValue("replications", "Runs per queue disc (RngRun firstRun, firstRun+1, ...)", replications);
+    cmd.AddValue("run", "RngRun of the first replication", firstRun);
+    cmd.AddValue("confidence", "Confidence level of the intervals", confidence);
+    cmd.AddValue("output", "CSV with one row per run", output);
+    cmd.AddValue("jobs", "Simulations run concurrently", jobs);
+    cmd.Parse(argc, argv);
+
+    std::vector<std::string> names = SplitList(aqms);
+    for (auto const &n : names)
+    {
+        AqmPreset(n, limit, bottleneckRate, bottleneckDelay); // reject typos before forking
+    }
+
+    // --- 2. RUN ---
+    uint32_t nJobs = names.size() * replications;
+    std::vector<ParallelJobResult> results = RunParallel(nJobs, jobs, [&](uint32_t i) {
+        AqmScenarioConfig cfg;
+        cfg.nClients = clients;
+        cfg.bottleneckRate = bottleneckRate;
+        cfg.bottleneckDelay = bottleneckDelay;
+        cfg.aqm = AqmPreset(names[i / replications], limit, bottleneckRate, bottleneckDelay);
+        cfg.stopTime = stopTime;
+        cfg.run = firstRun + i % replications;
+        return RunAqmScenario(cfg).Serialize();
+    });
+
+    // --- 3. AGGREGATE ---
+    enum
+    {
+        GOODPUT,
+        UTIL,
+        MEAN,
+        P50,
+        P90,
+        P99,
+        MAX,
+        QMEAN,
+        QMAX,
+        DROPS,
+        MARKS,
+        N_METRICS
+    };
+    std::vector<std::vector<RunningStat>> stats(names.size(), std::vector<RunningStat>(N_METRICS));
+    uint32_t failed = 0;
+
+    std::ofstream csv(output);
+    csv << "aqm,run,goodput_mbps,utilisation,enqueued,drops,marks,mean_sojourn_ms,p50_sojourn_ms,"
+           "p90_sojourn_ms,p99_sojourn_ms,max_sojourn_ms,mean_queue_pkts,max_queue_pkts\n";
+
+    std::sort(results.begin(), results.end(),
+              [](const ParallelJobResult &a, const ParallelJobResult &b) { return a.index < b.index; });
+    for (auto const &res : results)
+    {
+        uint32_t a = res.index / replications;
+        if (!res.ok)
+        {
+            failed++;
+            continue;
+        }
+        AqmScenarioResult r = AqmScenarioResult::Parse(res.output);
+        double values[N_METRICS] = {r.goodputMbps, r.utilisation, r.meanSojournMs,
+                                    r.p50SojournMs, r.p90SojournMs, r.p99SojournMs,
+                                    r.maxSojournMs, r.meanQueuePkts, double(r.maxQueuePkts),
+                                    double(r.drops), double(r.marks)};
+        for (int m = 0; m < N_METRICS; m++)
+        {
+            stats[a][m].Add(values[m]);
+        }
+        csv << names[a] << "," << firstRun + res.index % replications << "," << r.goodputMbps
+            << "," << r.utilisation << "," << r.enqueued << "," << r.drops << "," << r.marks << ","
+            << r.meanSojournMs << "," << r.p50SojournMs << "," << r.p90SojournMs << ","
+            << r.p99SojournMs << "," << r.maxSojournMs << "," << r.meanQueuePkts << ","
+            << r.maxQueuePkts << "\n";
+    }
+
+    // --- 4. REPORT ---
+    std::cout << "\nSojourn times in ms, queue in packets; mean of " << replications
+              << " runs, +- is the " << confidence * 100 << "% half-width\n\n"
+              << std::left << std::setw(9) << "aqm" << std::right << std::setw(18) << "goodput_mbps"
+              << std::setw(7) << "util" << std::setw(8) << "mean" << std::setw(8) << "p50"
+              << std::setw(8) << "p90" << std::setw(18) << "p99" << std::setw(8) << "max"
+              << std::setw(8) << "q_mean" << std::setw(7) << "q_max" << std::setw(9) << "drops"
+              << std::setw(9) << "marks" << "\n";
+
+    auto pm = [&](const RunningStat &s) {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(2) << s.mean;
+        if (s.n > 1)
+        {
+            os << " +- " << s.HalfWidth(confidence);
+        }
+        return os.str();
+    };
+
+    for (size_t a = 0; a < names.size(); a++)
+    {
+        const std::vector<RunningStat> &s = stats[a];
+        if (s[GOODPUT].n == 0)
+        {
+            std::cout << std::left << std::setw(9) << names[a] << " (all runs failed)\n";
+            continue;
+        }
+        std::cout << std::left << std::setw(9) << names[a] << std::right << std::fixed
+                  << std::setw(18) << pm(s[GOODPUT]) << std::setprecision(2) << std::setw(7)
+                  << s[UTIL].mean << std::setw(8) << s[MEAN].mean << std::setw(8) << s[P50].mean
+                  << std::setw(8) << s[P90].mean << std::setw(18) << pm(s[P99]) << std::setw(8)
+                  << s[MAX].mean << std::setw(8) << s[QMEAN].mean << std::setprecision(0)
+                  << std::setw(7) << s[QMAX].mean << std::setw(9) << s[DROPS].mean << std::setw(9)
+                  << s[MARKS].mean << "\n";
+    }
+
+    if (failed > 0)
+    {
+        std::cout << failed << " runs failed" << std::endl;
+    }
+    return failed > 0 ? 1 : 0;
+}
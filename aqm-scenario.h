@@ -0,0 +1,381 @@
+/*
+ * The aqmred bottleneck as a reusable experiment: N BulkSend sources
+ * --100Mbps/2ms-- router --5Mbps/10ms-- sink, a 1p device queue so the
+ * queue disc under test dominates, and any root queue disc configured by
+ * type name plus string attributes.
+ *
+ * QueueDiscProbe instruments the queue disc itself: the per-packet sojourn
+ * time (QueueDisc "SojournTime", kept in a LatencySketch so long runs stay
+ * in bounded memory) and a time-weighted queue length ("PacketsInQueue"),
+ * next to the disc's own drop/mark statistics.
+ *
+ * An AqmConfig also says what the TCP senders need to benefit from the
+ * disc: ECN-capable sockets for marking discs, or a different congestion
+ * control (DCTCP behind step marking).
+ *
+ * RunAqmScenario() runs one configuration and returns an AqmScenarioResult
+ * that can be sent between processes as one line of text, so tuners and
+ * comparison suites can evaluate configurations with RunParallel().
+ */
+
+#ifndef AQM_SCENARIO_H
+#define AQM_SCENARIO_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include "dumbbell-helper.h"
+#include "latency-sketch.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* ---------- QUEUE DISC CONFIGURATION ---------- */
+
+// A number as an attribute or command-line value, in the fewest digits
+// that read back exactly (std::to_string keeps six decimals, so a QW of
+// 1e-7 became 0)
+inline std::string
+AqmValue(double value)
+{
+    std::string s;
+    for (int digits = 6; digits <= std::numeric_limits<double>::max_digits10; digits++)
+    {
+        std::ostringstream out;
+        out << std::setprecision(digits) << value;
+        s = out.str();
+        if (std::strtod(s.c_str(), nullptr) == value)
+        {
+            break;
+        }
+    }
+    return s;
+}
+
+struct AqmConfig
+{
+    std::string type = "ns3::RedQueueDisc";
+    // Applied as StringValue after the disc is created; later entries win.
+    std::vector<std::pair<std::string, std::string>> attributes;
+
+    // Sender side; applied as defaults before any socket exists.
+    std::string senderTcp = "";     // e.g. ns3::TcpDctcp (empty = ns-3 default)
+    bool senderEcn = false;         // TcpSocketBase::UseEcn = On
+
+    AqmConfig &Set(const std::string &name, const std::string &value)
+    {
+        attributes.emplace_back(name, value);
+        return *this;
+    }
+
+    AqmConfig &Set(const std::string &name, double value)
+    {
+        return Set(name, AqmValue(value));
+    }
+};
+
+// The RED setup aqmred has always used.
+inline AqmConfig
+AqmRedDefaults()
+{
+    AqmConfig c;
+    c.type = "ns3::RedQueueDisc";
+    c.Set("MinTh", "2")
+        .Set("MaxTh", "5")
+        .Set("MaxSize", "20p")
+        .Set("LinkBandwidth", "5Mbps")
+        .Set("LinkDelay", "10ms")
+        .Set("MeanPktSize", "1500")
+        .Set("Gentle", "true");
+    return c;
+}
+
+/*
+ * RED marking instead of dropping. With stepK > 0 every packet arriving to
+ * an instantaneous queue of stepK packets or more is marked (QW = 1,
+ * MaxTh = stepK), the DCTCP recommendation, and the senders run DCTCP;
+ * otherwise the thresholds stay and ECN-capable senders keep the default congestion
+ * control. UseHardDrop = false keeps marking above MaxTh too; the buffer
+ * limit still drops.
+ */
+inline AqmConfig &
+AqmEnableEcn(AqmConfig &c, uint32_t stepK = 0)
+{
+    c.Set("UseEcn", "true").Set("UseHardDrop", "false");
+    c.senderEcn = true;
+    if (stepK > 0)
+    {
+        // Marks when the queue reaches MaxTh = K; at MinTh = K - 1 the
+        // probability is still 0.
+        c.Set("MinTh", std::to_string(stepK - 1))
+            .Set("MaxTh", std::to_string(stepK))
+            .Set("QW", "1")
+            .Set("LInterm", "1")
+            .Set("Gentle", "false");
+        c.senderTcp = "ns3::TcpDctcp";
+    }
+    return c;
+}
+
+/*
+ * Named queue discs for comparisons, all with the same buffer limit:
+ * fifo, red, ared (adaptive RED, automatic thresholds), red-ecn (RED
+ * marking, ECN senders), dctcp (step-marking RED, DCTCP senders), codel,
+ * fqcodel, pie, cobalt. rate/delay describe the bottleneck for the discs
+ * that need them (RED's LinkBandwidth/LinkDelay).
+ */
+inline AqmConfig
+AqmPreset(const std::string &name, const std::string &limit, const std::string &rate,
+          const std::string &delay)
+{
+    AqmConfig c;
+    if (name == "red" || name == "ared" || name == "red-ecn" || name == "dctcp")
+    {
+        c = AqmRedDefaults();
+        c.Set("LinkBandwidth", rate).Set("LinkDelay", delay);
+        if (name == "ared")
+        {
+            c.Set("ARED", "true").Set("MinTh", "0").Set("MaxTh", "0");
+        }
+        else if (name == "red-ecn")
+        {
+            AqmEnableEcn(c);
+        }
+        else if (name == "dctcp")
+        {
+            AqmEnableEcn(c, 5);
+        }
+    }
+    else if (name == "fifo")
+        c.type = "ns3::PfifoFastQueueDisc";
+    else if (name == "codel")
+        c.type = "ns3::CoDelQueueDisc";
+    else if (name == "fqcodel")
+        c.type = "ns3::FqCoDelQueueDisc";
+    else if (name == "pie")
+        c.type = "ns3::PieQueueDisc";
+    else if (name == "cobalt")
+        c.type = "ns3::CobaltQueueDisc";
+    else
+        NS_FATAL_ERROR("Unknown AQM preset " << name);
+    c.Set("MaxSize", limit);
+    return c;
+}
+
+// Replaces whatever root queue disc dev has with the configured one.
+inline ns3::Ptr<ns3::QueueDisc>
+InstallAqm(ns3::Ptr<ns3::NetDevice> dev, const AqmConfig &cfg)
+{
+    using namespace ns3;
+
+    TrafficControlHelper tch;
+    tch.Uninstall(dev);
+    tch.SetRootQueueDisc(cfg.type);
+    Ptr<QueueDisc> qd = tch.Install(dev).Get(0);
+    for (auto const &a : cfg.attributes)
+    {
+        if (!qd->SetAttributeFailSafe(a.first, StringValue(a.second)))
+        {
+            NS_FATAL_ERROR(cfg.type << " rejects attribute " << a.first << "=" << a.second);
+        }
+    }
+    return qd;
+}
+
+// Call before the nodes' TCP sockets are created.
+inline void
+ApplyAqmSenderDefaults(const AqmConfig &cfg)
+{
+    using namespace ns3;
+
+    if (!cfg.senderTcp.empty())
+    {
+        Config::SetDefault("ns3::TcpL4Protocol::SocketType",
+                           TypeIdValue(TypeId::LookupByName(cfg.senderTcp)));
+    }
+    if (cfg.senderEcn)
+    {
+        Config::SetDefault("ns3::TcpSocketBase::UseEcn", StringValue("On"));
+    }
+}
+
+/* ---------- INSTRUMENTATION ---------- */
+
+class QueueDiscProbe
+{
+  public:
+    void Attach(ns3::Ptr<ns3::QueueDisc> qd)
+    {
+        m_qdisc = qd;
+        qd->TraceConnectWithoutContext("SojournTime", ns3::MakeCallback(&QueueDiscProbe::Sojourn, this));
+        qd->TraceConnectWithoutContext("PacketsInQueue", ns3::MakeCallback(&QueueDiscProbe::Length, this));
+    }
+
+    // Sojourn times (ns) of every dequeued packet, in bounded memory.
+    const LatencySketch &GetSojourn() const
+    {
+        return m_sojourn;
+    }
+
+    // Time-weighted mean queue length (packets) up to now.
+    double GetMeanQueueLength() const
+    {
+        int64_t now = ns3::Simulator::Now().GetNanoSeconds();
+        double area = m_areaPktNs + double(m_lastLen) * (now - m_lastChangeNs);
+        return now > 0 ? area / now : 0;
+    }
+
+    uint32_t GetMaxQueueLength() const
+    {
+        return m_maxLen;
+    }
+
+  private:
+    void Sojourn(ns3::Time t)
+    {
+        m_sojourn.Add(t.GetNanoSeconds());
+    }
+
+    void Length(uint32_t, uint32_t now)
+    {
+        int64_t t = ns3::Simulator::Now().GetNanoSeconds();
+        m_areaPktNs += double(m_lastLen) * (t - m_lastChangeNs);
+        m_lastChangeNs = t;
+        m_lastLen = now;
+        m_maxLen = std::max(m_maxLen, now);
+    }
+
+    ns3::Ptr<ns3::QueueDisc> m_qdisc;
+    LatencySketch m_sojourn;
+    double m_areaPktNs = 0;
+    int64_t m_lastChangeNs = 0;
+    uint32_t m_lastLen = 0;
+    uint32_t m_maxLen = 0;
+};
+
+/* ---------- SCENARIO ---------- */
+
+struct AqmScenarioConfig
+{
+    uint32_t nClients = 2;
+    std::string accessRate = "100Mbps";
+    std::string accessDelay = "2ms";
+    std::string bottleneckRate = "5Mbps";
+    std::string bottleneckDelay = "10ms";
+    std::string deviceQueue = "1p";
+
+    AqmConfig aqm = AqmRedDefaults();
+
+    double appStart = 1.0;
+    double stopTime = 20.0;
+    uint32_t run = 1;
+};
+
+struct AqmScenarioResult
+{
+    double goodputMbps = 0;
+    double utilisation = 0;   // goodput / bottleneck rate
+    uint64_t enqueued = 0;
+    uint64_t drops = 0;
+    uint64_t marks = 0;
+    double meanSojournMs = 0;
+    double p50SojournMs = 0;
+    double p90SojournMs = 0;
+    double p99SojournMs = 0;
+    double maxSojournMs = 0;
+    double meanQueuePkts = 0;
+    uint32_t maxQueuePkts = 0;
+
+    std::string Serialize() const
+    {
+        std::ostringstream os;
+        os.precision(10);
+        os << goodputMbps << " " << utilisation << " " << enqueued << " " << drops << " " << marks
+           << " " << meanSojournMs << " " << p50SojournMs << " " << p90SojournMs << " "
+           << p99SojournMs << " " << maxSojournMs << " " << meanQueuePkts << " " << maxQueuePkts;
+        return os.str();
+    }
+
+    static AqmScenarioResult Parse(const std::string &s)
+    {
+        AqmScenarioResult r;
+        std::istringstream is(s);
+        is >> r.goodputMbps >> r.utilisation >> r.enqueued >> r.drops >> r.marks >>
+            r.meanSojournMs >> r.p50SojournMs >> r.p90SojournMs >> r.p99SojournMs >>
+            r.maxSojournMs >> r.meanQueuePkts >> r.maxQueuePkts;
+        return r;
+    }
+};
+
+inline AqmScenarioResult
+RunAqmScenario(const AqmScenarioConfig &cfg)
+{
+    using namespace ns3;
+
+    RngSeedManager::SetRun(cfg.run);
+    ApplyAqmSenderDefaults(cfg.aqm);
+
+    /* ---------- TOPOLOGY ---------- */
+    DumbbellConfig dc;
+    dc.nClients = cfg.nClients;
+    dc.accessRate = cfg.accessRate;
+    dc.accessDelay = cfg.accessDelay;
+    dc.bottleneckRate = cfg.bottleneckRate;
+    dc.bottleneckDelay = cfg.bottleneckDelay;
+    dc.bottleneckDeviceQueue = cfg.deviceQueue;
+    Dumbbell d = BuildDumbbell(dc);
+
+    Ptr<QueueDisc> qd = InstallAqm(d.BottleneckDevice(), cfg.aqm);
+    QueueDiscProbe probe;
+    probe.Attach(qd);
+
+    /* ---------- APPLICATIONS ---------- */
+    uint16_t port = 50000;
+    PacketSinkHelper sinkHelper("ns3::TcpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), port));
+    ApplicationContainer sinkApps = sinkHelper.Install(d.server.Get(0));
+    sinkApps.Start(Seconds(0.0));
+    sinkApps.Stop(Seconds(cfg.stopTime));
+
+    BulkSendHelper bulk("ns3::TcpSocketFactory", InetSocketAddress(d.ServerAddress(), port));
+    bulk.SetAttribute("MaxBytes", UintegerValue(0));
+    ApplicationContainer bulkApps = bulk.Install(d.clients);
+    bulkApps.Start(Seconds(cfg.appStart));
+    bulkApps.Stop(Seconds(cfg.stopTime));
+
+    Simulator::Stop(Seconds(cfg.stopTime));
+    Simulator::Run();
+
+    /* ---------- RESULTS ---------- */
+    AqmScenarioResult r;
+    uint64_t rxBytes = DynamicCast<PacketSink>(sinkApps.Get(0))->GetTotalRx();
+    r.goodputMbps = rxBytes * 8.0 / (cfg.stopTime - cfg.appStart) / 1e6;
+    r.utilisation = r.goodputMbps * 1e6 / DataRate(cfg.bottleneckRate).GetBitRate();
+
+    const QueueDisc::Stats &st = qd->GetStats();
+    r.enqueued = st.nTotalEnqueuedPackets;
+    r.drops = st.nTotalDroppedPackets;
+    r.marks = st.nTotalMarkedPackets;
+
+    const LatencySketch &sojourn = probe.GetSojourn();
+    r.meanSojournMs = sojourn.GetMean() / 1e6;
+    r.p50SojournMs = sojourn.Quantile(0.50) / 1e6;
+    r.p90SojournMs = sojourn.Quantile(0.90) / 1e6;
+    r.p99SojournMs = sojourn.Quantile(0.99) / 1e6;
+    r.maxSojournMs = sojourn.GetMax() / 1e6;
+    r.meanQueuePkts = probe.GetMeanQueueLength();
+    r.maxQueuePkts = probe.GetMaxQueueLength();
+
+    Simulator::Destroy();
+    return r;
+}
+
+#endif /* AQM_SCENARIO_H */
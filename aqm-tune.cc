@@ -0,0 +1,286 @@
+/*
+ * Parallel RED parameter tuner for the aqmred bottleneck.
+ *
+ * Searches MinTh, MaxTh, MaxP (RED's LInterm = 1 / MaxP) and QW:
+ *
+ *   1. random search: --candidates configurations drawn from the space
+ *      below, each evaluated with a short run (--minTime simulated s);
+ *   2. successive halving: the best 1/eta of every rung is re-run eta
+ *      times longer, up to --maxTime, until one rung at full length.
+ *
+ * Every evaluation is one RunAqmScenario() in its own process
+ * (parallel-runner.h). A configuration is feasible when its bottleneck
+ * utilisation is at least --floor; feasible ones are ranked by
+ * mean sojourn + p99Weight * p99 sojourn, infeasible ones come last by
+ * utilisation. Runs of different lengths do not compare, so a final rung
+ * at --maxTime re-runs whatever is still to be compared there: the
+ * survivors and the configurations on the front over all runs so far. The
+ * Pareto front of p99 queueing delay against goodput over that rung is
+ * printed at the end, together with the aqmred command line for the best
+ * configuration in it.
+ *
+ * Example:
+ *   ./ns3 run "aqm-tune --candidates=64 --eta=3 --minTime=5 --maxTime=45 --floor=0.9"
+ */
+
+#include "ns3/core-module.h"
+
+#include "aqm-scenario.h"
+#include "parallel-runner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <random>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("AqmTune");
+
+struct RedCandidate
+{
+    double minTh;
+    double maxTh;
+    double maxP;
+    double qw;
+
+    // Last (longest) evaluation
+    AqmScenarioResult result;
+    uint32_t rung = 0;
+    double simTime = 0;
+    double score = 0;
+};
+
+static AqmConfig
+RedCandidateConfig(const RedCandidate &c, uint32_t limit, const std::string &rate, const std::string &delay)
+{
+    AqmConfig aqm = AqmRedDefaults();
+    aqm.Set("MinTh", c.minTh)
+        .Set("MaxTh", c.maxTh)
+        .Set("LInterm", 1.0 / c.maxP)
+        .Set("QW", c.qw)
+        .Set("MaxSize", std::to_string(limit) + "p")
+        .Set("LinkBandwidth", rate)
+        .Set("LinkDelay", delay);
+    return aqm;
+}
+
+static double
+Score(const AqmScenarioResult &r, double floor, double p99Weight)
+{
+    if (r.utilisation < floor)
+    {
+        return 1e9 - r.utilisation;
+    }
+    return r.meanSojournMs + p99Weight * r.p99SojournMs;
+}
+
+/*
+ * The listed configurations that no other listed one beats on both p99
+ * sojourn and goodput, by decreasing goodput. Failed runs are left out.
+ */
+static std::vector<uint32_t>
+ParetoFront(const std::vector<RedCandidate> &all, std::vector<uint32_t> ids)
+{
+    std::sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) {
+        return all[a].result.goodputMbps > all[b].result.goodputMbps;
+    });
+    std::vector<uint32_t> front;
+    double bestP99 = 1e300;
+    for (uint32_t i : ids)
+    {
+        if (all[i].score >= 2e9 || all[i].result.p99SojournMs >= bestP99)
+        {
+            continue;
+        }
+        bestP99 = all[i].result.p99SojournMs;
+        front.push_back(i);
+    }
+    return front;
+}
+
+int main(int argc, char *argv[])
+{
+    // --- 1. CONFIGURATION ---
+    uint32_t candidates = 32;
+    double eta = 3;
+    double minTime = 5;
+    double maxTime = 20;
+    double floor = 0.9;
+    double p99Weight = 1.0;
+    uint32_t limit = 20;
+    uint32_t seed = 1;
+    uint32_t run = 1;
+    std::string bottleneckRate = "5Mbps";
+    std::string bottleneckDelay = "10ms";
+    std::string output = "aqm-tune.csv";
+    uint32_t jobs = DefaultParallelJobs();
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("candidates", "Random configurations in the first rung", candidates);
+    cmd.AddValue("eta", "Successive-halving factor (keep 1/eta, run eta times longer)", eta);
+    cmd.AddValue("minTime", "Simulated seconds of the first rung", minTime);
+    cmd.AddValue("maxTime", "Simulated seconds of the last rung", maxTime);
+    cmd.AddValue("floor", "Minimum bottleneck utilisation of a feasible configuration", floor);
+    cmd.AddValue("p99Weight", "Weight of p99 sojourn time in the objective", p99Weight);
+    cmd.AddValue("limit", "RED MaxSize in packets (MaxTh stays below it)", limit);
+    cmd.AddValue("seed", "Seed of the random search", seed);
+    cmd.AddValue("run", "RngRun of every simulation", run);
+    cmd.AddValue("bottleneckRate", "Bottleneck link rate", bottleneckRate);
+    cmd.AddValue("bottleneckDelay", "Bottleneck link delay", bottleneckDelay);
+    cmd.AddValue("output", "CSV of every evaluation", output);
+    cmd.AddValue("jobs", "Simulations run concurrently", jobs);
+    cmd.Parse(argc, argv);
+
+    if (candidates < 1 || eta < 2 || limit < 4 || minTime <= 1)
+    {
+        NS_FATAL_ERROR("Need candidates >= 1, eta >= 2, limit >= 4 and minTime > 1 (apps start at 1 s)");
+    }
+
+    // --- 2. RANDOM SEARCH SPACE ---
+    std::mt19937 rng(seed);
+    auto uniform = [&](double lo, double hi) { return std::uniform_real_distribution<double>(lo, hi)(rng); };
+    auto logUniform = [&](double lo, double hi) { return std::exp(uniform(std::log(lo), std::log(hi))); };
+
+    std::vector<RedCandidate> all(candidates);
+    for (auto &c : all)
+    {
+        c.minTh = std::round(uniform(1, limit / 2.0));
+        c.maxTh = std::round(uniform(c.minTh + 1, limit - 1));
+        c.maxP = logUniform(0.01, 0.5);
+        c.qw = logUniform(1e-4, 2e-2);
+    }
+
+    std::ofstream csv(output);
+    csv << "rung,candidate,sim_s,min_th,max_th,max_p,qw,goodput_mbps,utilisation,"
+           "mean_sojourn_ms,p99_sojourn_ms,drops,score\n";
+
+    // Runs the listed configurations for simTime each and scores them
+    auto evaluate = [&](const std::vector<uint32_t> &ids, double simTime, uint32_t rung) {
+        std::vector<ParallelJobResult> results = RunParallel(ids.size(), jobs, [&](uint32_t i) {
+            AqmScenarioConfig cfg;
+            cfg.bottleneckRate = bottleneckRate;
+            cfg.bottleneckDelay = bottleneckDelay;
+            cfg.aqm = RedCandidateConfig(all[ids[i]], limit, bottleneckRate, bottleneckDelay);
+            cfg.stopTime = simTime;
+            cfg.run = run;
+            return RunAqmScenario(cfg).Serialize();
+        });
+
+        for (auto const &r : results)
+        {
+            RedCandidate &c = all[ids[r.index]];
+            c.rung = rung;
+            c.simTime = simTime;
+            if (!r.ok)
+            {
+                c.score = 2e9;
+                continue;
+            }
+            c.result = AqmScenarioResult::Parse(r.output);
+            c.score = Score(c.result, floor, p99Weight);
+            csv << rung << "," << ids[r.index] << "," << simTime << "," << c.minTh << ","
+                << c.maxTh << "," << c.maxP << "," << c.qw << "," << c.result.goodputMbps << ","
+                << c.result.utilisation << "," << c.result.meanSojournMs << ","
+                << c.result.p99SojournMs << "," << c.result.drops << "," << c.score << "\n";
+        }
+    };
+
+    // --- 3. SUCCESSIVE HALVING ---
+    std::vector<uint32_t> alive(candidates);
+    for (uint32_t i = 0; i < candidates; i++)
+    {
+        alive[i] = i;
+    }
+
+    double simTime = minTime;
+    uint32_t rung = 0;
+    for (;; rung++)
+    {
+        std::cout << "Rung " << rung << ": " << alive.size() << " configurations x " << simTime
+                  << " s" << std::endl;
+        evaluate(alive, simTime, rung);
+
+        if (simTime >= maxTime || alive.size() == 1)
+        {
+            break;
+        }
+        std::sort(alive.begin(), alive.end(),
+                  [&](uint32_t a, uint32_t b) { return all[a].score < all[b].score; });
+        alive.resize(std::max<size_t>(1, std::ceil(alive.size() / eta)));
+        simTime = std::min(maxTime, simTime * eta);
+    }
+
+    // --- 4. FINAL RUNG ---
+    // Configurations stopped at early rungs only have short runs, which do
+    // not compare with the survivors' long ones. The survivors and every
+    // configuration on the front over all runs so far are compared at
+    // --maxTime, re-run there if they have not been.
+    std::vector<uint32_t> everyone(candidates);
+    for (uint32_t i = 0; i < candidates; i++)
+    {
+        everyone[i] = i;
+    }
+    std::vector<uint32_t> finalists = ParetoFront(all, everyone);
+    for (uint32_t i : alive)
+    {
+        if (std::find(finalists.begin(), finalists.end(), i) == finalists.end())
+        {
+            finalists.push_back(i);
+        }
+    }
+    std::vector<uint32_t> rerun;
+    for (uint32_t i : finalists)
+    {
+        if (all[i].simTime < maxTime)
+        {
+            rerun.push_back(i);
+        }
+    }
+    if (!rerun.empty())
+    {
+        rung++;
+        std::cout << "Rung " << rung << " (final): " << rerun.size() << " configurations x " << maxTime
+                  << " s" << std::endl;
+        evaluate(rerun, maxTime, rung);
+    }
+
+    // --- 5. PARETO FRONT (p99 sojourn vs goodput, final rung only) ---
+    std::cout << "\nPareto front at " << maxTime
+              << " s (no other configuration has both lower p99 and higher goodput):\n"
+              << std::setw(6) << "min_th" << std::setw(8) << "max_th" << std::setw(8) << "max_p"
+              << std::setw(11) << "qw" << std::setw(14) << "goodput_mbps" << std::setw(10) << "mean_ms"
+              << std::setw(10) << "p99_ms" << "\n";
+    for (uint32_t i : ParetoFront(all, finalists))
+    {
+        const RedCandidate &c = all[i];
+        std::cout << std::fixed << std::setprecision(0) << std::setw(6) << c.minTh << std::setw(8)
+                  << c.maxTh << std::setprecision(3) << std::setw(8) << c.maxP << std::defaultfloat
+                  << std::setprecision(4) << std::setw(11) << c.qw << std::fixed << std::setprecision(3)
+                  << std::setw(14) << c.result.goodputMbps << std::setw(10) << c.result.meanSojournMs
+                  << std::setw(10) << c.result.p99SojournMs << "\n";
+    }
+
+    // --- 6. BEST ---
+    const RedCandidate *best = nullptr;
+    for (uint32_t i : finalists)
+    {
+        if (!best || all[i].score < best->score)
+        {
+            best = &all[i];
+        }
+    }
+    if (best->score >= 1e9)
+    {
+        std::cout << "\nNo configuration reached utilisation " << floor << std::endl;
+        return 1;
+    }
+    std::cout << "\nBest: mean sojourn " << best->result.meanSojournMs << " ms, p99 "
+              << best->result.p99SojournMs << " ms, utilisation " << best->result.utilisation
+              << "\n  ./ns3 run \"aqmred --minTh=" << AqmValue(best->minTh) << " --maxTh=" << AqmValue(best->maxTh)
+              << " --maxP=" << AqmValue(best->maxP) << " --qw=" << AqmValue(best->qw) << " --limit=" << limit
+              << " --bottleneckRate=" << bottleneckRate << " --bottleneckDelay=" << bottleneckDelay << "\""
+              << std::endl;
+    return 0;
+}
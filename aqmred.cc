@@ -6,73 +6,116 @@
 #include "ns3/traffic-control-module.h"
 #include "ns3/flow-monitor-module.h"
 
-using namespace ns3;
+#include "aqm-scenario.h"
+#include "dumbbell-helper.h"
+#include "edge-flow-monitor.h"
+#include "latency-sketch.h"
+#include "replication.h"
+#include "scheduler-select.h"
+#include "steady-state.h"
+#include "tcp-flow-recorder.h"
+#include "flow-window-sampler.h"
 
-int main (int argc, char *argv[])
-{
-  Time::SetResolution (Time::NS);
+#include <memory>
 
-  NodeContainer sources, router, sink;
-  sources.Create (2);
-  router.Create (1);
-  sink.Create (1);
+using namespace ns3;
 
-  // ---------- Access links ----------
-  PointToPointHelper access;
-  access.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-  access.SetChannelAttribute ("Delay", StringValue ("2ms"));
+static const double kAppStart = 1.0;
+static const double kStopTime = 20.0;
 
-  NetDeviceContainer d0r = access.Install (sources.Get (0), router.Get (0));
-  NetDeviceContainer d1r = access.Install (sources.Get (1), router.Get (0));
+struct AqmRedOptions
+{
+  uint32_t run = 1;
+  bool verbose = true;              // print the per-flow report
+  std::string cwndFile = "";        // senders' cwnd/RTT time series (empty = off)
+  double cwndInterval = 0.001;      // its sampling interval (s, 0 = every change)
+  double windowInterval = 0.5;      // per-flow windowed stats (0 = off)
+  std::string windowFile = "aqmred-windows.csv";
+  // full: FlowMonitor on every node; edge: EdgeFlowMonitor on the sources'
+  // egress and the sink's ingress, drops counted where they happen
+  std::string monitor = "full";
 
-  // ---------- Bottleneck ----------
-  PointToPointHelper bottleneck;
-  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
-  bottleneck.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  // Bottleneck: RED buffer limit (packets), link rate and delay
+  uint32_t limit = 20;
+  std::string bottleneckRate = "5Mbps";
+  std::string bottleneckDelay = "10ms";
 
-  // Disable device buffering.the queue size is set to 1 packet (1p), which is effectively almost no buffering. Normally, a network device (NetDevice) has a default hardware/software buffer for packets. By setting it to just 1 packet, you are minimizing the device’s internal queue, so the queue won't store multiple packets, which is why the comment says “disable device buffering”.
+  // RED parameters (aqm-tune searches these)
+  double minTh = 2;
+  double maxTh = 5;
+  double maxP = 0.02;               // RED LInterm = 1 / maxP
+  double qw = 0.002;
 
-//It doesn’t completely remove the queue (you always need at least 1 packet), but it prevents large queue buildup that could hide the effects of the AQM discipline being tested.
-  bottleneck.SetQueue ("ns3::DropTailQueue<Packet>",
-                       "MaxSize", QueueSizeValue (QueueSize ("1p")));
+  // ECN: RED marks instead of dropping and the senders are ECN-capable;
+  // with dctcp, step marking at stepK packets and DCTCP senders.
+  bool ecn = false;
+  bool dctcp = false;
+  uint32_t stepK = 5;
 
-  NetDeviceContainer drs = bottleneck.Install (router.Get (0), sink.Get (0));
+  // Tail-latency SLO on every source's data flow (sloMs = 0: off)
+  double sloQuantile = 0.99;
+  double sloMs = 0;
 
-  // ---------- Internet ----------
-  InternetStackHelper stack;
-  stack.InstallAll ();
+  // Stop once every source's windowed throughput and the bottleneck queue
+  // length are steady (MSER-5); kStopTime becomes an upper bound and the
+  // throughput metrics exclude the detected warm-up.
+  bool autoStop = false;
+  double ssInterval = 0.1;
+  double ssTolerance = 0.05;
+};
 
-  Ipv4AddressHelper address;
+/*
+ * Runs the RED bottleneck once. Returns lost packets, mean delay (s) and
+ * throughput (Mbps) of each source's data flow, in source order, followed
+ * by the bottleneck queue disc's drops and ECN marks; the payload carries
+ * every data flow's delay and jitter sketches.
+ */
+static ReplicationOutput
+RunAqmRed (const AqmRedOptions &opt)
+{
+  RngSeedManager::SetRun (opt.run);
+
+  // ---------- AQM ----------
+  //RED will start probabilistically dropping (with --ecn: marking) packets when the average queue length is between MinTh and MaxTh. The thresholds, MaxP and QW come from the command line so aqm-tune's results can be replayed here.
+  AqmConfig red = AqmRedDefaults ();
+  red.Set ("MinTh", opt.minTh)
+     .Set ("MaxTh", opt.maxTh)
+     .Set ("LInterm", 1.0 / opt.maxP)
+     .Set ("QW", opt.qw)
+     .Set ("MaxSize", std::to_string (opt.limit) + "p")
+     .Set ("LinkBandwidth", opt.bottleneckRate)
+     .Set ("LinkDelay", opt.bottleneckDelay);
+  if (opt.dctcp)
+    AqmEnableEcn (red, opt.stepK);
+  else if (opt.ecn)
+    AqmEnableEcn (red);
 
-  address.SetBase ("10.1.1.0", "255.255.255.0");
-  address.Assign (d0r);
+  // The senders' socket type and ECN setting are defaults, so they must be
+  // in place before the Internet stack (and its TcpL4Protocol) exists.
+  ApplyAqmSenderDefaults (red);
 
-  address.SetBase ("10.1.2.0", "255.255.255.0");
-  address.Assign (d1r);
+  // ---------- Topology ----------
+  // 2 sources --100Mbps/2ms-- router --5Mbps/10ms-- sink (by default)
+  DumbbellConfig cfg;
+  cfg.accessRate = "100Mbps";
+  cfg.accessDelay = "2ms";
+  cfg.bottleneckRate = opt.bottleneckRate;
+  cfg.bottleneckDelay = opt.bottleneckDelay;
 
-  address.SetBase ("10.1.3.0", "255.255.255.0");
-  Ipv4InterfaceContainer sinkIf = address.Assign (drs);
+  // Disable device buffering.the queue size is set to 1 packet (1p), which is effectively almost no buffering. Normally, a network device (NetDevice) has a default hardware/software buffer for packets. By setting it to just 1 packet, you are minimizing the device’s internal queue, so the queue won't store multiple packets, which is why the comment says “disable device buffering”.
 
-  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+//It doesn’t completely remove the queue (you always need at least 1 packet), but it prevents large queue buildup that could hide the effects of the AQM discipline being tested.
+  cfg.bottleneckDeviceQueue = "1p";
 
-  //TrafficControlHelper in NS-3 is used to install and configure queue disciplines (like RED, CoDel, or DropTail) on NetDevices. It allows you to control how packets are queued, scheduled, and dropped to manage congestion
-  TrafficControlHelper tch;
+  Dumbbell dumbbell = BuildDumbbell (cfg);
 
-  // REMOVE default queue disc FIRST
-  tch.Uninstall (drs.Get (0));
-  //we are installing the actual AQM (RED) queue on the bottleneck device.RED will start probabilistically dropping packets when the average queue length is between MinTh and MaxTh.SetRootQueueDisc is a method of TrafficControlHelper used to assign a specific queue discipline (e.g., RED, CoDel) as the root queue on a network device. It also allows setting the configuration parameters of that queue discipline, such as thresholds, queue size, and packet handling behavior.
-  tch.SetRootQueueDisc (
-      "ns3::RedQueueDisc",
-      "MinTh", DoubleValue (2),
-      "MaxTh", DoubleValue (5),
-      "MaxSize", QueueSizeValue (QueueSize ("20p")),
-      "LinkBandwidth", StringValue ("5Mbps"),
-      "LinkDelay", StringValue ("10ms"),
-      "MeanPktSize", UintegerValue (1500),
-      "Gentle", BooleanValue (true)
-  );
+  NodeContainer &sources = dumbbell.clients;
+  NodeContainer &sink = dumbbell.server;
+  NetDeviceContainer &drs = dumbbell.bottleneckDevices;
+  Ipv4InterfaceContainer &sinkIf = dumbbell.bottleneckInterfaces;
 
-  tch.Install (drs.Get (0));
+  //InstallAqm (aqm-scenario.h) removes the default queue disc FIRST and installs the RED queue configured above on the bottleneck device.
+  Ptr<QueueDisc> bottleneckQueue = InstallAqm (drs.Get (0), red);
 
   // ---------- Applications ----------
   uint16_t port = 50000;
@@ -80,8 +123,9 @@ int main (int argc, char *argv[])
   PacketSinkHelper sinkApp ("ns3::TcpSocketFactory",
                             InetSocketAddress (Ipv4Address::GetAny (), port));
   ApplicationContainer sinkApps = sinkApp.Install (sink.Get (0));
+  ApplicationContainer bulkApps;
   sinkApps.Start (Seconds (0.0));
-  sinkApps.Stop (Seconds (20.0));
+  sinkApps.Stop (Seconds (kStopTime));
 
   for (uint32_t i = 0; i < sources.GetN (); i++)
     {
@@ -90,38 +134,240 @@ int main (int argc, char *argv[])
       bulk.SetAttribute ("MaxBytes", UintegerValue (0));
 
       ApplicationContainer app = bulk.Install (sources.Get (i));
-      app.Start (Seconds (1.0));
-      app.Stop (Seconds (20.0));
+      app.Start (Seconds (kAppStart));
+      app.Stop (Seconds (kStopTime));
+      bulkApps.Add (app);
     }
 
+  // ---------- Steady state ----------
+  SourceRxCounter sourceRx;
+  sourceRx.Track (sinkApps.Get (0));
+  SteadyStateMonitor steady (Seconds (opt.ssInterval), opt.ssTolerance);
+  if (opt.autoStop)
+    {
+      for (uint32_t i = 0; i < sources.GetN (); i++)
+        {
+          uint32_t idx = sourceRx.AddSource (dumbbell.accessInterfaces[i].GetAddress (0));
+          steady.AddMetric ("source " + std::to_string (i) + " throughput (Mbps)",
+                            WindowedRateMbps (sourceRx.Counter (idx), Seconds (opt.ssInterval)));
+        }
+      steady.AddMetric ("bottleneck queue (packets)",
+                        [bottleneckQueue] () { return double (bottleneckQueue->GetNPackets ()); });
+      steady.SetAutoStop (true);
+      steady.Start (Seconds (kAppStart));
+    }
+
+  TcpFlowRecorder cwndRecorder (Seconds (opt.cwndInterval));
+  if (!opt.cwndFile.empty ())
+    cwndRecorder.TrackAll (bulkApps, Seconds (kAppStart));
+
+  // Per-packet delay and jitter sketches of every flow
+  FlowLatencyTracker latency;
+  latency.Install (sources);
+  latency.Install (sink);
+
   // ---------- Flow Monitor ----------
   FlowMonitorHelper flowmon;
-  Ptr<FlowMonitor> monitor = flowmon.InstallAll ();
+  Ptr<FlowMonitor> monitor;
+  Ptr<Ipv4FlowClassifier> classifier;
+  EdgeFlowMonitor edge;
+  std::unique_ptr<FlowWindowSampler> windows;
+  if (opt.monitor == "edge")
+    {
+      // The router forwards untouched (its drop traces aside) and only
+      // the data direction is seen
+      edge.InstallSenders (sources);
+      edge.InstallReceivers (sink);
+      edge.InstallDropPoints (NodeContainer::GetGlobal ());
+      windows.reset (new FlowWindowSampler (&edge, Seconds (opt.windowInterval)));
+    }
+  else
+    {
+      monitor = flowmon.InstallAll ();
+      classifier = DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ());
+      windows.reset (new FlowWindowSampler (monitor, classifier, Seconds (opt.windowInterval)));
+    }
 
-  Simulator::Stop (Seconds (20.0));
-  Simulator::Run ();
+  if (opt.windowInterval > 0)
+    {
+      if (!opt.windowFile.empty ())
+        windows->SetOutput (opt.windowFile);
+      windows->Start (Seconds (kAppStart));
+    }
 
-  monitor->CheckForLostPackets ();
+  Simulator::Stop (Seconds (kStopTime));
+  Simulator::Run ();
+  double stopTime = Simulator::Now ().GetSeconds ();
 
-  Ptr<Ipv4FlowClassifier> classifier =
-      DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ());
+  std::vector<double> metrics (3 * sources.GetN () + 2, 0.0);
 
-  for (auto const &flow : monitor->GetFlowStats ())
+  std::vector<FlowTotals> totals = monitor ? CollectFlowTotals (monitor, classifier)
+                                           : CollectFlowTotals (edge);
+  for (const FlowTotals &flow : totals)
     {
-      auto t = classifier->FindFlow (flow.first);
-      std::cout << "Flow " << flow.first << " (" << t.sourceAddress
-                << " -> " << t.destinationAddress << ")\n";
-      std::cout << "  Lost packets: " << flow.second.lostPackets << "\n";
-      if (flow.second.rxPackets > 0)
+      if (opt.verbose)
         {
-          std::cout << "  Mean delay: "
-                    << flow.second.delaySum.GetSeconds () /
-                           flow.second.rxPackets
-                    << " s\n";
+          std::cout << "Flow " << flow.id << " (" << flow.src
+                    << " -> " << flow.dst << ")\n";
+          std::cout << "  Lost packets: " << flow.lostPackets << "\n";
+          if (flow.rxPackets > 0)
+            {
+              std::cout << "  Mean delay: "
+                        << flow.delaySumNs / 1e9 / flow.rxPackets
+                        << " s\n";
+            }
+        }
+
+      // Only the data direction counts towards the replication metrics
+      for (uint32_t i = 0; i < sources.GetN (); i++)
+        {
+          if (flow.src != dumbbell.accessInterfaces[i].GetAddress (0))
+            continue;
+
+          metrics[3 * i] = flow.lostPackets;
+          if (flow.rxPackets > 0)
+            metrics[3 * i + 1] = flow.delaySumNs / 1e9 / flow.rxPackets;
+          metrics[3 * i + 2] = opt.autoStop ? steady.GetMean (i)
+                                            : flow.rxBytes * 8.0 /
+                                                  (stopTime - kAppStart) / 1e6;
         }
     }
 
+  // Marks are congestion signals that cost no retransmission
+  const QueueDisc::Stats &qstats = bottleneckQueue->GetStats ();
+  metrics[3 * sources.GetN ()] = qstats.nTotalDroppedPackets;
+  metrics[3 * sources.GetN () + 1] = qstats.nTotalMarkedPackets;
+  if (opt.verbose)
+    {
+      std::cout << "Bottleneck RED" << (opt.dctcp ? " (step marking, DCTCP)" : opt.ecn ? " (ECN)" : "")
+                << ": " << qstats.nTotalDroppedPackets << " drops, "
+                << qstats.nTotalMarkedPackets << " marks\n";
+    }
+
+  if (opt.verbose && opt.autoStop)
+    steady.Print (std::cout);
+
+  FlowLatencyMap flows;
+  for (uint32_t i = 0; i < sources.GetN (); i++)
+    {
+      flows["source " + std::to_string (i)] =
+          latency.GetFlow (dumbbell.accessInterfaces[i].GetAddress (0), 6);
+    }
+  if (opt.verbose)
+    {
+      std::cout << "\nData flow latency:\n";
+      PrintFlowLatency (std::cout, flows);
+    }
+
+  if (!opt.cwndFile.empty ())
+    cwndRecorder.WriteCsv (opt.cwndFile);
+
   Simulator::Destroy ();
-  return 0;
+  return ReplicationOutput{metrics, SerializeFlowLatency (flows)};
 }
 
+int main (int argc, char *argv[])
+{
+  Time::SetResolution (Time::NS);
+
+  // ---------- Replication ----------
+  // With replications > 1, every replication is an independent RngRun
+  // stream run in its own process; RED's random early drops make them differ.
+  ReplicationConfig rep;
+  rep.maxReplications = 1;
+  AqmRedOptions opt;
+  std::string scheduler = "";
+  double schedulerProbe = 3.0;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("run", "RngRun of the (first) replication", rep.firstRun);
+  cmd.AddValue ("replications", "Maximum number of replications", rep.maxReplications);
+  cmd.AddValue ("minReplications", "Replications before early stop is considered", rep.minReplications);
+  cmd.AddValue ("precision", "Stop once CI half-width <= precision * |mean| (0 = never)", rep.relativePrecision);
+  cmd.AddValue ("confidence", "Confidence level of the intervals", rep.confidence);
+  cmd.AddValue ("jobs", "Replications run concurrently", rep.jobs);
+  cmd.AddValue ("cwndFile", "CSV for the senders' cwnd/RTT time series (single run only)", opt.cwndFile);
+  cmd.AddValue ("cwndInterval", "Sampling interval (s) of the cwnd time series (0 = every change)", opt.cwndInterval);
+  cmd.AddValue ("windowInterval", "Per-flow statistics window (s, 0 = off)", opt.windowInterval);
+  cmd.AddValue ("windowFile", "CSV receiving every per-flow window", opt.windowFile);
+  cmd.AddValue ("monitor", "Flow statistics: full (FlowMonitor on every node) or edge (EdgeFlowMonitor)", opt.monitor);
+  cmd.AddValue ("limit", "RED MaxSize (packets)", opt.limit);
+  cmd.AddValue ("bottleneckRate", "Bottleneck link rate", opt.bottleneckRate);
+  cmd.AddValue ("bottleneckDelay", "Bottleneck link delay", opt.bottleneckDelay);
+  cmd.AddValue ("minTh", "RED minimum threshold (packets)", opt.minTh);
+  cmd.AddValue ("maxTh", "RED maximum threshold (packets)", opt.maxTh);
+  cmd.AddValue ("maxP", "RED maximum drop probability", opt.maxP);
+  cmd.AddValue ("qw", "RED queue weight", opt.qw);
+  cmd.AddValue ("ecn", "RED marks (UseEcn, no hard drop) and senders negotiate ECN", opt.ecn);
+  cmd.AddValue ("dctcp", "Step marking at stepK packets with DCTCP senders", opt.dctcp);
+  cmd.AddValue ("stepK", "DCTCP marking threshold (packets)", opt.stepK);
+  cmd.AddValue ("autoStop", "Stop at steady state (MSER-5) instead of at the fixed stop time", opt.autoStop);
+  cmd.AddValue ("ssInterval", "Steady-state detection window (s)", opt.ssInterval);
+  cmd.AddValue ("ssTolerance", "Steady when every CI half-width <= tolerance * |mean|", opt.ssTolerance);
+  cmd.AddValue ("scheduler", "Event scheduler (Map, Heap, List, Calendar, PriorityQueue; auto = fastest in a probe run)", scheduler);
+  cmd.AddValue ("schedulerProbe", "Simulated seconds of each --scheduler=auto probe", schedulerProbe);
+  cmd.AddValue ("sloQuantile", "Delay quantile checked against sloMs", opt.sloQuantile);
+  cmd.AddValue ("sloMs", "Fail unless every source's delay quantile is <= sloMs (0 = off)", opt.sloMs);
+  cmd.Parse (argc, argv);
+
+  if (opt.monitor != "full" && opt.monitor != "edge")
+    NS_FATAL_ERROR ("Unknown --monitor=" << opt.monitor);
+
+  // ---------- Scheduler ----------
+  if (scheduler == "auto")
+    {
+      AqmRedOptions probe = opt;
+      probe.run = rep.firstRun;
+      probe.verbose = false;
+      probe.cwndFile = "";
+      probe.windowInterval = 0;
+      scheduler = SelectScheduler (SplitList (kSchedulerNames), schedulerProbe,
+                                   [probe] () { RunAqmRed (probe); });
+    }
+
+  if (rep.maxReplications <= 1)
+    {
+      if (!scheduler.empty ())
+        UseScheduler (scheduler);
+      opt.run = rep.firstRun;
+      FlowLatencyMap flows;
+      MergeFlowLatency (flows, RunAqmRed (opt).payload);
+      if (opt.sloMs > 0 && !CheckLatencySlo (std::cout, flows, opt.sloQuantile, opt.sloMs))
+        return 1;
+      return 0;
+    }
+
+  opt.verbose = false;
+  opt.cwndFile = "";
+  opt.windowInterval = 0;
+
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < DumbbellConfig ().nClients; i++)
+    {
+      std::string src = "source " + std::to_string (i);
+      names.push_back (src + " lost packets");
+      names.push_back (src + " mean delay (s)");
+      names.push_back (src + " throughput (Mbps)");
+    }
+  names.push_back ("bottleneck drops");
+  names.push_back ("bottleneck marks");
+
+  // The sketches merge exactly, so the quantiles below are those of every
+  // packet of every replication, not an average of per-run quantiles
+  FlowLatencyMap flows;
+  std::vector<RunningStat> stats =
+      RunReplications (rep, names, [opt, scheduler] (uint32_t run) {
+        if (!scheduler.empty ())
+          UseScheduler (scheduler);
+        AqmRedOptions o = opt;
+        o.run = run;
+        return RunAqmRed (o);
+      },
+      [&flows] (const std::string &payload) { MergeFlowLatency (flows, payload); });
+  PrintReplicationSummary (rep, names, stats);
+  std::cout << "\nData flow latency, all replications:\n";
+  PrintFlowLatency (std::cout, flows);
+  if (opt.sloMs > 0 && !CheckLatencySlo (std::cout, flows, opt.sloQuantile, opt.sloMs))
+    return 1;
+  return 0;
+}
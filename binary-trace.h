@@ -0,0 +1,395 @@
+/*
+ * Compact binary packet trace for point-to-point links.
+ *
+ * AsciiTraceHelper formats a full text line (with every header printed) for
+ * each event, which dominates long runs. BinaryTraceSink stores one fixed
+ * 40-byte record per event instead: time, packet uid, node, device, event,
+ * 5-tuple and size. Headers are read from the first bytes of the packet
+ * (Packet::CopyData into a stack buffer), so no Packet is copied.
+ *
+ * Filtering happens as early as possible:
+ *   - node/device: only devices passed to Attach() are traced;
+ *   - event type: sources not in the event mask are never connected;
+ *   - flow: optional src/dst/port/protocol match on the parsed header;
+ *   - sampling: keep 1 in N packets, chosen by packet uid so a sampled
+ *     packet is kept on every hop and path queries stay complete.
+ *
+ * Records are filled into fixed blocks; full blocks are handed to a
+ * background writer thread, so the simulation thread never waits on disk
+ * unless the writer falls a whole pool of blocks behind.
+ *
+ * Query the file with trace-query.cc (memory-mapped).
+ */
+
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char kPacketTraceMagic[8] = {'P', 'K', 'T', 'T', 'R', 'C', '0', '1'};
+static const uint32_t kPacketTraceVersion = 1;
+
+enum PacketTraceEvent : uint8_t
+{
+    TRACE_ENQUEUE = 0, // handed to the device (MacTx)
+    TRACE_TX = 1,      // first bit on the wire (PhyTxBegin)
+    TRACE_RX = 2,      // received and passed up (MacRx)
+    TRACE_DROP = 3,    // MacTxDrop or PhyRxDrop
+};
+
+static const uint32_t kTraceAllEvents = 0xf;
+
+struct PacketTraceFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+};
+
+struct PacketTraceRecord
+{
+    int64_t timeNs;
+    uint64_t uid;       // Packet::GetUid(), identical on every hop
+    uint32_t node;
+    uint32_t size;      // bytes as seen by the trace source
+    uint32_t src;       // IPv4, host order; 0 when not IPv4
+    uint32_t dst;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint16_t device;    // NetDevice::GetIfIndex()
+    uint8_t event;      // PacketTraceEvent
+    uint8_t protocol;
+};
+
+static_assert(sizeof(PacketTraceRecord) == 40, "PacketTraceRecord must stay 40 bytes on disk");
+
+struct PacketTraceFilter
+{
+    uint32_t src = 0;      // 0 = any
+    uint32_t dst = 0;      // 0 = any
+    uint16_t port = 0;     // matches either port, 0 = any
+    uint8_t protocol = 0;  // 0 = any
+
+    bool Active() const
+    {
+        return src || dst || port || protocol;
+    }
+};
+
+class BinaryTraceSink
+{
+  public:
+    BinaryTraceSink(const std::string &fileName, size_t blockRecords = 65536, size_t nBlocks = 4)
+        : m_eventMask(kTraceAllEvents),
+          m_sampleEvery(1),
+          m_blockRecords(blockRecords),
+          m_stop(false),
+          m_written(0)
+    {
+        m_file = std::fopen(fileName.c_str(), "wb");
+        if (!m_file)
+        {
+            NS_FATAL_ERROR("Cannot open packet trace " << fileName);
+        }
+        PacketTraceFileHeader hdr;
+        std::memcpy(hdr.magic, kPacketTraceMagic, sizeof(hdr.magic));
+        hdr.version = kPacketTraceVersion;
+        hdr.recordSize = sizeof(PacketTraceRecord);
+        std::fwrite(&hdr, sizeof(hdr), 1, m_file);
+
+        for (size_t i = 0; i < nBlocks; i++)
+        {
+            m_free.emplace_back();
+            m_free.back().reserve(blockRecords);
+        }
+        m_active.reserve(blockRecords);
+        m_writer = std::thread(&BinaryTraceSink::WriterLoop, this);
+    }
+
+    ~BinaryTraceSink()
+    {
+        Close();
+    }
+
+    BinaryTraceSink(const BinaryTraceSink &) = delete;
+    BinaryTraceSink &operator=(const BinaryTraceSink &) = delete;
+
+    /* ---------- FILTERS (set before Attach) ---------- */
+
+    // Bitmask of (1 << PacketTraceEvent)
+    void SetEventMask(uint32_t mask)
+    {
+        m_eventMask = mask;
+    }
+
+    // Keep packets whose uid % n == 0.
+    void SetSampling(uint32_t n)
+    {
+        m_sampleEvery = n > 0 ? n : 1;
+    }
+
+    void SetFlowFilter(const PacketTraceFilter &filter)
+    {
+        m_filter = filter;
+    }
+
+    /* ---------- SOURCES ---------- */
+
+    void Attach(ns3::Ptr<ns3::NetDevice> device)
+    {
+        using namespace ns3;
+
+        Ptr<PointToPointNetDevice> p2p = DynamicCast<PointToPointNetDevice>(device);
+        NS_ABORT_MSG_UNLESS(p2p, "BinaryTraceSink only traces PointToPointNetDevice");
+
+        uint64_t base = (uint64_t(device->GetNode()->GetId()) << 24) | (uint64_t(device->GetIfIndex()) << 8);
+        if (m_eventMask & (1 << TRACE_ENQUEUE))
+        {
+            p2p->TraceConnectWithoutContext("MacTx",
+                MakeBoundCallback(&BinaryTraceSink::Trace, this, base | TRACE_ENQUEUE));
+        }
+        if (m_eventMask & (1 << TRACE_TX))
+        {
+            p2p->TraceConnectWithoutContext("PhyTxBegin",
+                MakeBoundCallback(&BinaryTraceSink::Trace, this, base | TRACE_TX));
+        }
+        if (m_eventMask & (1 << TRACE_RX))
+        {
+            p2p->TraceConnectWithoutContext("MacRx",
+                MakeBoundCallback(&BinaryTraceSink::Trace, this, base | TRACE_RX));
+        }
+        if (m_eventMask & (1 << TRACE_DROP))
+        {
+            p2p->TraceConnectWithoutContext("MacTxDrop",
+                MakeBoundCallback(&BinaryTraceSink::Trace, this, base | TRACE_DROP));
+            p2p->TraceConnectWithoutContext("PhyRxDrop",
+                MakeBoundCallback(&BinaryTraceSink::Trace, this, base | TRACE_DROP));
+        }
+    }
+
+    void Attach(const ns3::NetDeviceContainer &devices)
+    {
+        for (uint32_t i = 0; i < devices.GetN(); i++)
+        {
+            Attach(devices.Get(i));
+        }
+    }
+
+    uint64_t GetRecordCount() const
+    {
+        return m_recorded;
+    }
+
+    // Flushes the partial block and waits for the writer to finish.
+    void Close()
+    {
+        if (!m_file)
+        {
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!m_active.empty())
+            {
+                m_full.push_back(std::move(m_active));
+            }
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_writer.join();
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+
+  private:
+    static void Trace(BinaryTraceSink *sink, uint64_t key, ns3::Ptr<const ns3::Packet> p)
+    {
+        sink->Record(key, p);
+    }
+
+    void Record(uint64_t key, ns3::Ptr<const ns3::Packet> p)
+    {
+        uint64_t uid = p->GetUid();
+        if (uid % m_sampleEvery != 0)
+        {
+            return;
+        }
+
+        PacketTraceRecord r;
+        std::memset(&r, 0, sizeof(r));
+        r.timeNs = ns3::Simulator::Now().GetNanoSeconds();
+        r.uid = uid;
+        r.node = key >> 24;
+        r.device = (key >> 8) & 0xffff;
+        r.event = key & 0x0f;
+        r.size = p->GetSize();
+        ParseHeaders(p, r);
+
+        if (m_filter.Active() && !Matches(r))
+        {
+            return;
+        }
+
+        m_recorded++;
+        m_active.push_back(r);
+        if (m_active.size() >= m_blockRecords)
+        {
+            SwapBlock();
+        }
+    }
+
+    /*
+     * Reads IPv4 + TCP/UDP ports straight from the serialized bytes. Most
+     * point-to-point sources (MacTx, MacRx, MacTxDrop, PhyTxBegin,
+     * PhyRxDrop) see the 2-byte PPP header, but MacTxDrop on a link that is
+     * down fires before it is added; a leading 0x0021 (PPP IPv4) tells them
+     * apart, as an IPv4 header never starts with a zero byte.
+     */
+    static void ParseHeaders(ns3::Ptr<const ns3::Packet> p, PacketTraceRecord &r)
+    {
+        uint8_t buf[64];
+        uint32_t n = p->CopyData(buf, sizeof(buf));
+        if (n < 2)
+        {
+            return;
+        }
+        uint32_t offset = ((buf[0] << 8) | buf[1]) == 0x0021 ? 2 : 0;
+        if (n < offset + 20)
+        {
+            return;
+        }
+        const uint8_t *ip = buf + offset;
+        if ((ip[0] >> 4) != 4)
+        {
+            return;
+        }
+        uint32_t ihl = (ip[0] & 0x0f) * 4;
+        r.protocol = ip[9];
+        r.src = (uint32_t(ip[12]) << 24) | (ip[13] << 16) | (ip[14] << 8) | ip[15];
+        r.dst = (uint32_t(ip[16]) << 24) | (ip[17] << 16) | (ip[18] << 8) | ip[19];
+
+        bool firstFragment = ((ip[6] & 0x1f) | ip[7]) == 0;
+        if ((r.protocol == 6 || r.protocol == 17) && firstFragment && n >= offset + ihl + 4)
+        {
+            const uint8_t *l4 = ip + ihl;
+            r.srcPort = (l4[0] << 8) | l4[1];
+            r.dstPort = (l4[2] << 8) | l4[3];
+        }
+    }
+
+    bool Matches(const PacketTraceRecord &r) const
+    {
+        return (!m_filter.src || m_filter.src == r.src) &&
+               (!m_filter.dst || m_filter.dst == r.dst) &&
+               (!m_filter.protocol || m_filter.protocol == r.protocol) &&
+               (!m_filter.port || m_filter.port == r.srcPort || m_filter.port == r.dstPort);
+    }
+
+    void SwapBlock()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_full.push_back(std::move(m_active));
+        m_cv.notify_all();
+        // Back-pressure: wait only when the writer holds every block.
+        m_cv.wait(lock, [this] { return !m_free.empty(); });
+        m_active = std::move(m_free.front());
+        m_free.pop_front();
+        m_active.clear();
+    }
+
+    void WriterLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_cv.wait(lock, [this] { return m_stop || !m_full.empty(); });
+            if (m_full.empty())
+            {
+                if (m_stop)
+                {
+                    break;
+                }
+                continue;
+            }
+            std::vector<PacketTraceRecord> block = std::move(m_full.front());
+            m_full.pop_front();
+
+            lock.unlock();
+            std::fwrite(block.data(), sizeof(PacketTraceRecord), block.size(), m_file);
+            lock.lock();
+
+            m_written += block.size();
+            block.clear();
+            m_free.push_back(std::move(block));
+            m_cv.notify_all();
+        }
+    }
+
+    std::FILE *m_file;
+    uint32_t m_eventMask;
+    uint32_t m_sampleEvery;
+    PacketTraceFilter m_filter;
+    size_t m_blockRecords;
+    uint64_t m_recorded = 0;
+
+    // Owned by the simulation thread
+    std::vector<PacketTraceRecord> m_active;
+
+    // Shared with the writer, guarded by m_mutex
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::vector<PacketTraceRecord>> m_full;
+    std::deque<std::vector<PacketTraceRecord>> m_free;
+    bool m_stop;
+    uint64_t m_written;
+    std::thread m_writer;
+};
+
+/*
+ * Parses a comma-separated event list ("enqueue,tx,rx,drop" or "all") into
+ * a BinaryTraceSink event mask.
+ */
+inline uint32_t
+ParseTraceEvents(const std::string &list)
+{
+    uint32_t mask = 0;
+    std::string cur;
+    for (size_t i = 0; i <= list.size(); i++)
+    {
+        if (i == list.size() || list[i] == ',')
+        {
+            if (cur == "all")
+                mask |= kTraceAllEvents;
+            else if (cur == "enqueue")
+                mask |= 1 << TRACE_ENQUEUE;
+            else if (cur == "tx")
+                mask |= 1 << TRACE_TX;
+            else if (cur == "rx")
+                mask |= 1 << TRACE_RX;
+            else if (cur == "drop")
+                mask |= 1 << TRACE_DROP;
+            else if (!cur.empty())
+                NS_FATAL_ERROR("Unknown trace event " << cur);
+            cur.clear();
+        }
+        else
+        {
+            cur += list[i];
+        }
+    }
+    return mask;
+}
+
+#endif /* BINARY_TRACE_H */
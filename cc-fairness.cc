@@ -0,0 +1,342 @@
+/*
+ * Many-flow congestion-control fairness over the shared dumbbell.
+ *
+ * --flows BulkSend senders, one per client, share the bottleneck. Each
+ * client's TcpL4Protocol gets its own SocketType, assigned round-robin from
+ * --variants, so NewReno, Cubic, BBR, DCTCP, Vegas, ... compete directly.
+ * Access-link delays are spread evenly between --minDelay and --maxDelay
+ * (interleaved with the variants, so every variant sees the same RTT mix)
+ * and flow i starts at appStart + i * stagger.
+ *
+ * Every --interval the per-flow sink counters are folded into that
+ * window's Jain's fairness index over the active flows, per-variant goodput
+ * and bottleneck utilisation. Windows are streamed to --output and only
+ * running aggregates are kept, so hundreds of flows cost O(flows) memory.
+ *
+ * With an ECN-marking --aqm (red-ecn, dctcp) every sender negotiates ECN;
+ * Dctcp is only accepted with one, as it would be plain Reno otherwise.
+ * --pacing applies to every variant alike (Bbr requires it), so a result
+ * does not depend on which other variants are in the mix.
+ *
+ * Example:
+ *   ./ns3 run "cc-fairness --flows=200 --variants=NewReno,Cubic,Bbr,Vegas
+ *              --bottleneckRate=1Gbps --minDelay=1ms --maxDelay=50ms --simTime=60"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include "aqm-scenario.h"
+#include "dumbbell-helper.h"
+#include "parallel-runner.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("CcFairness");
+
+// Jain's index of x: (sum x)^2 / (n * sum x^2); 1 = perfectly fair
+static double
+JainIndex(double sum, double sumSq, uint32_t n)
+{
+    return (n == 0 || sumSq == 0) ? 1.0 : sum * sum / (n * sumSq);
+}
+
+class FairnessMonitor
+{
+  public:
+    FairnessMonitor(const std::vector<Ptr<PacketSink>> &sinks, const std::vector<uint32_t> &variantOf,
+                    const std::vector<std::string> &variants, const std::vector<Time> &start,
+                    double bottleneckBps, Time interval)
+        : m_sinks(sinks),
+          m_variantOf(variantOf),
+          m_variants(variants),
+          m_start(start),
+          m_lastRx(sinks.size(), 0),
+          m_bottleneckBps(bottleneckBps),
+          m_interval(interval)
+    {
+    }
+
+    void SetOutput(const std::string &file)
+    {
+        m_csv.open(file);
+        m_csv << "time_s,active_flows,jain,utilisation";
+        for (auto const &v : m_variants)
+        {
+            m_csv << "," << v << "_mbps";
+        }
+        m_csv << "\n";
+    }
+
+    // Windows before `from` (e.g. until every flow has started) are streamed
+    // but not averaged
+    void Start(Time first, Time from)
+    {
+        m_averageFrom = from;
+        Simulator::Schedule(first, &FairnessMonitor::Sample, this);
+    }
+
+    double GetMeanJain() const { return m_windows ? m_jainSum / m_windows : 0.0; }
+
+    double GetMinJain() const { return m_windows ? m_jainMin : 0.0; }
+
+    double GetMeanUtilisation() const { return m_windows ? m_utilSum / m_windows : 0.0; }
+
+  private:
+    void Sample()
+    {
+        Time now = Simulator::Now();
+        double secs = m_interval.GetSeconds();
+        double sum = 0, sumSq = 0;
+        uint32_t active = 0;
+        std::vector<double> variantBps(m_variants.size(), 0.0);
+
+        for (size_t i = 0; i < m_sinks.size(); i++)
+        {
+            uint64_t rx = m_sinks[i]->GetTotalRx();
+            double bps = (rx - m_lastRx[i]) * 8.0 / secs;
+            variantBps[m_variantOf[i]] += bps;
+            m_lastRx[i] = rx;
+            // A flow counts once it has been running for a whole window
+            if (m_start[i] + m_interval <= now)
+            {
+                sum += bps;
+                sumSq += bps * bps;
+                active++;
+            }
+        }
+
+        double jain = JainIndex(sum, sumSq, active);
+        double util = std::accumulate(variantBps.begin(), variantBps.end(), 0.0) / m_bottleneckBps;
+        if (now >= m_averageFrom && active > 0)
+        {
+            m_jainSum += jain;
+            m_utilSum += util;
+            m_jainMin = m_windows ? std::min(m_jainMin, jain) : jain;
+            m_windows++;
+        }
+
+        if (m_csv.is_open())
+        {
+            m_csv << now.GetSeconds() << "," << active << "," << jain << "," << util;
+            for (double bps : variantBps)
+            {
+                m_csv << "," << bps / 1e6;
+            }
+            m_csv << "\n";
+        }
+        Simulator::Schedule(m_interval, &FairnessMonitor::Sample, this);
+    }
+
+    std::vector<Ptr<PacketSink>> m_sinks;
+    std::vector<uint32_t> m_variantOf;
+    std::vector<std::string> m_variants;
+    std::vector<Time> m_start;
+    std::vector<uint64_t> m_lastRx;
+    double m_bottleneckBps;
+    Time m_interval;
+    Time m_averageFrom;
+
+    uint64_t m_windows = 0;
+    double m_jainSum = 0;
+    double m_jainMin = 1;
+    double m_utilSum = 0;
+    std::ofstream m_csv;
+};
+
+int main(int argc, char *argv[])
+{
+    // --- 1. CONFIGURATION ---
+    uint32_t flows = 20;
+    std::string variantList = "NewReno,Cubic,Bbr,Vegas";
+    std::string accessRate = "1Gbps";
+    std::string bottleneckRate = "100Mbps";
+    std::string bottleneckDelay = "5ms";
+    std::string minDelay = "1ms";
+    std::string maxDelay = "40ms";
+    std::string aqm = "fifo";
+    std::string limit = "1000p";
+    uint32_t segmentSize = 1448;
+    double appStart = 1.0;
+    double stagger = 0.05;
+    double interval = 0.5;
+    double simTime = 30.0;
+    bool light = true;
+    bool pacing = true;
+    std::string output = "cc-fairness.csv";
+    uint32_t run = 1;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("flows", "Number of BulkSend senders (one client each)", flows);
+    cmd.AddValue("variants", "TcpCongestionOps assigned round-robin (ns3::Tcp<name>)", variantList);
+    cmd.AddValue("accessRate", "Access link rate", accessRate);
+    cmd.AddValue("minDelay", "Smallest access link delay", minDelay);
+    cmd.AddValue("maxDelay", "Largest access link delay", maxDelay);
+    cmd.AddValue("bottleneckRate", "Bottleneck link rate", bottleneckRate);
+    cmd.AddValue("bottleneckDelay", "Bottleneck link delay", bottleneckDelay);
+    cmd.AddValue("aqm", "Bottleneck queue disc preset (aqm-scenario.h)", aqm);
+    cmd.AddValue("limit", "Bottleneck queue disc limit", limit);
+    cmd.AddValue("segmentSize", "TCP segment size (bytes)", segmentSize);
+    cmd.AddValue("pacing", "TCP pacing for every variant (Bbr needs it)", pacing);
+    cmd.AddValue("stagger", "Start offset between consecutive flows (s)", stagger);
+    cmd.AddValue("interval", "Fairness window (s)", interval);
+    cmd.AddValue("simTime", "Simulated seconds", simTime);
+    cmd.AddValue("light", "Lightweight dumbbell setup (dumbbell-helper.h)", light);
+    cmd.AddValue("output", "CSV of every window (empty = off)", output);
+    cmd.AddValue("run", "RngRun", run);
+    cmd.Parse(argc, argv);
+
+    std::vector<std::string> variants = SplitList(variantList);
+    std::vector<TypeId> variantTid;
+    for (auto const &v : variants)
+    {
+        TypeId tid;
+        if (!TypeId::LookupByNameFailSafe("ns3::Tcp" + v, &tid))
+        {
+            NS_FATAL_ERROR("Unknown congestion control ns3::Tcp" << v);
+        }
+        variantTid.push_back(tid);
+    }
+    if (flows == 0 || variants.empty())
+    {
+        NS_FATAL_ERROR("Need at least one flow and one variant");
+    }
+    // The averaged windows start two intervals after the last flow
+    if (appStart + (flows - 1) * stagger + 2 * interval >= simTime)
+    {
+        NS_FATAL_ERROR("The last flow starts at " << appStart + (flows - 1) * stagger
+                                                  << " s, too late for a fairness window before --simTime="
+                                                  << simTime << "; lower --stagger or raise --simTime");
+    }
+
+    auto hasVariant = [&](const std::string &name) {
+        return std::find(variants.begin(), variants.end(), name) != variants.end();
+    };
+    // TcpBbr asserts that its socket paces
+    if (hasVariant("Bbr") && !pacing)
+    {
+        NS_FATAL_ERROR("Bbr needs --pacing=true");
+    }
+
+    AqmConfig aqmCfg = AqmPreset(aqm, limit, bottleneckRate, bottleneckDelay);
+    if (hasVariant("Dctcp") && !aqmCfg.senderEcn)
+    {
+        NS_FATAL_ERROR("Dctcp needs an ECN-marking --aqm (red-ecn or dctcp), not " << aqm);
+    }
+
+    RngSeedManager::SetRun(run);
+    Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue(segmentSize));
+    Config::SetDefault("ns3::TcpSocketState::EnablePacing", BooleanValue(pacing));
+
+    aqmCfg.senderTcp = ""; // per client below
+    ApplyAqmSenderDefaults(aqmCfg);
+
+    // --- 2. TOPOLOGY (heterogeneous RTTs) ---
+    DumbbellConfig cfg;
+    cfg.nClients = flows;
+    cfg.accessRate = accessRate;
+    cfg.bottleneckRate = bottleneckRate;
+    cfg.bottleneckDelay = bottleneckDelay;
+    cfg.lightweight = light;
+
+    // Delays step with i / V so each variant gets every RTT in turn
+    double dMin = Time(minDelay).GetSeconds();
+    double dMax = Time(maxDelay).GetSeconds();
+    uint32_t V = variants.size();
+    uint32_t steps = (flows + V - 1) / V;
+    for (uint32_t i = 0; i < flows; i++)
+    {
+        double frac = steps > 1 ? double(i / V) / (steps - 1) : 0.0;
+        cfg.accessDelays.push_back(std::to_string((dMin + frac * (dMax - dMin)) * 1e6) + "us");
+    }
+
+    Dumbbell d = BuildDumbbell(cfg);
+    InstallAqm(d.BottleneckDevice(), aqmCfg);
+
+    std::vector<uint32_t> variantOf(flows);
+    for (uint32_t i = 0; i < flows; i++)
+    {
+        variantOf[i] = i % V;
+        d.clients.Get(i)->GetObject<TcpL4Protocol>()->SetAttribute("SocketType",
+                                                                   TypeIdValue(variantTid[i % V]));
+    }
+
+    // --- 3. APPLICATIONS ---
+    std::vector<Ptr<PacketSink>> sinks;
+    std::vector<Time> start;
+    for (uint32_t i = 0; i < flows; i++)
+    {
+        uint16_t port = 50000 + i;
+        PacketSinkHelper sink("ns3::TcpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), port));
+        ApplicationContainer sinkApp = sink.Install(d.server);
+        sinkApp.Start(Seconds(0.0));
+        sinkApp.Stop(Seconds(simTime));
+        sinks.push_back(DynamicCast<PacketSink>(sinkApp.Get(0)));
+
+        BulkSendHelper bulk("ns3::TcpSocketFactory", InetSocketAddress(d.ServerAddress(), port));
+        bulk.SetAttribute("MaxBytes", UintegerValue(0));
+        ApplicationContainer app = bulk.Install(d.clients.Get(i));
+        start.push_back(Seconds(appStart + i * stagger));
+        app.Start(start.back());
+        app.Stop(Seconds(simTime));
+    }
+
+    // --- 4. STREAMING FAIRNESS ---
+    double bottleneckBps = DataRate(bottleneckRate).GetBitRate();
+    FairnessMonitor monitor(sinks, variantOf, variants, start, bottleneckBps, Seconds(interval));
+    if (!output.empty())
+    {
+        monitor.SetOutput(output);
+    }
+    // Averages start one window after the last flow has started
+    monitor.Start(Seconds(appStart + interval), start.back() + Seconds(2 * interval));
+
+    Simulator::Stop(Seconds(simTime));
+    Simulator::Run();
+
+    // --- 5. REPORT ---
+    // Long-run goodput of every flow over the time it was sending
+    double sum = 0, sumSq = 0;
+    std::vector<double> variantSum(V, 0.0), variantSumSq(V, 0.0);
+    std::vector<uint32_t> variantFlows(V, 0);
+    for (uint32_t i = 0; i < flows; i++)
+    {
+        double mbps = sinks[i]->GetTotalRx() * 8.0 / (simTime - start[i].GetSeconds()) / 1e6;
+        sum += mbps;
+        sumSq += mbps * mbps;
+        variantSum[variantOf[i]] += mbps;
+        variantSumSq[variantOf[i]] += mbps * mbps;
+        variantFlows[variantOf[i]]++;
+    }
+
+    std::cout << flows << " flows over " << bottleneckRate << " (" << aqm << " " << limit
+              << "), access delays " << minDelay << " .. " << maxDelay << "\n\n"
+              << std::left << std::setw(10) << "variant" << std::right << std::setw(7) << "flows"
+              << std::setw(14) << "goodput_mbps" << std::setw(14) << "per_flow_mbps" << std::setw(8)
+              << "share" << std::setw(12) << "intra_jain" << "\n"
+              << std::fixed << std::setprecision(3);
+    for (uint32_t v = 0; v < V; v++)
+    {
+        std::cout << std::left << std::setw(10) << variants[v] << std::right << std::setw(7)
+                  << variantFlows[v] << std::setw(14) << variantSum[v] << std::setw(14)
+                  << (variantFlows[v] ? variantSum[v] / variantFlows[v] : 0.0) << std::setw(7)
+                  << (sum > 0 ? 100.0 * variantSum[v] / sum : 0.0) << "%" << std::setw(12)
+                  << JainIndex(variantSum[v], variantSumSq[v], variantFlows[v]) << "\n";
+    }
+    std::cout << "\nJain's index, long-run goodput:  " << JainIndex(sum, sumSq, flows)
+              << "\nJain's index, windows mean/min:  " << monitor.GetMeanJain() << " / "
+              << monitor.GetMinJain()
+              << "\nBottleneck utilisation (windows): " << monitor.GetMeanUtilisation() << std::endl;
+
+    Simulator::Destroy();
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * Shared clients -> router -> server dumbbell used by the drop, AQM and
+ * TCP-vs-UDP scenarios.
+ *
+ * Topology (nClients = 2 gives the layout the scripts always used):
+ *
+ *   client 0 --access--+
+ *                      |
+ *   client 1 --access--+-- router --bottleneck-- server
+ *        ...           |
+ *   client N-1 -access-+
+ *
+ * Addressing keeps the historical plan: client i sits on 10.1.(i+1).0/24
+ * and the bottleneck takes the next /24 (10.1.3.0 for two clients). Past
+ * 254 clients Ipv4AddressHelper::NewNetwork() simply rolls over to 10.2.x.
+ *
+ * Lightweight mode (cfg.lightweight) is for thousands of clients, where the
+ * default setup costs more memory and time than the simulation:
+ *   - IPv4 only: no IPv6 stack, ICMPv6 or IPv6 routing on any node;
+ *   - static routing only: clients and server get a default route to the
+ *     router, which already has a connected route per link, so no global
+ *     routing SPF and no per-node table of every client network;
+ *   - access links are /30s from 10.0.0.0 (room for 4M clients) and keep
+ *     only their device queue, without a root queue disc on either end.
+ * The bottleneck devices keep their queue discs in both modes.
+ *
+ * Only the topology lives here. Queue discs, applications and traces differ
+ * per experiment, so every script still installs those itself on the
+ * returned devices.
+ */
+
+#ifndef DUMBBELL_HELPER_H
+#define DUMBBELL_HELPER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include "memory-probe.h"
+
+#include <string>
+#include <vector>
+
+struct DumbbellConfig
+{
+    uint32_t nClients = 2;
+
+    std::string accessRate = "10Mbps";
+    std::string accessDelay = "2ms";
+    // Per-client access delays (heterogeneous RTTs); client i uses
+    // accessDelays[i] when present, accessDelay otherwise.
+    std::vector<std::string> accessDelays;
+
+    std::string bottleneckRate = "5Mbps";
+    std::string bottleneckDelay = "10ms";
+
+    // Device (not qdisc) queue on the bottleneck, e.g. "1p". Empty keeps the
+    // PointToPointNetDevice default.
+    std::string bottleneckDeviceQueue = "";
+
+    // IPv4-only, statically routed, queue-disc-free access side (see above)
+    bool lightweight = false;
+};
+
+struct Dumbbell
+{
+    ns3::NodeContainer clients;
+    ns3::NodeContainer router;
+    ns3::NodeContainer server;
+
+    // accessDevices[i] = (client i, router side)
+    std::vector<ns3::NetDeviceContainer> accessDevices;
+    // (router side, server side)
+    ns3::NetDeviceContainer bottleneckDevices;
+
+    std::vector<ns3::Ipv4InterfaceContainer> accessInterfaces;
+    ns3::Ipv4InterfaceContainer bottleneckInterfaces;
+
+    ns3::Ipv4Address ServerAddress() const
+    {
+        return bottleneckInterfaces.GetAddress(1);
+    }
+
+    // Router-side device of the bottleneck, where the qdisc under study goes.
+    ns3::Ptr<ns3::NetDevice> BottleneckDevice() const
+    {
+        return bottleneckDevices.Get(0);
+    }
+};
+
+/*
+ * Creates the nodes, links, Internet stack, addresses and routes. With
+ * memory set, the heap kept by each of those phases is recorded in it.
+ */
+inline Dumbbell
+BuildDumbbell(const DumbbellConfig &cfg, MemoryBreakdown *memory = nullptr)
+{
+    using namespace ns3;
+
+    Dumbbell d;
+    auto mark = [memory](const char *phase) {
+        if (memory)
+        {
+            memory->Mark(phase);
+        }
+    };
+
+    /* ---------- NODES ---------- */
+    d.clients.Create(cfg.nClients);
+    d.router.Create(1);
+    d.server.Create(1);
+    mark("nodes");
+
+    /* ---------- LINKS ---------- */
+    PointToPointHelper access;
+    access.SetDeviceAttribute("DataRate", StringValue(cfg.accessRate));
+    access.SetChannelAttribute("Delay", StringValue(cfg.accessDelay));
+
+    PointToPointHelper bottleneck;
+    bottleneck.SetDeviceAttribute("DataRate", StringValue(cfg.bottleneckRate));
+    bottleneck.SetChannelAttribute("Delay", StringValue(cfg.bottleneckDelay));
+    if (!cfg.bottleneckDeviceQueue.empty())
+    {
+        bottleneck.SetQueue("ns3::DropTailQueue<Packet>",
+                            "MaxSize", QueueSizeValue(QueueSize(cfg.bottleneckDeviceQueue)));
+    }
+
+    d.accessDevices.reserve(cfg.nClients);
+    for (uint32_t i = 0; i < cfg.nClients; i++)
+    {
+        if (i < cfg.accessDelays.size())
+        {
+            access.SetChannelAttribute("Delay", StringValue(cfg.accessDelays[i]));
+        }
+        else if (!cfg.accessDelays.empty())
+        {
+            access.SetChannelAttribute("Delay", StringValue(cfg.accessDelay));
+        }
+        d.accessDevices.push_back(access.Install(d.clients.Get(i), d.router.Get(0)));
+    }
+    d.bottleneckDevices = bottleneck.Install(d.router.Get(0), d.server.Get(0));
+    mark("links");
+
+    /* ---------- INTERNET ---------- */
+    InternetStackHelper stack;
+    Ipv4StaticRoutingHelper staticRouting;
+    if (cfg.lightweight)
+    {
+        stack.SetIpv6StackInstall(false);
+        stack.SetRoutingHelper(staticRouting);
+    }
+    stack.Install(d.clients);
+    stack.Install(d.router);
+    stack.Install(d.server);
+    mark("internet stack");
+
+    /* ---------- IP ADDRESSING ---------- */
+    Ipv4AddressHelper addr;
+    if (cfg.lightweight)
+    {
+        addr.SetBase("10.0.0.0", "255.255.255.252");
+    }
+    else
+    {
+        addr.SetBase("10.1.1.0", "255.255.255.0");
+    }
+
+    d.accessInterfaces.reserve(cfg.nClients);
+    for (uint32_t i = 0; i < cfg.nClients; i++)
+    {
+        d.accessInterfaces.push_back(addr.Assign(d.accessDevices[i]));
+        addr.NewNetwork();
+    }
+    d.bottleneckInterfaces = addr.Assign(d.bottleneckDevices);
+
+    if (cfg.lightweight)
+    {
+        // Assign() gave every device the default root queue disc
+        TrafficControlHelper tch;
+        for (auto const &devs : d.accessDevices)
+        {
+            tch.Uninstall(devs);
+        }
+    }
+    mark("addressing");
+
+    /* ---------- ROUTING ---------- */
+    if (cfg.lightweight)
+    {
+        for (uint32_t i = 0; i < cfg.nClients; i++)
+        {
+            Ptr<Ipv4> ipv4 = d.clients.Get(i)->GetObject<Ipv4>();
+            staticRouting.GetStaticRouting(ipv4)->SetDefaultRoute(d.accessInterfaces[i].GetAddress(1), 1);
+        }
+        Ptr<Ipv4> serverIpv4 = d.server.Get(0)->GetObject<Ipv4>();
+        staticRouting.GetStaticRouting(serverIpv4)->SetDefaultRoute(d.bottleneckInterfaces.GetAddress(0), 1);
+    }
+    else
+    {
+        Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    }
+    mark("routing");
+
+    return d;
+}
+
+#endif /* DUMBBELL_HELPER_H */
@@ -0,0 +1,232 @@
+/*
+ * Large-N dumbbell: thousands of clients fanning in to one server.
+ *
+ * Builds the shared dumbbell (dumbbell-helper.h) with --clients hosts,
+ * by default in its lightweight mode (IPv4 only, static default routes,
+ * no access-link queue discs), installs the traffic and, with
+ * --flowmon=edge, FlowMonitor probes on the clients and the server only
+ * (the router, which sees every packet, is left out). --flowmon=light
+ * instead hooks an EdgeFlowMonitor (edge-flow-monitor.h) into the same
+ * nodes (client egress and server ingress, packet counters only) and
+ * counts drops through the drop traces of every node.
+ *
+ * Traffic:
+ *   incast  every client sends --incastBytes at the same instant over TCP;
+ *           the completion time is when the server has all of them
+ *   bulk    every client runs an unlimited BulkSend, starts spread over
+ *           the first --stagger seconds
+ *   udp     every client sends --udpRate of CBR
+ *
+ * Reports setup and run wall time, events, goodput and the heap kept by
+ * every setup phase in total and per node, so the lightweight and the full
+ * setup (--light=false) can be compared at the same scale.
+ *
+ * Example:
+ *   ./ns3 run "dumbbell-scale --clients=20000 --traffic=incast --incastBytes=65536"
+ *   ./ns3 run "dumbbell-scale --clients=5000 --light=false --flowmon=all"
+ *   ./ns3 run "dumbbell-scale --clients=20000 --traffic=bulk --flowmon=light"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/flow-monitor-module.h"
+
+#include "dumbbell-helper.h"
+#include "edge-flow-monitor.h"
+#include "memory-probe.h"
+
+#include <chrono>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("DumbbellScale");
+
+static uint64_t g_rxBytes = 0;
+static uint64_t g_incastTarget = 0;
+static Time g_incastDone;
+
+static void
+SinkRx(Ptr<const Packet> p, const Address &)
+{
+    g_rxBytes += p->GetSize();
+    if (g_incastTarget && g_incastDone.IsZero() && g_rxBytes >= g_incastTarget)
+    {
+        g_incastDone = Simulator::Now();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // --- 1. CONFIGURATION ---
+    MemoryBreakdown memory;
+
+    DumbbellConfig cfg;
+    cfg.nClients = 5000;
+    cfg.accessRate = "1Gbps";
+    cfg.accessDelay = "10us";
+    cfg.bottleneckRate = "10Gbps";
+    cfg.bottleneckDelay = "50us";
+    cfg.lightweight = true;
+
+    std::string traffic = "incast";
+    uint32_t incastBytes = 64 * 1024;
+    double stagger = 0.1;
+    std::string udpRate = "1Mbps";
+    std::string flowmon = "edge";
+    double appStart = 0.1;
+    double simTime = 1.0;
+    uint32_t run = 1;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("clients", "Number of client hosts", cfg.nClients);
+    cmd.AddValue("light", "Lightweight end-host setup (IPv4 only, static routes, no access qdiscs)",
+                 cfg.lightweight);
+    cmd.AddValue("accessRate", "Access link rate", cfg.accessRate);
+    cmd.AddValue("accessDelay", "Access link delay", cfg.accessDelay);
+    cmd.AddValue("bottleneckRate", "Bottleneck link rate", cfg.bottleneckRate);
+    cmd.AddValue("bottleneckDelay", "Bottleneck link delay", cfg.bottleneckDelay);
+    cmd.AddValue("traffic", "incast, bulk or udp", traffic);
+    cmd.AddValue("incastBytes", "Bytes each client sends in incast mode", incastBytes);
+    cmd.AddValue("stagger", "Bulk/UDP start times spread over this many seconds", stagger);
+    cmd.AddValue("udpRate", "Per-client CBR rate in udp mode", udpRate);
+    cmd.AddValue("flowmon", "FlowMonitor probes: edge (clients + server), all, light (EdgeFlowMonitor) or none", flowmon);
+    cmd.AddValue("simTime", "Simulated seconds", simTime);
+    cmd.AddValue("run", "RngRun", run);
+    cmd.Parse(argc, argv);
+
+    if (traffic != "incast" && traffic != "bulk" && traffic != "udp")
+    {
+        NS_FATAL_ERROR("Unknown --traffic=" << traffic);
+    }
+    if (flowmon != "edge" && flowmon != "all" && flowmon != "light" && flowmon != "none")
+    {
+        NS_FATAL_ERROR("Unknown --flowmon=" << flowmon);
+    }
+
+    RngSeedManager::SetRun(run);
+    auto setupStart = std::chrono::steady_clock::now();
+
+    // --- 2. TOPOLOGY ---
+    memory.Mark("configuration");
+    Dumbbell d = BuildDumbbell(cfg, &memory);
+
+    // --- 3. APPLICATIONS ---
+    // One listening socket on the server accepts every client
+    uint16_t port = 50000;
+    bool udp = (traffic == "udp");
+    std::string factory = udp ? "ns3::UdpSocketFactory" : "ns3::TcpSocketFactory";
+    Address serverAddr = InetSocketAddress(d.ServerAddress(), port);
+
+    PacketSinkHelper sinkHelper(factory, InetSocketAddress(Ipv4Address::GetAny(), port));
+    ApplicationContainer sinks = sinkHelper.Install(d.server);
+    sinks.Start(Seconds(0.0));
+    sinks.Stop(Seconds(simTime));
+    sinks.Get(0)->TraceConnectWithoutContext("Rx", MakeCallback(&SinkRx));
+
+    Ptr<UniformRandomVariable> offset = CreateObject<UniformRandomVariable>();
+    offset->SetAttribute("Max", DoubleValue(traffic == "incast" ? 0.0 : stagger));
+
+    ApplicationContainer senders;
+    if (udp)
+    {
+        OnOffHelper onoff(factory, serverAddr);
+        onoff.SetConstantRate(DataRate(udpRate), 1000);
+        senders = onoff.Install(d.clients);
+    }
+    else
+    {
+        BulkSendHelper bulk(factory, serverAddr);
+        bulk.SetAttribute("MaxBytes", UintegerValue(traffic == "incast" ? incastBytes : 0));
+        senders = bulk.Install(d.clients);
+    }
+    for (uint32_t i = 0; i < senders.GetN(); i++)
+    {
+        senders.Get(i)->SetStartTime(Seconds(appStart + offset->GetValue()));
+    }
+    senders.Stop(Seconds(simTime));
+    if (traffic == "incast")
+    {
+        g_incastTarget = uint64_t(incastBytes) * cfg.nClients;
+    }
+    memory.Mark("applications");
+
+    // --- 4. FLOW MONITOR ---
+    FlowMonitorHelper flowmonHelper;
+    Ptr<FlowMonitor> monitor;
+    if (flowmon == "all")
+    {
+        monitor = flowmonHelper.InstallAll();
+    }
+    else if (flowmon == "edge")
+    {
+        flowmonHelper.Install(d.clients);
+        monitor = flowmonHelper.Install(d.server);
+    }
+    EdgeFlowMonitor light(EDGE_TX_PACKETS | EDGE_RX_PACKETS | EDGE_DROPS);
+    if (flowmon == "light")
+    {
+        light.InstallSenders(d.clients);
+        light.InstallReceivers(d.server);
+        light.InstallDropPoints(NodeContainer::GetGlobal());
+    }
+    memory.Mark("flow monitor");
+
+    double setupWall =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - setupStart).count();
+
+    // --- 5. RUN ---
+    auto runStart = std::chrono::steady_clock::now();
+    Simulator::Stop(Seconds(simTime));
+    Simulator::Run();
+    double runWall = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    // --- 6. REPORT ---
+    uint32_t nodes = cfg.nClients + 2;
+    std::cout << "Dumbbell: " << cfg.nClients << " clients, " << (cfg.lightweight ? "lightweight" : "full")
+              << " setup, " << traffic << " traffic, flowmon " << flowmon << "\n"
+              << "Setup wall time:  " << setupWall << " s\n"
+              << "Run wall time:    " << runWall << " s (" << Simulator::GetEventCount() << " events)\n"
+              << "Server goodput:   " << g_rxBytes * 8.0 / (simTime - appStart) / 1e6 << " Mbps\n";
+    if (traffic == "incast")
+    {
+        std::cout << "Incast complete:  ";
+        if (g_incastDone.IsZero())
+        {
+            std::cout << "no (" << g_rxBytes << " of " << g_incastTarget << " bytes)\n";
+        }
+        else
+        {
+            std::cout << (g_incastDone.GetSeconds() - appStart) * 1e3 << " ms\n";
+        }
+    }
+    if (monitor)
+    {
+        monitor->CheckForLostPackets();
+        uint64_t lost = 0;
+        for (auto const &flow : monitor->GetFlowStats())
+        {
+            lost += flow.second.lostPackets;
+        }
+        std::cout << "Flows monitored:  " << monitor->GetFlowStats().size() << " (" << lost
+                  << " packets lost)\n";
+    }
+    if (flowmon == "light")
+    {
+        uint64_t lost = 0;
+        for (uint32_t f = 0; f < light.GetNFlows(); f++)
+        {
+            lost += light.GetLost(f);
+        }
+        std::cout << "Flows monitored:  " << light.GetNFlows() << " (" << lost
+                  << " packets dropped, " << light.GetMemoryBytes() << " bytes of flow state)\n";
+    }
+
+    std::cout << "\nHeap kept per setup phase (" << nodes << " nodes):\n";
+    memory.Print(std::cout, nodes);
+
+    Simulator::Destroy();
+    return 0;
+}
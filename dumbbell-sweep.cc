@@ -0,0 +1,274 @@
+/*
+ * Parameter sweep over the shared dumbbell.
+ *
+ * Every combination of bottleneck rate, bottleneck delay, qdisc size and
+ * flow count is one grid point. Each grid point runs as its own process
+ * (see parallel-runner.h) so a 64-core box runs 64 points at a time, and
+ * the per-point rows are merged into one CSV in grid order.
+ *
+ * With --autoStop, each point stops as soon as its goodput and bottleneck
+ * queue length are steady (steady-state.h, MSER-5) rather than at
+ * --simTime, which becomes an upper bound, and reports the warm-up-free
+ * goodput. sim_s and warmup_s record where each point stopped and how much
+ * of the start was discarded.
+ *
+ * Example:
+ *   ./ns3 run "dumbbell-sweep --rates=5Mbps,10Mbps --delays=10ms,50ms
+ *              --queues=5p,20p,100p --flows=2,8,32 --simTime=10"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include "dumbbell-helper.h"
+#include "parallel-runner.h"
+#include "steady-state.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("DumbbellSweep");
+
+struct SweepPoint
+{
+    std::string rate;
+    std::string delay;
+    std::string queue;
+    uint32_t flows;
+};
+
+static const char *kSweepHeader =
+    "rate,delay,queue,flows,goodput_mbps,utilisation,lost_packets,"
+    "mean_delay_ms,queue_drops,wall_s,sim_s,warmup_s";
+
+/*
+ * Builds and runs one grid point in the current process and returns its
+ * CSV row (without trailing newline).
+ */
+static std::string
+RunSweepPoint(const SweepPoint &pt, const std::string &transport,
+              const std::string &accessRate, double simTime, uint32_t run,
+              bool autoStop, double ssTolerance)
+{
+    auto wallStart = std::chrono::steady_clock::now();
+
+    RngSeedManager::SetRun(run);
+
+    DumbbellConfig cfg;
+    cfg.nClients = pt.flows;
+    cfg.accessRate = accessRate;
+    cfg.bottleneckRate = pt.rate;
+    cfg.bottleneckDelay = pt.delay;
+    Dumbbell d = BuildDumbbell(cfg);
+
+    /* ---------- TRAFFIC CONTROL ---------- */
+    TrafficControlHelper tch;
+    tch.Uninstall(d.BottleneckDevice());
+    tch.SetRootQueueDisc("ns3::PfifoFastQueueDisc",
+                         "MaxSize", QueueSizeValue(QueueSize(pt.queue)));
+    QueueDiscContainer qdiscs = tch.Install(d.BottleneckDevice());
+
+    /* ---------- APPLICATIONS ---------- */
+    bool tcp = (transport == "tcp");
+    std::string factory = tcp ? "ns3::TcpSocketFactory" : "ns3::UdpSocketFactory";
+    double appStart = 1.0;
+
+    ApplicationContainer sinks;
+    for (uint32_t i = 0; i < pt.flows; i++)
+    {
+        uint16_t port = 5000 + i;
+        PacketSinkHelper sink(factory, InetSocketAddress(Ipv4Address::GetAny(), port));
+        sinks.Add(sink.Install(d.server.Get(0)));
+
+        ApplicationContainer app;
+        if (tcp)
+        {
+            BulkSendHelper bulk(factory, InetSocketAddress(d.ServerAddress(), port));
+            bulk.SetAttribute("MaxBytes", UintegerValue(0));
+            app = bulk.Install(d.clients.Get(i));
+        }
+        else
+        {
+            OnOffHelper onoff(factory, Address(InetSocketAddress(d.ServerAddress(), port)));
+            onoff.SetAttribute("DataRate", StringValue(accessRate));
+            onoff.SetAttribute("PacketSize", UintegerValue(1472));
+            onoff.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
+            onoff.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0]"));
+            app = onoff.Install(d.clients.Get(i));
+        }
+        app.Start(Seconds(appStart));
+        app.Stop(Seconds(simTime));
+    }
+    sinks.Start(Seconds(0.0));
+    sinks.Stop(Seconds(simTime));
+
+    FlowMonitorHelper flowmon;
+    Ptr<FlowMonitor> monitor = flowmon.InstallAll();
+
+    /* ---------- STEADY STATE ---------- */
+    Time ssInterval = MilliSeconds(100);
+    SteadyStateMonitor steady(ssInterval, ssTolerance);
+    if (autoStop)
+    {
+        auto sinkBytes = [&sinks]() {
+            uint64_t rx = 0;
+            for (uint32_t i = 0; i < sinks.GetN(); i++)
+            {
+                rx += DynamicCast<PacketSink>(sinks.Get(i))->GetTotalRx();
+            }
+            return rx;
+        };
+        steady.AddMetric("goodput (Mbps)", WindowedRateMbps(sinkBytes, ssInterval));
+        Ptr<QueueDisc> qdisc = qdiscs.Get(0);
+        steady.AddMetric("queue (packets)", [qdisc]() { return double(qdisc->GetNPackets()); });
+        steady.SetAutoStop(true);
+        steady.Start(Seconds(appStart));
+    }
+
+    Simulator::Stop(Seconds(simTime));
+    Simulator::Run();
+    double stopTime = Simulator::Now().GetSeconds();
+
+    /* ---------- RESULTS ---------- */
+    monitor->CheckForLostPackets();
+
+    uint64_t rxBytes = 0;
+    for (uint32_t i = 0; i < sinks.GetN(); i++)
+    {
+        rxBytes += DynamicCast<PacketSink>(sinks.Get(i))->GetTotalRx();
+    }
+
+    uint64_t lost = 0;
+    uint64_t rxPackets = 0;
+    double delaySum = 0;
+    for (auto const &flow : monitor->GetFlowStats())
+    {
+        lost += flow.second.lostPackets;
+        rxPackets += flow.second.rxPackets;
+        delaySum += flow.second.delaySum.GetSeconds();
+    }
+
+    double active = stopTime - appStart;
+    double goodputMbps = autoStop ? steady.GetMean(0) : rxBytes * 8.0 / active / 1e6;
+    double warmup = autoStop ? steady.GetWarmupEnd().GetSeconds() - appStart : 0.0;
+    double capacityMbps = DataRate(pt.rate).GetBitRate() / 1e6;
+    uint64_t queueDrops = qdiscs.Get(0)->GetStats().nTotalDroppedPackets;
+
+    Simulator::Destroy();
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    std::ostringstream row;
+    row << pt.rate << "," << pt.delay << "," << pt.queue << "," << pt.flows << ","
+        << goodputMbps << "," << goodputMbps / capacityMbps << "," << lost << ","
+        << (rxPackets > 0 ? delaySum / rxPackets * 1e3 : 0.0) << "," << queueDrops << ","
+        << wall << "," << stopTime << "," << warmup;
+    return row.str();
+}
+
+int main(int argc, char *argv[])
+{
+    // --- 1. CONFIGURATION ---
+    std::string rates = "5Mbps";
+    std::string delays = "10ms";
+    std::string queues = "5p";
+    std::string flows = "2";
+    std::string transport = "tcp";
+    std::string accessRate = "10Mbps";
+    std::string output = "dumbbell-sweep.csv";
+    double simTime = 10.0;
+    uint32_t run = 1;
+    uint32_t jobs = DefaultParallelJobs();
+    bool autoStop = false;
+    double ssTolerance = 0.05;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("rates", "Comma-separated bottleneck rates (e.g. 5Mbps,10Mbps)", rates);
+    cmd.AddValue("delays", "Comma-separated bottleneck delays (e.g. 10ms,50ms)", delays);
+    cmd.AddValue("queues", "Comma-separated bottleneck qdisc sizes (e.g. 5p,20p)", queues);
+    cmd.AddValue("flows", "Comma-separated flow counts (one client per flow)", flows);
+    cmd.AddValue("transport", "tcp (BulkSend) or udp (OnOff at the access rate)", transport);
+    cmd.AddValue("accessRate", "Access link rate", accessRate);
+    cmd.AddValue("simTime", "Simulated seconds per grid point", simTime);
+    cmd.AddValue("run", "RngRun used for every grid point", run);
+    cmd.AddValue("jobs", "Number of grid points run concurrently", jobs);
+    cmd.AddValue("output", "Merged CSV file", output);
+    cmd.AddValue("autoStop", "Stop each point at steady state; simTime is the upper bound", autoStop);
+    cmd.AddValue("ssTolerance", "Steady when every CI half-width <= tolerance * |mean|", ssTolerance);
+    cmd.Parse(argc, argv);
+
+    // --- 2. GRID ---
+    std::vector<SweepPoint> grid;
+    for (auto const &r : SplitList(rates))
+    {
+        for (auto const &dl : SplitList(delays))
+        {
+            for (auto const &q : SplitList(queues))
+            {
+                for (auto const &f : SplitList(flows))
+                {
+                    grid.push_back({r, dl, q, static_cast<uint32_t>(std::stoul(f))});
+                }
+            }
+        }
+    }
+
+    std::cout << "Running " << grid.size() << " grid points on " << jobs
+              << " processes" << std::endl;
+
+    // --- 3. RUN ---
+    uint32_t finished = 0;
+    std::vector<ParallelJobResult> results = RunParallel(
+        grid.size(), jobs,
+        [&](uint32_t i) {
+            return RunSweepPoint(grid[i], transport, accessRate, simTime, run, autoStop, ssTolerance);
+        },
+        [&](const ParallelJobResult &r) {
+            finished++;
+            std::cout << "[" << finished << "/" << grid.size() << "] "
+                      << (r.ok ? r.output : "FAILED") << std::endl;
+            return true;
+        });
+
+    // --- 4. MERGE ---
+    std::vector<std::string> rows(grid.size());
+    uint32_t failed = 0;
+    for (auto const &r : results)
+    {
+        if (r.ok)
+        {
+            rows[r.index] = r.output;
+        }
+        else
+        {
+            failed++;
+        }
+    }
+
+    std::ofstream csv(output);
+    csv << kSweepHeader << "\n";
+    for (auto const &row : rows)
+    {
+        if (!row.empty())
+        {
+            csv << row << "\n";
+        }
+    }
+
+    std::cout << "Wrote " << (grid.size() - failed) << " rows to " << output;
+    if (failed > 0)
+    {
+        std::cout << " (" << failed << " grid points failed)";
+    }
+    std::cout << std::endl;
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,410 @@
+/*
+ * Edge-only flow statistics, a lightweight stand-in for FlowMonitor.
+ *
+ * FlowMonitorHelper::InstallAll() puts an Ipv4FlowProbe on every node, so
+ * every packet is classified (a std::map lookup on the 5-tuple) and tagged
+ * at every hop, and every flow carries the full FlowStats record with its
+ * histograms. EdgeFlowMonitor hooks the per-packet points at the edges
+ * only:
+ *   - IPv4 "SendOutgoing" on the sender nodes (locally originated packets)
+ *   - IPv4 "LocalDeliver" on the receiver nodes
+ * plus, with InstallDropPoints(), the drop traces of any node (IPv4 "Drop"
+ * and the root queue discs' "Drop"), which cost nothing until a packet is
+ * actually dropped. Packets are classified on a flat open-addressing hash
+ * table keyed by the 5-tuple. Each flow keeps just the counters asked for,
+ * packed into one dense array (EDGE_TX_PACKETS | EDGE_RX_BYTES = two words
+ * per flow). Delay needs a send time, which rides in an 8-byte packet tag
+ * added only when EDGE_DELAY is requested.
+ *
+ * Differences from FlowMonitor: only flows leaving a sender node are seen
+ * (with sinks as receivers, the ACK direction of TCP is not), and lost
+ * packets are the drops seen at the drop points; drops in a device queue
+ * below a queue disc are not (a queue disc normally keeps that queue from
+ * overflowing), and neither are packets that vanish without a drop trace.
+ */
+
+#ifndef EDGE_FLOW_MONITOR_H
+#define EDGE_FLOW_MONITOR_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+enum EdgeFlowCounter : uint32_t
+{
+    EDGE_TX_PACKETS = 1 << 0,
+    EDGE_TX_BYTES = 1 << 1,
+    EDGE_RX_PACKETS = 1 << 2,
+    EDGE_RX_BYTES = 1 << 3,
+    EDGE_DELAY = 1 << 4,    // sum of one-way delays (ns)
+    EDGE_FIRST_TX = 1 << 5, // time of the first sent packet (ns, 0 = none)
+    EDGE_LAST_RX = 1 << 6,  // time of the last received packet (ns)
+    EDGE_DROPS = 1 << 7,    // packets dropped at the drop points
+    EDGE_ALL = (1 << 8) - 1,
+};
+
+static const uint32_t kEdgeFlowCounters = 8;
+
+static const char *kEdgeFlowCounterNames[] = {"txPackets", "txBytes", "rxPackets", "rxBytes",
+                                              "delay",     "firstTx", "lastRx",    "drops"};
+
+// "txPackets,rxBytes,delay" (or "all") to a counter mask
+inline uint32_t
+ParseEdgeFlowCounters(const std::string &list)
+{
+    uint32_t mask = 0;
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        std::string name = list.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (name == "all")
+        {
+            mask |= EDGE_ALL;
+        }
+        else if (!name.empty())
+        {
+            uint32_t bit = 0;
+            while (bit < kEdgeFlowCounters && name != kEdgeFlowCounterNames[bit])
+            {
+                bit++;
+            }
+            NS_ABORT_MSG_IF(bit == kEdgeFlowCounters, "Unknown flow counter " << name);
+            mask |= 1u << bit;
+        }
+        if (end == std::string::npos)
+        {
+            break;
+        }
+        start = end + 1;
+    }
+    return mask;
+}
+
+/* ---------- SEND TIME TAG ---------- */
+
+namespace ns3
+{
+
+class EdgeFlowTimeTag : public Tag
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::EdgeFlowTimeTag").SetParent<Tag>().AddConstructor<EdgeFlowTimeTag>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override { return GetTypeId(); }
+
+    uint32_t GetSerializedSize() const override { return 8; }
+
+    void Serialize(TagBuffer i) const override { i.WriteU64(m_sentNs); }
+
+    void Deserialize(TagBuffer i) override { m_sentNs = i.ReadU64(); }
+
+    void Print(std::ostream &os) const override { os << "sent=" << m_sentNs << "ns"; }
+
+    uint64_t m_sentNs = 0;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(EdgeFlowTimeTag);
+
+} // namespace ns3
+
+/* ---------- MONITOR ---------- */
+
+struct EdgeFlowKey
+{
+    uint32_t src;
+    uint32_t dst;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint8_t protocol;
+
+    bool operator==(const EdgeFlowKey &o) const
+    {
+        return src == o.src && dst == o.dst && srcPort == o.srcPort && dstPort == o.dstPort &&
+               protocol == o.protocol;
+    }
+};
+
+class EdgeFlowMonitor
+{
+  public:
+    explicit EdgeFlowMonitor(uint32_t counters = EDGE_TX_PACKETS | EDGE_RX_PACKETS | EDGE_RX_BYTES | EDGE_DELAY |
+                                                 EDGE_DROPS)
+        : m_counters(counters)
+    {
+        for (uint32_t bit = 0; bit < kEdgeFlowCounters; bit++)
+        {
+            m_slot[bit] = (counters & (1u << bit)) ? m_stride++ : -1;
+        }
+        m_slots.assign(1024, 0);
+    }
+
+    void InstallSender(ns3::Ptr<ns3::Node> node)
+    {
+        Ipv4Of(node)->TraceConnectWithoutContext("SendOutgoing", ns3::MakeCallback(&EdgeFlowMonitor::Sent, this));
+    }
+
+    void InstallReceiver(ns3::Ptr<ns3::Node> node)
+    {
+        Ipv4Of(node)->TraceConnectWithoutContext("LocalDeliver",
+                                                 ns3::MakeCallback(&EdgeFlowMonitor::Delivered, this));
+    }
+
+    // IPv4 drops of the node and drops of every root queue disc on it (call
+    // once the queue discs are installed)
+    void InstallDropPoints(ns3::Ptr<ns3::Node> node)
+    {
+        using namespace ns3;
+
+        Ipv4Of(node)->TraceConnectWithoutContext("Drop", MakeCallback(&EdgeFlowMonitor::Ipv4Dropped, this));
+        Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer>();
+        for (uint32_t i = 0; tc && i < node->GetNDevices(); i++)
+        {
+            Ptr<QueueDisc> qdisc = tc->GetRootQueueDiscOnDevice(node->GetDevice(i));
+            if (qdisc)
+            {
+                qdisc->TraceConnectWithoutContext("Drop", MakeCallback(&EdgeFlowMonitor::QueueDropped, this));
+            }
+        }
+    }
+
+    void InstallDropPoints(const ns3::NodeContainer &nodes)
+    {
+        for (uint32_t i = 0; i < nodes.GetN(); i++)
+        {
+            InstallDropPoints(nodes.Get(i));
+        }
+    }
+
+    void InstallSenders(const ns3::NodeContainer &nodes)
+    {
+        for (uint32_t i = 0; i < nodes.GetN(); i++)
+        {
+            InstallSender(nodes.Get(i));
+        }
+    }
+
+    void InstallReceivers(const ns3::NodeContainer &nodes)
+    {
+        for (uint32_t i = 0; i < nodes.GetN(); i++)
+        {
+            InstallReceiver(nodes.Get(i));
+        }
+    }
+
+    uint32_t GetCounters() const { return m_counters; }
+
+    uint32_t GetNFlows() const { return m_keys.size(); }
+
+    const EdgeFlowKey &GetKey(uint32_t flow) const { return m_keys[flow]; }
+
+    uint64_t Get(uint32_t flow, EdgeFlowCounter counter) const
+    {
+        int32_t slot = m_slot[Bit(counter)];
+        NS_ABORT_MSG_IF(slot < 0, "Flow counter " << kEdgeFlowCounterNames[Bit(counter)] << " was not requested");
+        return m_values[flow * m_stride + slot];
+    }
+
+    // Packets dropped at the drop points (needs EDGE_DROPS)
+    uint64_t GetLost(uint32_t flow) const
+    {
+        return Get(flow, EDGE_DROPS);
+    }
+
+    ns3::Time GetMeanDelay(uint32_t flow) const
+    {
+        uint64_t rx = Get(flow, EDGE_RX_PACKETS);
+        return rx ? ns3::NanoSeconds(int64_t(Get(flow, EDGE_DELAY) / rx)) : ns3::Time(0);
+    }
+
+    // Bytes of flow state: keys, counters and the hash table
+    size_t GetMemoryBytes() const
+    {
+        return m_keys.capacity() * sizeof(EdgeFlowKey) + m_values.capacity() * sizeof(uint64_t) +
+               m_slots.capacity() * sizeof(uint32_t);
+    }
+
+    void Print(std::ostream &os) const
+    {
+        os << std::left << std::setw(36) << "flow" << std::right;
+        for (uint32_t bit = 0; bit < kEdgeFlowCounters; bit++)
+        {
+            if (m_slot[bit] >= 0)
+            {
+                os << std::setw(14) << kEdgeFlowCounterNames[bit];
+            }
+        }
+        os << "\n";
+        for (uint32_t f = 0; f < m_keys.size(); f++)
+        {
+            const EdgeFlowKey &k = m_keys[f];
+            std::ostringstream name;
+            name << ns3::Ipv4Address(k.src) << ":" << k.srcPort << " -> " << ns3::Ipv4Address(k.dst) << ":"
+                 << k.dstPort << "/" << unsigned(k.protocol);
+            os << std::left << std::setw(36) << name.str() << std::right;
+            for (uint32_t bit = 0; bit < kEdgeFlowCounters; bit++)
+            {
+                if (m_slot[bit] >= 0)
+                {
+                    os << std::setw(14) << m_values[f * m_stride + m_slot[bit]];
+                }
+            }
+            os << "\n";
+        }
+    }
+
+  private:
+    static uint32_t Bit(EdgeFlowCounter counter) { return __builtin_ctz(counter); }
+
+    static ns3::Ptr<ns3::Ipv4L3Protocol> Ipv4Of(ns3::Ptr<ns3::Node> node)
+    {
+        ns3::Ptr<ns3::Ipv4L3Protocol> ipv4 = node->GetObject<ns3::Ipv4L3Protocol>();
+        NS_ABORT_MSG_IF(!ipv4, "EdgeFlowMonitor needs an IPv4 stack on node " << node->GetId());
+        return ipv4;
+    }
+
+    // The IP header is already stripped (LocalDeliver, Drop) or not yet
+    // added (SendOutgoing) or kept apart (Ipv4QueueDiscItem): TCP and UDP
+    // start with the ports
+    static EdgeFlowKey KeyOf(const ns3::Ipv4Header &ip, ns3::Ptr<const ns3::Packet> packet)
+    {
+        EdgeFlowKey key{ip.GetSource().Get(), ip.GetDestination().Get(), 0, 0, ip.GetProtocol()};
+        uint8_t ports[4];
+        if ((key.protocol == 6 || key.protocol == 17) && packet->CopyData(ports, 4) == 4)
+        {
+            key.srcPort = (ports[0] << 8) | ports[1];
+            key.dstPort = (ports[2] << 8) | ports[3];
+        }
+        return key;
+    }
+
+    static uint64_t Hash(const EdgeFlowKey &k)
+    {
+        uint64_t h = (uint64_t(k.src) << 32 | k.dst) * 0x9e3779b97f4a7c15ULL;
+        h ^= (uint64_t(k.srcPort) << 24 | uint64_t(k.dstPort) << 8 | k.protocol) * 0xff51afd7ed558ccdULL;
+        return h ^ (h >> 29);
+    }
+
+    // Counters of the key's flow, created on first sight
+    uint64_t *Find(const EdgeFlowKey &key)
+    {
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = Hash(key) & mask;; i = (i + 1) & mask)
+        {
+            uint32_t s = m_slots[i];
+            if (s == 0)
+            {
+                m_keys.push_back(key);
+                m_values.resize(m_values.size() + m_stride, 0);
+                m_slots[i] = m_keys.size();
+                if (2 * m_keys.size() > m_slots.size())
+                {
+                    Grow();
+                }
+                return &m_values[(m_keys.size() - 1) * m_stride];
+            }
+            if (m_keys[s - 1] == key)
+            {
+                return &m_values[(s - 1) * m_stride];
+            }
+        }
+    }
+
+    void Grow()
+    {
+        m_slots.assign(2 * m_slots.size(), 0);
+        size_t mask = m_slots.size() - 1;
+        for (uint32_t f = 0; f < m_keys.size(); f++)
+        {
+            size_t i = Hash(m_keys[f]) & mask;
+            while (m_slots[i] != 0)
+            {
+                i = (i + 1) & mask;
+            }
+            m_slots[i] = f + 1;
+        }
+    }
+
+    void Add(uint64_t *values, uint32_t bit, uint64_t amount)
+    {
+        if (m_slot[bit] >= 0)
+        {
+            values[m_slot[bit]] += amount;
+        }
+    }
+
+    void Sent(const ns3::Ipv4Header &ip, ns3::Ptr<const ns3::Packet> packet, uint32_t)
+    {
+        uint64_t *v = Find(KeyOf(ip, packet));
+        uint64_t now = ns3::Simulator::Now().GetNanoSeconds();
+        Add(v, 0, 1);
+        Add(v, 1, packet->GetSize() + ip.GetSerializedSize());
+        if (m_slot[5] >= 0 && v[m_slot[5]] == 0)
+        {
+            v[m_slot[5]] = now;
+        }
+        if (m_slot[4] >= 0)
+        {
+            // Replace: an echoed packet comes back with the first send's tag
+            ns3::EdgeFlowTimeTag tag;
+            tag.m_sentNs = now;
+            ns3::ConstCast<ns3::Packet>(packet)->ReplacePacketTag(tag);
+        }
+    }
+
+    void Delivered(const ns3::Ipv4Header &ip, ns3::Ptr<const ns3::Packet> packet, uint32_t)
+    {
+        uint64_t *v = Find(KeyOf(ip, packet));
+        uint64_t now = ns3::Simulator::Now().GetNanoSeconds();
+        Add(v, 2, 1);
+        Add(v, 3, packet->GetSize() + ip.GetSerializedSize());
+        if (m_slot[4] >= 0)
+        {
+            ns3::EdgeFlowTimeTag tag;
+            if (packet->PeekPacketTag(tag))
+            {
+                v[m_slot[4]] += now - tag.m_sentNs;
+            }
+        }
+        if (m_slot[6] >= 0)
+        {
+            v[m_slot[6]] = now;
+        }
+    }
+
+    void Ipv4Dropped(const ns3::Ipv4Header &ip, ns3::Ptr<const ns3::Packet> packet,
+                     ns3::Ipv4L3Protocol::DropReason, ns3::Ptr<ns3::Ipv4>, uint32_t)
+    {
+        Add(Find(KeyOf(ip, packet)), 7, 1);
+    }
+
+    void QueueDropped(ns3::Ptr<const ns3::QueueDiscItem> item)
+    {
+        ns3::Ptr<const ns3::Ipv4QueueDiscItem> ipItem = ns3::DynamicCast<const ns3::Ipv4QueueDiscItem>(item);
+        if (ipItem)
+        {
+            Add(Find(KeyOf(ipItem->GetHeader(), ipItem->GetPacket())), 7, 1);
+        }
+    }
+
+    uint32_t m_counters;
+    int32_t m_slot[kEdgeFlowCounters];
+    uint32_t m_stride = 0;
+    std::vector<EdgeFlowKey> m_keys;
+    std::vector<uint64_t> m_values; // m_stride words per flow
+    std::vector<uint32_t> m_slots;  // open addressing: flow index + 1, 0 = empty
+};
+
+#endif /* EDGE_FLOW_MONITOR_H */
@@ -0,0 +1,258 @@
+/*
+ * Periodic per-flow FlowMonitor statistics.
+ *
+ * Reading FlowMonitor::GetFlowStats() once after Simulator::Run() hides
+ * convergence and starvation dynamics. FlowWindowSampler reads the
+ * cumulative counters every interval and turns the difference with the
+ * previous read into one window per flow: throughput, loss and mean delay
+ * over exactly that interval.
+ *
+ * Each flow keeps only its last ringSize windows, so memory depends on the
+ * number of flows, not on the run length. Windows can also be streamed to
+ * a CSV file as they are produced and handed to listeners (e.g. a
+ * steady-state detector) without being stored anywhere else.
+ *
+ * The counters come from a FlowMonitor or from an EdgeFlowMonitor
+ * (edge-flow-monitor.h; needs its rx packets/bytes, delay and drops
+ * counters). CollectFlowTotals() reads either into the same per-flow
+ * totals, so a script can report from whichever monitor it was given.
+ *
+ * Window loss counts the drops reported in the window (FlowMonitor's
+ * packetsDropped). FlowMonitor's lostPackets counts those drops too, but
+ * also packets that vanished without a drop report, and those only once
+ * MaxPerHopDelay (10 s) has passed, so its deltas would book them in a
+ * window long after the loss.
+ */
+
+#ifndef FLOW_WINDOW_SAMPLER_H
+#define FLOW_WINDOW_SAMPLER_H
+
+#include "edge-flow-monitor.h"
+
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Cumulative counters of one flow
+struct FlowTotals
+{
+    ns3::FlowId id;
+    ns3::Ipv4Address src;
+    ns3::Ipv4Address dst;
+    uint8_t protocol;
+    uint64_t rxBytes;
+    uint64_t rxPackets;
+    uint64_t lostPackets;    // FlowMonitor: dropped, or unseen for MaxPerHopDelay; edge: drops
+    uint64_t droppedPackets; // reported dropped where it happened
+    int64_t delaySumNs;
+    int64_t firstTxNs; // 0 if unknown
+};
+
+inline std::vector<FlowTotals>
+CollectFlowTotals(ns3::Ptr<ns3::FlowMonitor> monitor, ns3::Ptr<ns3::Ipv4FlowClassifier> classifier)
+{
+    using namespace ns3;
+
+    std::vector<FlowTotals> flows;
+    monitor->CheckForLostPackets();
+    for (auto const &flow : monitor->GetFlowStats())
+    {
+        const FlowMonitor::FlowStats &st = flow.second;
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+        uint64_t dropped = 0;
+        for (uint32_t n : st.packetsDropped)
+        {
+            dropped += n;
+        }
+        flows.push_back({flow.first, t.sourceAddress, t.destinationAddress, t.protocol, st.rxBytes,
+                         st.rxPackets, st.lostPackets, dropped, st.delaySum.GetNanoSeconds(),
+                         st.timeFirstTxPacket.GetNanoSeconds()});
+    }
+    return flows;
+}
+
+// Flow ids are the edge monitor's flow indices + 1
+inline std::vector<FlowTotals>
+CollectFlowTotals(const EdgeFlowMonitor &edge)
+{
+    using namespace ns3;
+
+    std::vector<FlowTotals> flows;
+    bool firstTx = edge.GetCounters() & EDGE_FIRST_TX;
+    for (uint32_t f = 0; f < edge.GetNFlows(); f++)
+    {
+        const EdgeFlowKey &k = edge.GetKey(f);
+        flows.push_back({f + 1, Ipv4Address(k.src), Ipv4Address(k.dst), k.protocol, edge.Get(f, EDGE_RX_BYTES),
+                         edge.Get(f, EDGE_RX_PACKETS), edge.GetLost(f), edge.GetLost(f),
+                         int64_t(edge.Get(f, EDGE_DELAY)),
+                         firstTx ? int64_t(edge.Get(f, EDGE_FIRST_TX)) : 0});
+    }
+    return flows;
+}
+
+struct FlowWindow
+{
+    double start = 0;          // s
+    double throughputMbps = 0; // received bytes over the window
+    double lossRate = 0;       // lost / (received + lost), 0 when idle
+    double meanDelayMs = 0;    // 0 when nothing was received
+    uint64_t rxPackets = 0;
+    uint64_t lostPackets = 0;
+};
+
+class FlowWindowSampler
+{
+  public:
+    typedef std::function<void(ns3::FlowId, const FlowWindow &)> WindowCallback;
+
+    FlowWindowSampler(ns3::Ptr<ns3::FlowMonitor> monitor,
+                      ns3::Ptr<ns3::Ipv4FlowClassifier> classifier,
+                      ns3::Time interval,
+                      uint32_t ringSize = 64)
+        : m_monitor(monitor),
+          m_classifier(classifier),
+          m_interval(interval),
+          m_ringSize(ringSize)
+    {
+    }
+
+    FlowWindowSampler(const EdgeFlowMonitor *edge, ns3::Time interval, uint32_t ringSize = 64)
+        : m_edge(edge),
+          m_interval(interval),
+          m_ringSize(ringSize)
+    {
+        uint32_t needed = EDGE_RX_PACKETS | EDGE_RX_BYTES | EDGE_DELAY | EDGE_DROPS;
+        NS_ABORT_MSG_IF((edge->GetCounters() & needed) != needed,
+                        "FlowWindowSampler needs the rxPackets, rxBytes, delay and drops counters");
+    }
+
+    // Streams every window to fileName as CSV.
+    void SetOutput(const std::string &fileName)
+    {
+        m_out.open(fileName);
+        m_out << "time_s,flow,src,dst,protocol,throughput_mbps,loss_rate,mean_delay_ms,"
+                 "rx_packets,lost_packets\n";
+    }
+
+    void AddListener(WindowCallback cb)
+    {
+        m_listeners.push_back(cb);
+    }
+
+    // First window starts at start (absolute, called before Simulator::Run).
+    void Start(ns3::Time start)
+    {
+        m_windowStart = start;
+        ns3::Simulator::Schedule(start + m_interval, &FlowWindowSampler::Sample, this);
+    }
+
+    // Last windows of a flow, oldest first.
+    std::vector<FlowWindow> GetWindows(ns3::FlowId id) const
+    {
+        std::vector<FlowWindow> out;
+        auto it = m_flows.find(id);
+        if (it == m_flows.end())
+        {
+            return out;
+        }
+        const FlowRing &r = it->second;
+        for (uint32_t i = 0; i < r.count; i++)
+        {
+            out.push_back(r.ring[(r.head + m_ringSize - r.count + i) % m_ringSize]);
+        }
+        return out;
+    }
+
+    ns3::Time GetInterval() const
+    {
+        return m_interval;
+    }
+
+  private:
+    struct FlowRing
+    {
+        // Cumulative counters at the previous sample
+        uint64_t rxBytes = 0;
+        uint64_t rxPackets = 0;
+        uint64_t droppedPackets = 0;
+        int64_t delaySumNs = 0;
+
+        std::vector<FlowWindow> ring;
+        uint32_t head = 0;  // next slot to write
+        uint32_t count = 0;
+    };
+
+    void Sample()
+    {
+        using namespace ns3;
+
+        double width = m_interval.GetSeconds();
+
+        for (const FlowTotals &st : m_edge ? CollectFlowTotals(*m_edge) : CollectFlowTotals(m_monitor, m_classifier))
+        {
+            FlowRing &r = m_flows[st.id];
+            if (r.ring.empty())
+            {
+                r.ring.resize(m_ringSize);
+            }
+
+            FlowWindow w;
+            w.start = m_windowStart.GetSeconds();
+            w.rxPackets = st.rxPackets - r.rxPackets;
+            w.lostPackets = st.droppedPackets - r.droppedPackets;
+            w.throughputMbps = (st.rxBytes - r.rxBytes) * 8.0 / width / 1e6;
+            if (w.rxPackets + w.lostPackets > 0)
+            {
+                w.lossRate = double(w.lostPackets) / (w.rxPackets + w.lostPackets);
+            }
+            if (w.rxPackets > 0)
+            {
+                w.meanDelayMs = (st.delaySumNs - r.delaySumNs) / 1e6 / w.rxPackets;
+            }
+
+            r.rxBytes = st.rxBytes;
+            r.rxPackets = st.rxPackets;
+            r.droppedPackets = st.droppedPackets;
+            r.delaySumNs = st.delaySumNs;
+
+            r.ring[r.head] = w;
+            r.head = (r.head + 1) % m_ringSize;
+            if (r.count < m_ringSize)
+            {
+                r.count++;
+            }
+
+            if (m_out.is_open())
+            {
+                m_out << w.start << "," << st.id << "," << st.src << "," << st.dst << ","
+                      << unsigned(st.protocol) << ","
+                      << w.throughputMbps << "," << w.lossRate << "," << w.meanDelayMs << ","
+                      << w.rxPackets << "," << w.lostPackets << "\n";
+            }
+            for (auto &cb : m_listeners)
+            {
+                cb(st.id, w);
+            }
+        }
+
+        m_windowStart = Simulator::Now();
+        Simulator::Schedule(m_interval, &FlowWindowSampler::Sample, this);
+    }
+
+    ns3::Ptr<ns3::FlowMonitor> m_monitor;
+    ns3::Ptr<ns3::Ipv4FlowClassifier> m_classifier;
+    const EdgeFlowMonitor *m_edge = nullptr;
+    ns3::Time m_interval;
+    uint32_t m_ringSize;
+    ns3::Time m_windowStart;
+    std::map<ns3::FlowId, FlowRing> m_flows;
+    std::ofstream m_out;
+    std::vector<WindowCallback> m_listeners;
+};
+
+#endif /* FLOW_WINDOW_SAMPLER_H */
@@ -0,0 +1,344 @@
+/*
+ * BCP38 / uRPF ingress filter that can sit on any ns-3 router.
+ *
+ * IngressFilter is an Ipv4RoutingProtocol added to the node's
+ * Ipv4ListRouting with a priority above static and global routing. For
+ * every packet to be forwarded, Ipv4ListRouting hands it the already
+ * parsed Ipv4Header by reference, so no packet copy or header
+ * deserialization happens here. If the source address is not inside a
+ * prefix allowed on the arrival interface the packet is dropped through the
+ * error callback, so Ipv4L3Protocol's "Drop" trace reports it
+ * (DROP_ROUTE_ERROR) to FlowMonitor and other drop accounting; otherwise
+ * RouteInput() returns false and the next protocol forwards it.
+ *
+ * Allowed prefixes per interface are precomputed into one binary trie whose
+ * nodes carry a bitmap of the interfaces on which that prefix is allowed,
+ * so a lookup is at most 32 steps with no per-packet mask arithmetic.
+ * Prefixes come from:
+ *   - the interface's own connected subnet (always),
+ *   - AddAllowedPrefix() (customer prefixes behind the interface),
+ *   - LoadFromRoutingTable(): strict uRPF, i.e. a source is allowed on the
+ *     interfaces the node's global routes would use to reach it.
+ *
+ * Limitation: Ipv4ListRouting delivers packets addressed to the router
+ * itself before consulting any routing protocol, so only transit traffic
+ * is filtered - which is what BCP38 is about.
+ */
+
+#ifndef INGRESS_FILTER_H
+#define INGRESS_FILTER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <iomanip>
+#include <vector>
+
+/* ---------- PREFIX TRIE ---------- */
+
+class PrefixTrie
+{
+  public:
+    PrefixTrie()
+    {
+        m_nodes.push_back(Node());
+    }
+
+    // Allows prefix/len on interface ifIndex (< 64).
+    void Insert(uint32_t prefix, uint8_t len, uint32_t ifIndex)
+    {
+        uint32_t n = 0;
+        for (uint8_t bit = 0; bit < len; bit++)
+        {
+            uint32_t b = (prefix >> (31 - bit)) & 1;
+            if (m_nodes[n].child[b] == 0)
+            {
+                m_nodes[n].child[b] = m_nodes.size();
+                m_nodes.push_back(Node());
+            }
+            n = m_nodes[n].child[b];
+        }
+        m_nodes[n].ifMask |= (uint64_t(1) << ifIndex);
+    }
+
+    // Bitmap of interfaces on which addr is covered by an allowed prefix.
+    uint64_t Lookup(uint32_t addr) const
+    {
+        uint64_t mask = m_nodes[0].ifMask;
+        uint32_t n = 0;
+        for (uint8_t bit = 0; bit < 32; bit++)
+        {
+            n = m_nodes[n].child[(addr >> (31 - bit)) & 1];
+            if (n == 0)
+            {
+                break;
+            }
+            mask |= m_nodes[n].ifMask;
+        }
+        return mask;
+    }
+
+    size_t GetNNodes() const
+    {
+        return m_nodes.size();
+    }
+
+  private:
+    struct Node
+    {
+        uint32_t child[2] = {0, 0}; // 0 = none (the root is never a child)
+        uint64_t ifMask = 0;
+    };
+
+    std::vector<Node> m_nodes;
+};
+
+/* ---------- FILTER ---------- */
+
+namespace ns3
+{
+
+class IngressFilter : public Ipv4RoutingProtocol
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::IngressFilter")
+                .SetParent<Ipv4RoutingProtocol>()
+                .AddConstructor<IngressFilter>()
+                .AddAttribute("Enforce",
+                              "Drop spoofed packets (false = count and trace only)",
+                              BooleanValue(true),
+                              MakeBooleanAccessor(&IngressFilter::m_enforce),
+                              MakeBooleanChecker())
+                .AddTraceSource("Spoofed",
+                                "A packet failed the source check: (packet, header, interface)",
+                                MakeTraceSourceAccessor(&IngressFilter::m_spoofedTrace),
+                                "ns3::IngressFilter::SpoofedTracedCallback");
+        return tid;
+    }
+
+    typedef void (*SpoofedTracedCallback)(Ptr<const Packet>, const Ipv4Header &, uint32_t);
+
+    IngressFilter()
+        : m_enforce(true)
+    {
+    }
+
+    /* ---------- CONFIGURATION ---------- */
+
+    // Filters packets arriving on this interface (others pass unchecked).
+    void EnableInterface(uint32_t ifIndex)
+    {
+        NS_ABORT_MSG_IF(ifIndex >= 64, "IngressFilter supports interfaces 0..63");
+        Grow(ifIndex);
+        m_enabled[ifIndex] = true;
+        AddConnectedPrefixes(ifIndex);
+    }
+
+    void AddAllowedPrefix(uint32_t ifIndex, Ipv4Address prefix, Ipv4Mask mask)
+    {
+        NS_ABORT_MSG_IF(ifIndex >= 64, "IngressFilter supports interfaces 0..63");
+        Grow(ifIndex);
+        m_trie.Insert(prefix.CombineMask(mask).Get(), mask.GetPrefixLength(), ifIndex);
+    }
+
+    /*
+     * Strict uRPF: allows each destination of the node's global routing
+     * table on the interface that route leaves through. Call after
+     * Ipv4GlobalRoutingHelper::PopulateRoutingTables().
+     */
+    void LoadFromRoutingTable()
+    {
+        Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting>(m_ipv4->GetRoutingProtocol());
+        NS_ABORT_MSG_UNLESS(list, "IngressFilter needs Ipv4ListRouting");
+        for (uint32_t i = 0; i < list->GetNRoutingProtocols(); i++)
+        {
+            int16_t priority;
+            Ptr<Ipv4GlobalRouting> global =
+                DynamicCast<Ipv4GlobalRouting>(list->GetRoutingProtocol(i, priority));
+            if (!global)
+            {
+                continue;
+            }
+            for (uint32_t r = 0; r < global->GetNRoutes(); r++)
+            {
+                Ipv4RoutingTableEntry *route = global->GetRoute(r);
+                uint32_t ifIndex = route->GetInterface();
+                if (ifIndex >= 64)
+                {
+                    continue;
+                }
+                Grow(ifIndex);
+                if (route->IsHost())
+                {
+                    m_trie.Insert(route->GetDest().Get(), 32, ifIndex);
+                }
+                else
+                {
+                    Ipv4Mask mask = route->GetDestNetworkMask();
+                    m_trie.Insert(route->GetDestNetwork().CombineMask(mask).Get(),
+                                  mask.GetPrefixLength(), ifIndex);
+                }
+            }
+        }
+    }
+
+    /* ---------- COUNTERS ---------- */
+
+    uint64_t GetChecked(uint32_t ifIndex) const
+    {
+        return ifIndex < m_checked.size() ? m_checked[ifIndex] : 0;
+    }
+
+    uint64_t GetDropped(uint32_t ifIndex) const
+    {
+        return ifIndex < m_dropped.size() ? m_dropped[ifIndex] : 0;
+    }
+
+    void PrintCounters(std::ostream &os) const
+    {
+        os << "Ingress filter on node " << m_ipv4->GetObject<Node>()->GetId() << " ("
+           << (m_enforce ? "enforcing" : "detect only") << ", " << m_trie.GetNNodes()
+           << " trie nodes)\n";
+        for (uint32_t i = 0; i < m_enabled.size(); i++)
+        {
+            if (m_enabled[i])
+            {
+                os << "  interface " << i << ": checked " << m_checked[i] << ", spoofed "
+                   << m_dropped[i] << "\n";
+            }
+        }
+    }
+
+    /* ---------- Ipv4RoutingProtocol ---------- */
+
+    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
+                               const Ipv4Header &header,
+                               Ptr<NetDevice> oif,
+                               Socket::SocketErrno &sockerr) override
+    {
+        // Locally originated traffic is not ours to judge.
+        sockerr = Socket::ERROR_NOROUTETOHOST;
+        return nullptr;
+    }
+
+    bool RouteInput(Ptr<const Packet> p,
+                    const Ipv4Header &header,
+                    Ptr<const NetDevice> idev,
+                    const UnicastForwardCallback &ucb,
+                    const MulticastForwardCallback &mcb,
+                    const LocalDeliverCallback &lcb,
+                    const ErrorCallback &ecb) override
+    {
+        int32_t iif = m_ipv4->GetInterfaceForDevice(idev);
+        if (iif < 0 || static_cast<uint32_t>(iif) >= m_enabled.size() || !m_enabled[iif])
+        {
+            return false;
+        }
+
+        m_checked[iif]++;
+        if (m_trie.Lookup(header.GetSource().Get()) & (uint64_t(1) << iif))
+        {
+            return false;
+        }
+
+        m_dropped[iif]++;
+        m_spoofedTrace(p, header, iif);
+        if (!m_enforce)
+        {
+            return false;
+        }
+        // Fires Ipv4L3Protocol "Drop" with DROP_ROUTE_ERROR
+        ecb(p, header, Socket::ERROR_NOROUTETOHOST);
+        return true;
+    }
+
+    void NotifyInterfaceUp(uint32_t interface) override
+    {
+    }
+
+    void NotifyInterfaceDown(uint32_t interface) override
+    {
+    }
+
+    void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override
+    {
+        if (interface < m_enabled.size() && m_enabled[interface])
+        {
+            m_trie.Insert(address.GetLocal().CombineMask(address.GetMask()).Get(),
+                          address.GetMask().GetPrefixLength(), interface);
+        }
+    }
+
+    void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override
+    {
+        // Prefixes are precomputed; removing one would need a rebuild,
+        // which scenarios here never require.
+    }
+
+    void SetIpv4(Ptr<Ipv4> ipv4) override
+    {
+        m_ipv4 = ipv4;
+    }
+
+    void PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const override
+    {
+        PrintCounters(*stream->GetStream());
+    }
+
+  private:
+    void Grow(uint32_t ifIndex)
+    {
+        if (ifIndex >= m_enabled.size())
+        {
+            m_enabled.resize(ifIndex + 1, false);
+            m_checked.resize(ifIndex + 1, 0);
+            m_dropped.resize(ifIndex + 1, 0);
+        }
+    }
+
+    void AddConnectedPrefixes(uint32_t ifIndex)
+    {
+        for (uint32_t a = 0; a < m_ipv4->GetNAddresses(ifIndex); a++)
+        {
+            Ipv4InterfaceAddress addr = m_ipv4->GetAddress(ifIndex, a);
+            m_trie.Insert(addr.GetLocal().CombineMask(addr.GetMask()).Get(),
+                          addr.GetMask().GetPrefixLength(), ifIndex);
+        }
+    }
+
+    Ptr<Ipv4> m_ipv4;
+    bool m_enforce;
+    PrefixTrie m_trie;
+    std::vector<bool> m_enabled;
+    std::vector<uint64_t> m_checked;
+    std::vector<uint64_t> m_dropped;
+    TracedCallback<Ptr<const Packet>, const Ipv4Header &, uint32_t> m_spoofedTrace;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(IngressFilter);
+
+/*
+ * Adds an IngressFilter to router's Ipv4ListRouting. Call after addresses
+ * are assigned, then EnableInterface() the customer-facing interfaces.
+ */
+inline Ptr<IngressFilter>
+InstallIngressFilter(Ptr<Node> router, bool enforce = true)
+{
+    Ptr<Ipv4> ipv4 = router->GetObject<Ipv4>();
+    Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting>(ipv4->GetRoutingProtocol());
+    NS_ABORT_MSG_UNLESS(list, "IngressFilter needs Ipv4ListRouting (InternetStackHelper default)");
+
+    Ptr<IngressFilter> filter = CreateObject<IngressFilter>();
+    filter->SetAttribute("Enforce", BooleanValue(enforce));
+    // Above static (0) and global (-10) routing so it sees packets first.
+    list->AddRoutingProtocol(filter, 100);
+    return filter;
+}
+
+} // namespace ns3
+
+#endif /* INGRESS_FILTER_H */
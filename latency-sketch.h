@@ -0,0 +1,395 @@
+/*
+ * Per-flow latency and jitter as mergeable quantile sketches.
+ *
+ * LatencySketch is a log-linear (HDR-style) histogram over integer
+ * nanoseconds: values below 2^subBucketBits get one bucket each, every
+ * power of two above that is split into 2^subBucketBits equal buckets, so
+ * any reported quantile is within 2^-subBucketBits relative error (0.8 % at
+ * the default 7 bits) and memory is bounded by the largest value seen
+ * (at most 57 * 128 counters for 7 bits). Counts are integers, so merging
+ * two sketches gives exactly the sketch of the combined samples, which is
+ * what lets parallel replications be folded together without loss.
+ *
+ * FlowLatencyTracker feeds one delay sketch and one jitter sketch per IPv4
+ * 5-tuple from per-packet timestamps: Ipv4L3Protocol "SendOutgoing" on the
+ * originating node stamps the packet uid, "LocalDeliver" on the receiving
+ * node closes it. Jitter is the IP packet delay variation of RFC 5481,
+ * |D(i) - D(i-1)| between consecutively delivered packets of a flow.
+ */
+
+#ifndef LATENCY_SKETCH_H
+#define LATENCY_SKETCH_H
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/* ---------- SKETCH ---------- */
+
+class LatencySketch
+{
+  public:
+    explicit LatencySketch(uint32_t subBucketBits = 7)
+        : m_subBits(subBucketBits)
+    {
+    }
+
+    void Add(int64_t valueNs)
+    {
+        uint64_t v = valueNs < 0 ? 0 : valueNs;
+        uint32_t idx = Index(v);
+        if (idx >= m_counts.size())
+        {
+            m_counts.resize(idx + 1, 0);
+        }
+        m_counts[idx]++;
+        if (m_count == 0 || v < m_min)
+        {
+            m_min = v;
+        }
+        m_max = std::max(m_max, v);
+        m_sum += v;
+        m_count++;
+    }
+
+    // Exact: the result equals a sketch fed with both sample streams
+    void Merge(const LatencySketch &other)
+    {
+        if (other.m_count == 0)
+        {
+            return;
+        }
+        NS_ABORT_MSG_IF(other.m_subBits != m_subBits, "Merging sketches of different precision");
+        if (other.m_counts.size() > m_counts.size())
+        {
+            m_counts.resize(other.m_counts.size(), 0);
+        }
+        for (size_t i = 0; i < other.m_counts.size(); i++)
+        {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_min = m_count == 0 ? other.m_min : std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        m_sum += other.m_sum;
+        m_count += other.m_count;
+    }
+
+    uint64_t GetCount() const { return m_count; }
+
+    double GetMean() const { return m_count ? double(m_sum) / m_count : 0.0; }
+
+    uint64_t GetMin() const { return m_min; }
+
+    uint64_t GetMax() const { return m_max; }
+
+    size_t GetMemoryBytes() const { return sizeof(*this) + m_counts.capacity() * sizeof(uint64_t); }
+
+    // Value at quantile q in [0, 1] (nearest rank), in ns
+    uint64_t Quantile(double q) const
+    {
+        if (m_count == 0)
+        {
+            return 0;
+        }
+        uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(q * m_count)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < m_counts.size(); i++)
+        {
+            seen += m_counts[i];
+            if (seen >= rank)
+            {
+                return std::min(m_max, std::max(m_min, BucketMid(i)));
+            }
+        }
+        return m_max;
+    }
+
+    // One line: "bits count sum min max idx:count ..." (non-empty buckets only)
+    std::string Serialize() const
+    {
+        std::ostringstream out;
+        out << m_subBits << " " << m_count << " " << m_sum << " " << m_min << " " << m_max;
+        for (size_t i = 0; i < m_counts.size(); i++)
+        {
+            if (m_counts[i])
+            {
+                out << " " << i << ":" << m_counts[i];
+            }
+        }
+        return out.str();
+    }
+
+    static LatencySketch Parse(const std::string &line)
+    {
+        std::istringstream in(line);
+        uint32_t bits = 7;
+        in >> bits;
+        LatencySketch s(bits);
+        in >> s.m_count >> s.m_sum >> s.m_min >> s.m_max;
+        size_t idx;
+        char colon;
+        uint64_t n;
+        while (in >> idx >> colon >> n)
+        {
+            if (idx >= s.m_counts.size())
+            {
+                s.m_counts.resize(idx + 1, 0);
+            }
+            s.m_counts[idx] = n;
+        }
+        return s;
+    }
+
+  private:
+    // Linear below 2^bits; above, (octave, top bits of the mantissa)
+    uint32_t Index(uint64_t v) const
+    {
+        uint64_t m = uint64_t(1) << m_subBits;
+        if (v < m)
+        {
+            return v;
+        }
+        uint32_t msb = 63 - __builtin_clzll(v);
+        uint32_t shift = msb - m_subBits;
+        return (shift + 1) * m + ((v >> shift) - m);
+    }
+
+    uint64_t BucketMid(size_t idx) const
+    {
+        uint64_t m = uint64_t(1) << m_subBits;
+        if (idx < m)
+        {
+            return idx;
+        }
+        uint32_t shift = idx / m - 1;
+        uint64_t low = (m + idx % m) << shift;
+        return low + ((uint64_t(1) << shift) >> 1);
+    }
+
+    uint32_t m_subBits;
+    std::vector<uint64_t> m_counts;
+    uint64_t m_count = 0;
+    uint64_t m_sum = 0;
+    uint64_t m_min = 0;
+    uint64_t m_max = 0;
+};
+
+/* ---------- PER-FLOW LATENCY ---------- */
+
+struct FlowLatency
+{
+    LatencySketch delay;  // one-way delay, ns
+    LatencySketch jitter; // |D(i) - D(i-1)|, ns
+    int64_t lastDelayNs = -1;
+
+    void Merge(const FlowLatency &other)
+    {
+        delay.Merge(other.delay);
+        jitter.Merge(other.jitter);
+    }
+};
+
+// Flows by label, e.g. "TCP client 0"; one tab-separated line per flow
+typedef std::map<std::string, FlowLatency> FlowLatencyMap;
+
+inline std::string
+SerializeFlowLatency(const FlowLatencyMap &flows)
+{
+    std::ostringstream out;
+    for (auto const &f : flows)
+    {
+        out << f.first << "\t" << f.second.delay.Serialize() << "\t" << f.second.jitter.Serialize() << "\n";
+    }
+    return out.str();
+}
+
+// Merges every flow of a SerializeFlowLatency() payload into flows
+inline void
+MergeFlowLatency(FlowLatencyMap &flows, const std::string &payload)
+{
+    std::istringstream in(payload);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        size_t a = line.find('\t');
+        size_t b = line.find('\t', a + 1);
+        if (a == std::string::npos || b == std::string::npos)
+        {
+            continue;
+        }
+        FlowLatency f;
+        f.delay = LatencySketch::Parse(line.substr(a + 1, b - a - 1));
+        f.jitter = LatencySketch::Parse(line.substr(b + 1));
+        flows[line.substr(0, a)].Merge(f);
+    }
+}
+
+inline void
+PrintFlowLatency(std::ostream &os, const FlowLatencyMap &flows)
+{
+    os << std::left << std::setw(16) << "flow" << std::right << std::setw(10) << "packets"
+       << std::setw(10) << "mean_ms" << std::setw(10) << "p50_ms" << std::setw(10) << "p90_ms"
+       << std::setw(10) << "p99_ms" << std::setw(10) << "p99.9_ms" << std::setw(10) << "max_ms"
+       << std::setw(12) << "jitter_ms" << std::setw(14) << "p99_jitter_ms" << "\n";
+    std::ios_base::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+    for (auto const &f : flows)
+    {
+        const LatencySketch &d = f.second.delay;
+        const LatencySketch &j = f.second.jitter;
+        os << std::left << std::setw(16) << f.first << std::right << std::setw(10) << d.GetCount()
+           << std::setw(10) << d.GetMean() / 1e6 << std::setw(10) << d.Quantile(0.5) / 1e6
+           << std::setw(10) << d.Quantile(0.9) / 1e6 << std::setw(10) << d.Quantile(0.99) / 1e6
+           << std::setw(10) << d.Quantile(0.999) / 1e6 << std::setw(10) << d.GetMax() / 1e6
+           << std::setw(12) << j.GetMean() / 1e6 << std::setw(14) << j.Quantile(0.99) / 1e6 << "\n";
+    }
+    os.flags(flags);
+}
+
+// Tail-latency SLO: every flow's delay quantile q must be <= limitMs
+inline bool
+CheckLatencySlo(std::ostream &os, const FlowLatencyMap &flows, double q, double limitMs)
+{
+    bool ok = true;
+    for (auto const &f : flows)
+    {
+        double v = f.second.delay.Quantile(q) / 1e6;
+        if (v > limitMs)
+        {
+            os << "SLO violated: " << f.first << " p" << q * 100 << " delay " << v << " ms > "
+               << limitMs << " ms\n";
+            ok = false;
+        }
+    }
+    if (ok)
+    {
+        os << "SLO met: p" << q * 100 << " delay <= " << limitMs << " ms for every flow\n";
+    }
+    return ok;
+}
+
+/* ---------- TRACKER ---------- */
+
+struct FlowLatencyKey
+{
+    uint32_t src;
+    uint32_t dst;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint8_t protocol;
+
+    bool operator<(const FlowLatencyKey &o) const
+    {
+        return std::tie(src, dst, srcPort, dstPort, protocol) <
+               std::tie(o.src, o.dst, o.srcPort, o.dstPort, o.protocol);
+    }
+};
+
+class FlowLatencyTracker
+{
+  public:
+    // Packets still unmatched after maxAge (lost) are forgotten
+    explicit FlowLatencyTracker(ns3::Time maxAge = ns3::Seconds(10))
+        : m_maxAgeNs(maxAge.GetNanoSeconds())
+    {
+    }
+
+    // Hooks a node's IPv4 layer; install on every sender and receiver
+    void Install(ns3::Ptr<ns3::Node> node)
+    {
+        ns3::Ptr<ns3::Ipv4L3Protocol> ipv4 = node->GetObject<ns3::Ipv4L3Protocol>();
+        NS_ABORT_MSG_IF(!ipv4, "FlowLatencyTracker needs an IPv4 stack on node " << node->GetId());
+        ipv4->TraceConnectWithoutContext("SendOutgoing",
+                                         ns3::MakeCallback(&FlowLatencyTracker::Sent, this));
+        ipv4->TraceConnectWithoutContext("LocalDeliver",
+                                         ns3::MakeCallback(&FlowLatencyTracker::Delivered, this));
+    }
+
+    void Install(const ns3::NodeContainer &nodes)
+    {
+        for (uint32_t i = 0; i < nodes.GetN(); i++)
+        {
+            Install(nodes.Get(i));
+        }
+    }
+
+    const std::map<FlowLatencyKey, FlowLatency> &GetFlows() const { return m_flows; }
+
+    // The flow with this source address and protocol (any ports), merged;
+    // e.g. the data direction of one BulkSend client
+    FlowLatency GetFlow(ns3::Ipv4Address src, uint8_t protocol) const
+    {
+        FlowLatency merged;
+        for (auto const &f : m_flows)
+        {
+            if (f.first.src == src.Get() && f.first.protocol == protocol)
+            {
+                merged.Merge(f.second);
+            }
+        }
+        return merged;
+    }
+
+  private:
+    void Sent(const ns3::Ipv4Header &, ns3::Ptr<const ns3::Packet> packet, uint32_t)
+    {
+        int64_t now = ns3::Simulator::Now().GetNanoSeconds();
+        m_inFlight[packet->GetUid()] = now;
+        if (m_inFlight.size() >= m_purgeAt)
+        {
+            for (auto it = m_inFlight.begin(); it != m_inFlight.end();)
+            {
+                it = now - it->second > m_maxAgeNs ? m_inFlight.erase(it) : std::next(it);
+            }
+            m_purgeAt = std::max<size_t>(4096, 2 * m_inFlight.size());
+        }
+    }
+
+    void Delivered(const ns3::Ipv4Header &ip, ns3::Ptr<const ns3::Packet> packet, uint32_t)
+    {
+        auto it = m_inFlight.find(packet->GetUid());
+        if (it == m_inFlight.end())
+        {
+            return;
+        }
+        int64_t delay = ns3::Simulator::Now().GetNanoSeconds() - it->second;
+        m_inFlight.erase(it);
+
+        // The IP header is already stripped: TCP and UDP start with the ports
+        FlowLatencyKey key{ip.GetSource().Get(), ip.GetDestination().Get(), 0, 0, ip.GetProtocol()};
+        uint8_t ports[4];
+        if ((key.protocol == 6 || key.protocol == 17) && packet->CopyData(ports, 4) == 4)
+        {
+            key.srcPort = (ports[0] << 8) | ports[1];
+            key.dstPort = (ports[2] << 8) | ports[3];
+        }
+
+        FlowLatency &flow = m_flows[key];
+        flow.delay.Add(delay);
+        if (flow.lastDelayNs >= 0)
+        {
+            flow.jitter.Add(std::abs(delay - flow.lastDelayNs));
+        }
+        flow.lastDelayNs = delay;
+    }
+
+    int64_t m_maxAgeNs;
+    size_t m_purgeAt = 4096;
+    std::unordered_map<uint64_t, int64_t> m_inFlight; // uid -> send time (ns)
+    std::map<FlowLatencyKey, FlowLatency> m_flows;
+};
+
+#endif /* LATENCY_SKETCH_H */
@@ -0,0 +1,105 @@
+/*
+ * Heap accounting for setup phases.
+ *
+ * HeapInUseBytes() is the allocator's count of bytes currently handed out
+ * (glibc mallinfo2), so the difference between two calls is what the code
+ * in between kept allocated, independent of RSS growth, fragmentation or
+ * pages the allocator has not returned. MemoryBreakdown records it after
+ * every named phase and prints each phase's share, per node.
+ *
+ * Outside glibc (macOS, musl) there is no such count: HeapInUseBytes()
+ * returns -1 and MemoryBreakdown prints a note instead of a table.
+ */
+
+#ifndef MEMORY_PROBE_H
+#define MEMORY_PROBE_H
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// After a libc header: that is what defines __GLIBC__
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+inline int64_t
+HeapInUseBytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 mi = mallinfo2();
+    return int64_t(mi.uordblks) + int64_t(mi.hblkhd);
+#elif defined(__GLIBC__)
+    // 32-bit counters: wrap past 4 GB
+    struct mallinfo mi = mallinfo();
+    return int64_t(uint32_t(mi.uordblks)) + int64_t(uint32_t(mi.hblkhd));
+#else
+    return -1;
+#endif
+}
+
+inline bool
+HeapAccountingAvailable()
+{
+#ifdef __GLIBC__
+    return true;
+#else
+    return false;
+#endif
+}
+
+class MemoryBreakdown
+{
+  public:
+    MemoryBreakdown()
+        : m_last(HeapInUseBytes()),
+          m_start(m_last)
+    {
+    }
+
+    // Attributes everything allocated since the previous Mark() to phase
+    void Mark(const std::string &phase)
+    {
+        int64_t now = HeapInUseBytes();
+        m_phases.emplace_back(phase, now - m_last);
+        m_last = now;
+    }
+
+    int64_t GetTotal() const { return m_last - m_start; }
+
+    void Print(std::ostream &os, uint32_t nodes) const
+    {
+        if (!HeapAccountingAvailable())
+        {
+            os << "heap accounting needs glibc (mallinfo2); not available here\n";
+            return;
+        }
+        os << std::left << std::setw(20) << "phase" << std::right << std::setw(14) << "bytes"
+           << std::setw(14) << "bytes/node" << std::setw(8) << "share" << "\n";
+        std::ios_base::fmtflags flags = os.flags();
+        os << std::fixed << std::setprecision(1);
+        for (auto const &p : m_phases)
+        {
+            Row(os, p.first, p.second, nodes);
+        }
+        Row(os, "total", GetTotal(), nodes);
+        os.flags(flags);
+    }
+
+  private:
+    void Row(std::ostream &os, const std::string &name, int64_t bytes, uint32_t nodes) const
+    {
+        os << std::left << std::setw(20) << name << std::right << std::setw(14) << bytes
+           << std::setw(14) << (nodes ? double(bytes) / nodes : 0.0) << std::setw(7)
+           << (GetTotal() ? 100.0 * bytes / GetTotal() : 0.0) << "%\n";
+    }
+
+    int64_t m_last;
+    int64_t m_start;
+    std::vector<std::pair<std::string, int64_t>> m_phases;
+};
+
+#endif /* MEMORY_PROBE_H */
@@ -0,0 +1,498 @@
+/*
+ * Mesh variant of multihop-routing.cc: --paths parallel routers between
+ * Client A and Server B, i.e. as many equal-cost two-hop paths.
+ *
+ *              +-- R1 --+
+ *   Client A --+-- R2 --+-- Server B
+ *              +-- Rk --+
+ *
+ * A-Ri links are 10Mbps/5ms and Ri-B links 5Mbps/10ms as in the chain
+ * (--skewMs adds i * skew to the Ri-B delay of path i, hop counts stay
+ * equal). B's service address sits on a stub LAN behind it, so every path
+ * is equally short to it for network-based global routing too.
+ *
+ * --flows BulkSend flows go from A to B under each --ecmp mode:
+ *   none    global routing, one shortest path (the first)
+ *   packet  global routing with RandomEcmpRouting: per-packet random spray
+ *   flow    shared-table routing (shared-routing.h) with FlowEcmp: the
+ *           5-tuple hash pins each flow to one path
+ * Each mode runs in its own process. Reported per mode: aggregate goodput
+ * and the gain over the first mode, the share of data segments arriving at
+ * B below the highest sequence number already seen for their flow
+ * (reordering; retransmissions count too), and every path's Ri->B
+ * utilisation.
+ *
+ * Link failure: --failPath=i takes the Ri-B link of path i down at --failAt
+ * and back up at --recoverAt (both interfaces, so queued and in-flight
+ * packets are lost too). Routing reacts --detectMs later, modelling failure
+ * detection: global routing with a full RecomputeRoutingTables(), shared
+ * tables with SetLinkState(), which repairs only the hop counts of the
+ * nodes the link change affects. Also reported then: wall time of the route
+ * updates (down + up) and the hop-count entries they rewrote, packets the
+ * IP layer dropped for a down interface or a missing route, and how long
+ * after each event the goodput (in --sampleMs windows) is back to 90% of
+ * what the surviving paths can carry, and of the pre-failure level. With
+ * --paths=1 this is the R-B bottleneck of multihop-routing.cc failing.
+ *
+ * Example:
+ *   ./ns3 run "multihop-mesh --paths=4 --flows=32 --ecmp=none,packet,flow"
+ *   ./ns3 run "multihop-mesh --paths=4 --skewMs=5 --ecmp=packet,flow"
+ *   ./ns3 run "multihop-mesh --paths=4 --failPath=0 --failAt=4 --recoverAt=7 --ecmp=none,flow"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/applications-module.h"
+
+#include "parallel-runner.h"
+#include "shared-routing.h"
+
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MultihopMesh");
+
+struct MeshConfig
+{
+    uint32_t paths = 4;
+    std::string dataRateAR = "10Mbps";
+    std::string delayAR = "5ms";
+    std::string dataRateRB = "5Mbps";
+    double delayRBms = 10.0;
+    double skewMs = 0.0;
+    uint32_t flows = 16;
+    double appStart = 1.0;
+    double simTime = 10.0;
+    uint32_t run = 1;
+    int32_t failPath = -1;
+    double failAt = 4.0;
+    double recoverAt = 7.0; // 0 = never
+    double detectMs = 50.0;
+    double sampleMs = 100.0;
+};
+
+/* ---------- COUNTERS ---------- */
+
+static void
+CountTxBytes(uint64_t *bytes, Ptr<const Packet> p)
+{
+    *bytes += p->GetSize();
+}
+
+struct FlowOrder
+{
+    bool seen = false;
+    SequenceNumber32 highest;
+    uint64_t segments = 0;
+    uint64_t reordered = 0;
+};
+
+// Data segments delivered to B, per sending port
+static void
+TcpArrival(std::map<uint16_t, FlowOrder> *flows, const Ipv4Header &header, Ptr<const Packet> p, uint32_t)
+{
+    if (header.GetProtocol() != 6)
+    {
+        return;
+    }
+    TcpHeader tcp;
+    p->PeekHeader(tcp);
+    uint32_t len = p->GetSize() - tcp.GetSerializedSize();
+    if (len == 0)
+    {
+        return;
+    }
+    FlowOrder &f = (*flows)[tcp.GetSourcePort()];
+    f.segments++;
+    if (f.seen && tcp.GetSequenceNumber() < f.highest)
+    {
+        f.reordered++;
+    }
+    else
+    {
+        f.highest = tcp.GetSequenceNumber() + len;
+        f.seen = true;
+    }
+}
+
+/* ---------- LINK FAILURE ---------- */
+
+struct LinkFailure
+{
+    NetDeviceContainer link; // Ri-B
+    Ptr<SharedRoutingTable> table; // null: global routing
+    uint64_t lost = 0;
+    double recomputeUs = 0;
+    uint64_t entries = 0;
+};
+
+static void
+SetLinkUp(LinkFailure *f, bool up)
+{
+    for (uint32_t i = 0; i < f->link.GetN(); i++)
+    {
+        Ptr<NetDevice> dev = f->link.Get(i);
+        Ptr<Ipv4> ipv4 = dev->GetNode()->GetObject<Ipv4>();
+        int32_t ifIndex = ipv4->GetInterfaceForDevice(dev);
+        if (up)
+            ipv4->SetUp(ifIndex);
+        else
+            ipv4->SetDown(ifIndex);
+    }
+}
+
+static void
+Reroute(LinkFailure *f, bool up)
+{
+    auto start = std::chrono::steady_clock::now();
+    if (f->table)
+    {
+        SharedRoutingTable::RepairStats stats =
+            f->table->SetLinkState(f->link.Get(0)->GetNode()->GetId(), f->link.Get(1)->GetNode()->GetId(), up);
+        f->entries += stats.entries;
+    }
+    else
+    {
+        Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    }
+    f->recomputeUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void
+FailureDrop(LinkFailure *f, const Ipv4Header &, Ptr<const Packet>, Ipv4L3Protocol::DropReason reason,
+            Ptr<Ipv4>, uint32_t)
+{
+    if (reason == Ipv4L3Protocol::DROP_INTERFACE_DOWN || reason == Ipv4L3Protocol::DROP_NO_ROUTE ||
+        reason == Ipv4L3Protocol::DROP_ROUTE_ERROR)
+    {
+        f->lost++;
+    }
+}
+
+static void
+SampleGoodput(Ptr<PacketSink> sink, Time interval, std::vector<uint64_t> *totals)
+{
+    totals->push_back(sink->GetTotalRx());
+    Simulator::Schedule(interval, &SampleGoodput, sink, interval, totals);
+}
+
+/*
+ * Seconds from `from` until the end of the first whole window at or after
+ * it whose goodput reaches target Mbps (-1: never). totals[k] is the sink
+ * total at appStart + k * window.
+ */
+static double
+TimeToGoodput(const std::vector<uint64_t> &totals, double appStart, double window, double from, double target)
+{
+    for (size_t k = 1; k < totals.size(); k++)
+    {
+        double start = appStart + (k - 1) * window;
+        if (start + 1e-9 >= from && (totals[k] - totals[k - 1]) * 8.0 / window / 1e6 >= target)
+        {
+            return start + window - from;
+        }
+    }
+    return -1;
+}
+
+static std::string
+RecoveryTime(double s)
+{
+    if (s < 0)
+    {
+        return "never";
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << s;
+    return out.str();
+}
+
+/* ---------- ONE MODE ---------- */
+
+// Returns "goodputMbps reorderedPct lost recomputeUs entries failoverS
+// restoreS pathMbps..."
+static std::string
+RunMesh(const MeshConfig &cfg, const std::string &ecmp)
+{
+    RngSeedManager::SetRun(cfg.run);
+
+    // --- TOPOLOGY ---
+    // Node 0 is A, 1..paths the routers, paths + 1 is B
+    NodeContainer nodes;
+    nodes.Create(cfg.paths + 2);
+    Ptr<Node> a = nodes.Get(0);
+    Ptr<Node> b = nodes.Get(cfg.paths + 1);
+
+    InternetStackHelper stack;
+    Ptr<SharedRoutingTable> table;
+    Ipv4ListRoutingHelper list;
+    Ipv4StaticRoutingHelper staticRouting;
+    if (ecmp == "packet")
+    {
+        Config::SetDefault("ns3::Ipv4GlobalRouting::RandomEcmpRouting", BooleanValue(true));
+    }
+    else if (ecmp == "flow")
+    {
+        Config::SetDefault("ns3::SharedTableRouting::FlowEcmp", BooleanValue(true));
+        table = Create<SharedRoutingTable>();
+        list.Add(staticRouting, 0);
+        list.Add(SharedTableRoutingHelper(table), -10);
+        stack.SetRoutingHelper(list);
+    }
+    else if (ecmp != "none")
+    {
+        NS_FATAL_ERROR("Unknown ecmp mode " << ecmp);
+    }
+    stack.Install(nodes);
+
+    PointToPointHelper p2pAR;
+    p2pAR.SetDeviceAttribute("DataRate", StringValue(cfg.dataRateAR));
+    p2pAR.SetChannelAttribute("Delay", StringValue(cfg.delayAR));
+    PointToPointHelper p2pRB;
+    p2pRB.SetDeviceAttribute("DataRate", StringValue(cfg.dataRateRB));
+
+    Ipv4AddressHelper address;
+    std::vector<NetDeviceContainer> rbLinks;
+    for (uint32_t i = 0; i < cfg.paths; i++)
+    {
+        Ptr<Node> r = nodes.Get(i + 1);
+        std::ostringstream netAR, netRB;
+        netAR << "10.1." << i + 1 << ".0";
+        netRB << "10.2." << i + 1 << ".0";
+        address.SetBase(netAR.str().c_str(), "255.255.255.0");
+        address.Assign(p2pAR.Install(a, r));
+
+        p2pRB.SetChannelAttribute("Delay", TimeValue(MilliSeconds(cfg.delayRBms + i * cfg.skewMs)));
+        NetDeviceContainer dRB = p2pRB.Install(r, b);
+        address.SetBase(netRB.str().c_str(), "255.255.255.0");
+        address.Assign(dRB);
+        rbLinks.push_back(dRB);
+    }
+
+    // Service address on a stub LAN of B's own
+    CsmaHelper stub;
+    address.SetBase("10.3.1.0", "255.255.255.0");
+    Ipv4Address serverAddress = address.Assign(stub.Install(b)).GetAddress(0);
+
+    if (table)
+    {
+        table->Build(nodes);
+    }
+    else
+    {
+        Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    }
+
+    // --- TRAFFIC ---
+    uint16_t port = 50000;
+    PacketSinkHelper sinkHelper("ns3::TcpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), port));
+    ApplicationContainer sinkApp = sinkHelper.Install(b);
+    sinkApp.Start(Seconds(0.0));
+
+    BulkSendHelper bulk("ns3::TcpSocketFactory", InetSocketAddress(serverAddress, port));
+    bulk.SetAttribute("MaxBytes", UintegerValue(0));
+    ApplicationContainer senders;
+    for (uint32_t f = 0; f < cfg.flows; f++)
+    {
+        senders.Add(bulk.Install(a));
+    }
+    // Small offsets so the handshakes do not all collide
+    for (uint32_t f = 0; f < senders.GetN(); f++)
+    {
+        senders.Get(f)->SetStartTime(Seconds(cfg.appStart + f * 0.001));
+    }
+    senders.Stop(Seconds(cfg.simTime));
+
+    // --- COUNTERS ---
+    std::vector<uint64_t> pathBytes(cfg.paths, 0);
+    for (uint32_t i = 0; i < cfg.paths; i++)
+    {
+        rbLinks[i].Get(0)->TraceConnectWithoutContext("PhyTxEnd", MakeBoundCallback(&CountTxBytes, &pathBytes[i]));
+    }
+    std::map<uint16_t, FlowOrder> order;
+    b->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext("LocalDeliver",
+                                                                MakeBoundCallback(&TcpArrival, &order));
+
+    // --- FAILURE ---
+    LinkFailure failure;
+    std::vector<uint64_t> totals;
+    Time window = MilliSeconds(cfg.sampleMs);
+    if (cfg.failPath >= 0)
+    {
+        NS_ABORT_MSG_IF(uint32_t(cfg.failPath) >= cfg.paths, "--failPath must be below --paths");
+        failure.link = rbLinks[cfg.failPath];
+        failure.table = table;
+        for (uint32_t n = 0; n < nodes.GetN(); n++)
+        {
+            nodes.Get(n)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+                "Drop", MakeBoundCallback(&FailureDrop, &failure));
+        }
+        Time detect = MilliSeconds(cfg.detectMs);
+        Simulator::Schedule(Seconds(cfg.failAt), &SetLinkUp, &failure, false);
+        Simulator::Schedule(Seconds(cfg.failAt) + detect, &Reroute, &failure, false);
+        if (cfg.recoverAt > cfg.failAt)
+        {
+            Simulator::Schedule(Seconds(cfg.recoverAt), &SetLinkUp, &failure, true);
+            Simulator::Schedule(Seconds(cfg.recoverAt) + detect, &Reroute, &failure, true);
+        }
+        Simulator::Schedule(Seconds(cfg.appStart), &SampleGoodput, DynamicCast<PacketSink>(sinkApp.Get(0)),
+                            window, &totals);
+    }
+
+    Simulator::Stop(Seconds(cfg.simTime));
+    Simulator::Run();
+
+    // --- RESULT ---
+    double duration = cfg.simTime - cfg.appStart;
+    uint64_t rx = DynamicCast<PacketSink>(sinkApp.Get(0))->GetTotalRx();
+    uint64_t segments = 0, reordered = 0;
+    for (auto const &f : order)
+    {
+        segments += f.second.segments;
+        reordered += f.second.reordered;
+    }
+    // Failover target: what the surviving paths carry, capped by the
+    // pre-failure level (one path's worth under single-path routing)
+    double failoverS = -1, restoreS = -1;
+    if (cfg.failPath >= 0)
+    {
+        double w = window.GetSeconds();
+        double before = 0;
+        uint32_t n = 0;
+        for (size_t k = 1; k < totals.size(); k++)
+        {
+            double start = cfg.appStart + (k - 1) * w;
+            if (start >= std::max(cfg.appStart + 1.0, cfg.failAt - 2.0) && start + w <= cfg.failAt + 1e-9)
+            {
+                before += (totals[k] - totals[k - 1]) * 8.0 / w / 1e6;
+                n++;
+            }
+        }
+        before = n ? before / n : 0;
+        double surviving = (cfg.paths - 1) * DataRate(cfg.dataRateRB).GetBitRate() / 1e6;
+        if (surviving > 0)
+        {
+            failoverS = TimeToGoodput(totals, cfg.appStart, w, cfg.failAt, 0.9 * std::min(before, surviving));
+        }
+        if (cfg.recoverAt > cfg.failAt)
+        {
+            restoreS = TimeToGoodput(totals, cfg.appStart, w, cfg.recoverAt, 0.9 * before);
+        }
+    }
+
+    std::ostringstream out;
+    out << rx * 8.0 / duration / 1e6 << " " << (segments ? 100.0 * reordered / segments : 0.0) << " "
+        << failure.lost << " " << failure.recomputeUs << " " << failure.entries << " " << failoverS << " "
+        << restoreS;
+    for (uint64_t bytes : pathBytes)
+    {
+        out << " " << bytes * 8.0 / duration / 1e6;
+    }
+    Simulator::Destroy();
+    return out.str();
+}
+
+int main(int argc, char *argv[])
+{
+    // --- 1. CONFIGURATION ---
+    MeshConfig cfg;
+    std::string ecmp = "none,packet,flow";
+    uint32_t jobs = DefaultParallelJobs();
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("paths", "Parallel routers (equal-cost paths) between A and B", cfg.paths);
+    cmd.AddValue("dataRateAR", "A-Ri link rate", cfg.dataRateAR);
+    cmd.AddValue("delayAR", "A-Ri link delay", cfg.delayAR);
+    cmd.AddValue("dataRateRB", "Ri-B link rate", cfg.dataRateRB);
+    cmd.AddValue("delayRBms", "Ri-B link delay (ms)", cfg.delayRBms);
+    cmd.AddValue("skewMs", "Extra Ri-B delay per path index (ms)", cfg.skewMs);
+    cmd.AddValue("flows", "BulkSend flows from A to B", cfg.flows);
+    cmd.AddValue("simTime", "Simulated seconds", cfg.simTime);
+    cmd.AddValue("run", "RngRun", cfg.run);
+    cmd.AddValue("ecmp", "Comma-separated modes: none, packet, flow", ecmp);
+    cmd.AddValue("jobs", "Modes run concurrently", jobs);
+    cmd.AddValue("failPath", "Path whose Ri-B link fails (-1 = none)", cfg.failPath);
+    cmd.AddValue("failAt", "Link failure time (s)", cfg.failAt);
+    cmd.AddValue("recoverAt", "Link recovery time (s, 0 = never)", cfg.recoverAt);
+    cmd.AddValue("detectMs", "Delay from a link event to the route update (ms)", cfg.detectMs);
+    cmd.AddValue("sampleMs", "Goodput window for the recovery times (ms)", cfg.sampleMs);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(cfg.paths == 0 || cfg.paths > 254, "--paths must be 1..254");
+
+    // --- 2. RUN ---
+    std::vector<std::string> modes = SplitList(ecmp);
+    std::vector<std::string> rows(modes.size());
+    RunParallel(
+        modes.size(), jobs,
+        [&](uint32_t i) { return RunMesh(cfg, modes[i]); },
+        [&](const ParallelJobResult &r) {
+            rows[r.index] = r.ok ? r.output : "";
+            return true;
+        });
+
+    // --- 3. REPORT ---
+    double capacity = DataRate(cfg.dataRateRB).GetBitRate() / 1e6;
+    std::cout << cfg.paths << " paths of " << cfg.dataRateRB << ", " << cfg.flows << " BulkSend flows, "
+              << cfg.simTime - cfg.appStart << " s\n";
+    bool failure = cfg.failPath >= 0;
+    if (failure)
+    {
+        std::cout << "Ri-B link of path " << cfg.failPath << " down at " << cfg.failAt << " s"
+                  << (cfg.recoverAt > cfg.failAt ? ", up at " + std::to_string(cfg.recoverAt) + " s" : "")
+                  << ", routes updated " << cfg.detectMs << " ms after each event\n";
+    }
+    std::cout << std::left << std::setw(8) << "ecmp" << std::right << std::setw(12) << "goodput" << std::setw(8)
+              << "gain" << std::setw(11) << "reordered";
+    if (failure)
+    {
+        std::cout << std::setw(8) << "lost" << std::setw(14) << "recompute_us" << std::setw(10) << "entries"
+                  << std::setw(12) << "failover_s" << std::setw(11) << "restore_s";
+    }
+    std::cout << "   per-path Ri->B Mbps (utilisation)\n";
+    std::cout << std::fixed << std::setprecision(2);
+    int status = 0;
+    double baseline = 0;
+    for (size_t i = 0; i < modes.size(); i++)
+    {
+        std::istringstream in(rows[i]);
+        double goodput, reorderedPct, recomputeUs, failoverS, restoreS;
+        uint64_t lost, entries;
+        if (!(in >> goodput >> reorderedPct >> lost >> recomputeUs >> entries >> failoverS >> restoreS))
+        {
+            std::cout << std::left << std::setw(8) << modes[i] << std::right << "  FAILED\n";
+            status = 1;
+            continue;
+        }
+        if (baseline == 0)
+        {
+            baseline = goodput;
+        }
+        std::cout << std::left << std::setw(8) << modes[i] << std::right << std::setw(12) << goodput
+                  << std::setw(7) << (baseline > 0 ? goodput / baseline : 0.0) << "x" << std::setw(10)
+                  << reorderedPct << "%";
+        if (failure)
+        {
+            std::cout << std::setw(8) << lost << std::setw(14) << recomputeUs << std::setw(10)
+                      << (modes[i] == "flow" ? std::to_string(entries) : "full")
+                      << std::setw(12) << (cfg.paths > 1 ? RecoveryTime(failoverS) : "n/a") << std::setw(11)
+                      << (cfg.recoverAt > cfg.failAt ? RecoveryTime(restoreS) : "n/a");
+        }
+        std::cout << "  ";
+        double mbps;
+        while (in >> mbps)
+        {
+            std::cout << " " << mbps << " (" << std::setprecision(0) << 100.0 * mbps / capacity << "%)"
+                      << std::setprecision(2);
+        }
+        std::cout << "\n";
+    }
+    return status;
+}
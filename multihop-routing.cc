@@ -13,6 +13,13 @@
  * 1. Build: ./ns3 build
  * 2. Run: ./ns3 run mesh-routing-analysis
  * 3. Analyze: Open 'mesh-routing-analysis.tr' (text editor) and 'mesh-routing-analysis.xml' (NetAnim).
+ *
+ * For long runs use the compact binary trace instead of ASCII:
+ *   ./ns3 run "mesh-routing-analysis --traceFormat=binary --traceEvents=enqueue,rx,drop"
+ *   ./ns3 run "trace-query --input=mesh-routing-analysis.pkt --query=hops"
+ *
+ * multihop-mesh.cc runs the same links with several routers in parallel
+ * (equal-cost paths, ECMP).
  */
 
 #include "ns3/core-module.h"
@@ -22,6 +29,10 @@
 #include "ns3/applications-module.h"
 #include "ns3/netanim-module.h" // Include for NetAnim
 
+#include "binary-trace.h"
+
+#include <memory>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("MeshRoutingAnalysis");
@@ -36,10 +47,18 @@ int main(int argc, char *argv[])
     
     uint32_t packetSize = 1024;
     double simTime = 5.0;
+    std::string traceFormat = "ascii";
+    std::string traceEvents = "all";
+    uint32_t traceSample = 1;
+    int32_t traceNode = -1;
     
     // Command Line Parsing is kept simple as per request
     CommandLine cmd(__FILE__);
     cmd.AddValue("simTime", "Total duration of the simulation in seconds", simTime);
+    cmd.AddValue("traceFormat", "ascii, binary or none", traceFormat);
+    cmd.AddValue("traceEvents", "binary: events to record (enqueue,tx,rx,drop or all)", traceEvents);
+    cmd.AddValue("traceSample", "binary: keep 1 in N packets (by uid, whole paths)", traceSample);
+    cmd.AddValue("traceNode", "binary: only trace devices of this node (-1 = all)", traceNode);
     cmd.Parse(argc, argv);
 
     // --- 2. TOPOLOGY SETUP ---
@@ -100,13 +119,39 @@ int main(int argc, char *argv[])
     clientApp.Start(Seconds(1.0)); // Send packet at 1.0s
     clientApp.Stop(Seconds(simTime));
 
-    // --- 7. ANALYSIS (ASCII Tracing & NetAnim) ---
-
-    // 7a. ASCII TRACE (.tr file) for detailed path and timing analysis
-    AsciiTraceHelper ascii;
-    // Both links log to the same trace file
-    p2pAR.EnableAsciiAll(ascii.CreateFileStream("mesh-routing-analysis.tr"));
-    p2pRB.EnableAsciiAll(ascii.CreateFileStream("mesh-routing-analysis.tr"));
+    // --- 7. ANALYSIS (Packet Tracing & NetAnim) ---
+
+    std::unique_ptr<BinaryTraceSink> binaryTrace;
+    if (traceFormat == "ascii")
+    {
+        // 7a. ASCII TRACE (.tr file) for detailed path and timing analysis
+        AsciiTraceHelper ascii;
+        // Both links log to the same trace file; opening it twice would truncate it.
+        Ptr<OutputStreamWrapper> stream = ascii.CreateFileStream("mesh-routing-analysis.tr");
+        p2pAR.EnableAsciiAll(stream);
+        p2pRB.EnableAsciiAll(stream);
+    }
+    else if (traceFormat == "binary")
+    {
+        // 7a'. BINARY TRACE (.pkt file), query with trace-query
+        binaryTrace.reset(new BinaryTraceSink("mesh-routing-analysis.pkt"));
+        binaryTrace->SetEventMask(ParseTraceEvents(traceEvents));
+        binaryTrace->SetSampling(traceSample);
+        for (NetDeviceContainer *d : {&dAR, &dRB})
+        {
+            for (uint32_t i = 0; i < d->GetN(); i++)
+            {
+                if (traceNode < 0 || d->Get(i)->GetNode()->GetId() == uint32_t(traceNode))
+                {
+                    binaryTrace->Attach(d->Get(i));
+                }
+            }
+        }
+    }
+    else if (traceFormat != "none")
+    {
+        NS_FATAL_ERROR("Unknown traceFormat " << traceFormat);
+    }
     
     // 7b. NETANIM (.xml file) for visualization
     AnimationInterface anim("mesh-routing-analysis.xml");
@@ -120,5 +165,11 @@ int main(int argc, char *argv[])
     Simulator::Run();
     Simulator::Destroy();
 
+    if (binaryTrace)
+    {
+        binaryTrace->Close();
+        std::cout << binaryTrace->GetRecordCount() << " packet trace records written to mesh-routing-analysis.pkt\n";
+    }
+
     return 0;
 }
@@ -0,0 +1,268 @@
+/*
+ * Analytical-vs-simulated delay validation for point-to-point chains.
+ *
+ * For a UDP packet crossing H store-and-forward point-to-point links with
+ * empty queues, the one-way delay is
+ *
+ *   sum over links of  wireBytes * 8 / rate + propagation delay
+ *
+ * where wireBytes = payload + 8 (UDP) + 20 (IPv4) + 2 (PPP). For the
+ * point-to-pointdelay defaults (1024 B, 10Mbps, 10ms) that is 10.8432 ms,
+ * not the 10.8192 ms obtained from the payload alone.
+ *
+ * Every combination of rate, delay, packet size and hop count is one grid
+ * point, plus multihop-routing's two-link chain (10Mbps/5ms then
+ * 5Mbps/10ms). Each point runs in its own process (parallel-runner.h) and
+ * measures the delay of every echo request from the client's Tx trace to
+ * the server's Rx trace, matched by packet uid. A point passes when every
+ * packet is within --toleranceNs of the closed form. The exit status is
+ * non-zero if any point fails, so this can gate ns-3 upgrades.
+ *
+ * Example:
+ *   ./ns3 run "p2p-delay-validation --rates=1Mbps,10Mbps,1Gbps --delays=1ms,10ms
+ *              --sizes=64,1024,1472 --hops=1,2,4"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+#include "parallel-runner.h"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("P2pDelayValidation");
+
+static const uint32_t kWireOverhead = 8 + 20 + 2; // UDP + IPv4 + PPP
+
+struct DelayCase
+{
+    std::string label;
+    std::vector<std::string> rates;  // one per link
+    std::vector<std::string> delays; // one per link
+    uint32_t packetSize;
+};
+
+/* ---------- CLOSED FORM ---------- */
+
+static double
+ExpectedDelay(const DelayCase &c)
+{
+    double total = 0;
+    for (size_t i = 0; i < c.rates.size(); i++)
+    {
+        total += (c.packetSize + kWireOverhead) * 8.0 / DataRate(c.rates[i]).GetBitRate() +
+                 Time(c.delays[i]).GetSeconds();
+    }
+    return total;
+}
+
+/* ---------- SIMULATION ---------- */
+
+struct DelayProbe
+{
+    std::map<uint64_t, int64_t> sentNs; // uid -> client Tx time
+    int64_t minNs = INT64_MAX;
+    int64_t maxNs = 0;
+    uint32_t received = 0;
+};
+
+static void
+ProbeTx(DelayProbe *probe, Ptr<const Packet> p)
+{
+    probe->sentNs[p->GetUid()] = Simulator::Now().GetNanoSeconds();
+}
+
+static void
+ProbeRx(DelayProbe *probe, Ptr<const Packet> p)
+{
+    auto it = probe->sentNs.find(p->GetUid());
+    if (it == probe->sentNs.end())
+    {
+        return;
+    }
+    int64_t d = Simulator::Now().GetNanoSeconds() - it->second;
+    probe->minNs = std::min(probe->minNs, d);
+    probe->maxNs = std::max(probe->maxNs, d);
+    probe->received++;
+    probe->sentNs.erase(it);
+}
+
+// Runs one case; returns "sent received min_ns max_ns".
+static std::string
+RunDelayCase(const DelayCase &c, uint32_t numPackets)
+{
+    uint32_t hops = c.rates.size();
+
+    NodeContainer nodes;
+    nodes.Create(hops + 1);
+
+    InternetStackHelper stack;
+    stack.Install(nodes);
+
+    Ipv4AddressHelper address;
+    address.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer last;
+    for (uint32_t i = 0; i < hops; i++)
+    {
+        PointToPointHelper p2p;
+        p2p.SetDeviceAttribute("DataRate", StringValue(c.rates[i]));
+        p2p.SetChannelAttribute("Delay", StringValue(c.delays[i]));
+        last = address.Assign(p2p.Install(nodes.Get(i), nodes.Get(i + 1)));
+        address.NewNetwork();
+    }
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    // Spaced far enough apart that every packet finds empty queues.
+    double interval = 2 * ExpectedDelay(c) + 0.1;
+    double stop = 1.0 + numPackets * interval + 1.0;
+
+    uint16_t port = 7;
+    UdpEchoServerHelper echoServer(port);
+    ApplicationContainer serverApp = echoServer.Install(nodes.Get(hops));
+    serverApp.Start(Seconds(0.0));
+    serverApp.Stop(Seconds(stop));
+
+    UdpEchoClientHelper echoClient(last.GetAddress(1), port);
+    echoClient.SetAttribute("MaxPackets", UintegerValue(numPackets));
+    echoClient.SetAttribute("Interval", TimeValue(Seconds(interval)));
+    echoClient.SetAttribute("PacketSize", UintegerValue(c.packetSize));
+    ApplicationContainer clientApp = echoClient.Install(nodes.Get(0));
+    clientApp.Start(Seconds(1.0));
+    clientApp.Stop(Seconds(stop));
+
+    DelayProbe probe;
+    clientApp.Get(0)->TraceConnectWithoutContext("Tx", MakeBoundCallback(&ProbeTx, &probe));
+    serverApp.Get(0)->TraceConnectWithoutContext("Rx", MakeBoundCallback(&ProbeRx, &probe));
+
+    Simulator::Stop(Seconds(stop));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    std::ostringstream out;
+    out << numPackets << " " << probe.received << " " << probe.minNs << " " << probe.maxNs;
+    return out.str();
+}
+
+int main(int argc, char *argv[])
+{
+    // --- 1. CONFIGURATION ---
+    std::string rates = "1Mbps,10Mbps,100Mbps";
+    std::string delays = "1ms,10ms";
+    std::string sizes = "64,1024,1472";
+    std::string hops = "1,2,4";
+    bool multihop = true;
+    uint32_t numPackets = 5;
+    int64_t toleranceNs = 10;
+    uint32_t jobs = DefaultParallelJobs();
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("rates", "Comma-separated link rates", rates);
+    cmd.AddValue("delays", "Comma-separated link propagation delays", delays);
+    cmd.AddValue("sizes", "Comma-separated UDP payload sizes in bytes", sizes);
+    cmd.AddValue("hops", "Comma-separated chain lengths (identical links)", hops);
+    cmd.AddValue("multihop", "Also check multihop-routing's 10Mbps/5ms + 5Mbps/10ms chain", multihop);
+    cmd.AddValue("numPackets", "Echo requests measured per grid point", numPackets);
+    cmd.AddValue("toleranceNs", "Allowed |measured - expected| per packet", toleranceNs);
+    cmd.AddValue("jobs", "Number of grid points run concurrently", jobs);
+    cmd.Parse(argc, argv);
+
+    // --- 2. GRID ---
+    std::vector<DelayCase> grid;
+    for (auto const &r : SplitList(rates))
+    {
+        for (auto const &dl : SplitList(delays))
+        {
+            for (auto const &s : SplitList(sizes))
+            {
+                for (auto const &h : SplitList(hops))
+                {
+                    uint32_t n = std::stoul(h);
+                    grid.push_back({"chain", std::vector<std::string>(n, r),
+                                    std::vector<std::string>(n, dl),
+                                    static_cast<uint32_t>(std::stoul(s))});
+                }
+            }
+        }
+    }
+    if (multihop)
+    {
+        for (auto const &s : SplitList(sizes))
+        {
+            grid.push_back({"multihop", {"10Mbps", "5Mbps"}, {"5ms", "10ms"},
+                            static_cast<uint32_t>(std::stoul(s))});
+        }
+    }
+
+    // --- 3. RUN ---
+    std::vector<ParallelJobResult> results = RunParallel(
+        grid.size(), jobs, [&](uint32_t i) { return RunDelayCase(grid[i], numPackets); });
+
+    std::vector<std::string> outputs(grid.size());
+    std::vector<bool> ran(grid.size(), false);
+    for (auto const &r : results)
+    {
+        ran[r.index] = r.ok;
+        outputs[r.index] = r.output;
+    }
+
+    // --- 4. REPORT ---
+    std::cout << std::left << std::setw(9) << "case" << std::setw(16) << "rate"
+              << std::setw(12) << "delay" << std::setw(6) << "size" << std::setw(5) << "hops"
+              << std::right << std::setw(14) << "expected_ms" << std::setw(14) << "measured_ms"
+              << std::setw(10) << "err_ns" << "  result\n";
+
+    uint32_t failed = 0;
+    for (size_t i = 0; i < grid.size(); i++)
+    {
+        const DelayCase &c = grid[i];
+        double expectedNs = ExpectedDelay(c) * 1e9;
+
+        uint32_t sent = 0;
+        uint32_t received = 0;
+        int64_t minNs = 0;
+        int64_t maxNs = 0;
+        std::istringstream in(outputs[i]);
+        in >> sent >> received >> minNs >> maxNs;
+
+        double errNs = std::max(std::fabs(minNs - expectedNs), std::fabs(maxNs - expectedNs));
+        bool pass = ran[i] && sent > 0 && received == sent && errNs <= toleranceNs;
+        if (!pass)
+        {
+            failed++;
+        }
+
+        std::string rate = c.rates[0];
+        std::string delay = c.delays[0];
+        if (c.label == "multihop")
+        {
+            rate = c.rates[0] + "/" + c.rates[1];
+            delay = c.delays[0] + "/" + c.delays[1];
+        }
+        std::cout << std::left << std::setw(9) << c.label << std::setw(16) << rate
+                  << std::setw(12) << delay << std::setw(6) << c.packetSize << std::setw(5)
+                  << c.rates.size() << std::right << std::fixed << std::setprecision(6)
+                  << std::setw(14) << expectedNs / 1e6 << std::setw(14) << maxNs / 1e6
+                  << std::setprecision(0) << std::setw(10) << errNs << "  "
+                  << (pass ? "PASS" : "FAIL");
+        if (!ran[i])
+        {
+            std::cout << " (simulation failed)";
+        }
+        else if (received != sent)
+        {
+            std::cout << " (" << received << "/" << sent << " packets received)";
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << (grid.size() - failed) << "/" << grid.size() << " grid points within "
+              << toleranceNs << " ns of the closed form" << std::endl;
+    return failed > 0 ? 1 : 0;
+}
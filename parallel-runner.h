@@ -0,0 +1,250 @@
+/*
+ * Process-level parallelism for sweeps.
+ *
+ * ns-3's Simulator is a per-process singleton, so independent simulations
+ * cannot share one process. RunParallel() forks one child per job (at most
+ * maxProcs alive at once); the child builds and runs its own simulation and
+ * hands back a text result through a pipe. The parent never touches the
+ * Simulator, which keeps every child starting from a clean state.
+ *
+ * Results come back indexed by job number so callers can merge them in a
+ * deterministic order regardless of completion order.
+ */
+
+#ifndef PARALLEL_RUNNER_H
+#define PARALLEL_RUNNER_H
+
+#include <cerrno>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct ParallelJobResult
+{
+    uint32_t index = 0;
+    bool ok = false;        // child exited with status 0
+    std::string output;     // whatever the job returned
+};
+
+inline uint32_t
+DefaultParallelJobs()
+{
+    uint32_t n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+/*
+ * Runs job(i) for i in [0, nJobs) in forked children.
+ *
+ * onDone is called in the parent as each child finishes; returning false
+ * stops new jobs from being launched (children already running are still
+ * collected). If poll() fails, the running children are killed and reaped
+ * unreported. Only finished jobs appear in the returned vector.
+ */
+inline std::vector<ParallelJobResult>
+RunParallel(uint32_t nJobs,
+            uint32_t maxProcs,
+            const std::function<std::string(uint32_t)> &job,
+            const std::function<bool(const ParallelJobResult &)> &onDone = nullptr)
+{
+    struct Running
+    {
+        pid_t pid;
+        ParallelJobResult result;
+    };
+
+    std::vector<ParallelJobResult> done;
+    std::map<int, Running> running; // keyed by pipe read fd
+    uint32_t next = 0;
+    bool launching = true;
+
+    if (maxProcs == 0)
+    {
+        maxProcs = DefaultParallelJobs();
+    }
+
+    while ((launching && next < nJobs) || !running.empty())
+    {
+        /* ---------- LAUNCH ---------- */
+        while (launching && next < nJobs && running.size() < maxProcs)
+        {
+            int fds[2];
+            if (pipe(fds) != 0)
+            {
+                perror("pipe");
+                launching = false;
+                break;
+            }
+
+            // Anything still buffered would otherwise be printed twice.
+            std::cout.flush();
+            std::cerr.flush();
+            fflush(nullptr);
+
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                perror("fork");
+                close(fds[0]);
+                close(fds[1]);
+                launching = false;
+                break;
+            }
+
+            if (pid == 0)
+            {
+                close(fds[0]);
+                std::string out;
+                try
+                {
+                    out = job(next);
+                }
+                catch (...)
+                {
+                    // Never unwind into the parent's loop from a child
+                    _exit(1);
+                }
+                const char *p = out.data();
+                size_t left = out.size();
+                while (left > 0)
+                {
+                    ssize_t n = write(fds[1], p, left);
+                    if (n < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (n <= 0)
+                    {
+                        _exit(1);
+                    }
+                    p += n;
+                    left -= n;
+                }
+                close(fds[1]);
+                std::cout.flush();
+                fflush(nullptr);
+                _exit(0);
+            }
+
+            close(fds[1]);
+            Running r;
+            r.pid = pid;
+            r.result.index = next;
+            running[fds[0]] = r;
+            next++;
+        }
+
+        if (running.empty())
+        {
+            break;
+        }
+
+        /* ---------- COLLECT ---------- */
+        std::vector<pollfd> pfds;
+        pfds.reserve(running.size());
+        for (auto const &r : running)
+        {
+            pfds.push_back({r.first, POLLIN, 0});
+        }
+
+        if (poll(pfds.data(), pfds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("poll");
+            // Nothing more can be read: kill and reap what is still running
+            // rather than leaving zombies behind.
+            for (auto const &r : running)
+            {
+                kill(r.second.pid, SIGKILL);
+                waitpid(r.second.pid, nullptr, 0);
+                close(r.first);
+            }
+            running.clear();
+            break;
+        }
+
+        for (auto const &pfd : pfds)
+        {
+            if (!(pfd.revents & (POLLIN | POLLHUP | POLLERR)))
+            {
+                continue;
+            }
+
+            Running &r = running[pfd.fd];
+            char buf[65536];
+            ssize_t n = read(pfd.fd, buf, sizeof(buf));
+            if (n > 0)
+            {
+                r.result.output.append(buf, n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+
+            // EOF: the child is done writing.
+            int status = 0;
+            waitpid(r.pid, &status, 0);
+            close(pfd.fd);
+            r.result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+            ParallelJobResult result = r.result;
+            running.erase(pfd.fd);
+
+            if (onDone && !onDone(result))
+            {
+                launching = false;
+            }
+            done.push_back(result);
+        }
+    }
+
+    return done;
+}
+
+/*
+ * Splits "a,b,c" into its items; used for the grid-valued command-line
+ * options of the sweep drivers.
+ */
+inline std::vector<std::string>
+SplitList(const std::string &s, char sep = ',')
+{
+    std::vector<std::string> items;
+    std::string cur;
+    for (char c : s)
+    {
+        if (c == sep)
+        {
+            if (!cur.empty())
+            {
+                items.push_back(cur);
+            }
+            cur.clear();
+        }
+        else if (c != ' ')
+        {
+            cur += c;
+        }
+    }
+    if (!cur.empty())
+    {
+        items.push_back(cur);
+    }
+    return items;
+}
+
+#endif /* PARALLEL_RUNNER_H */
@@ -0,0 +1,318 @@
+/*
+ * Multi-seed replication with Student-t confidence intervals.
+ *
+ * Each replication is one independent RngRun stream executed in its own
+ * process (parallel-runner.h). The parent folds every finished replication
+ * into running mean/variance accumulators and stops launching new ones once
+ * every metric's CI half-width is within the requested fraction of its mean
+ * (after a minimum number of replications), so CPU is only spent until the
+ * requested precision is reached.
+ */
+
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include "parallel-runner.h"
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* ---------- STUDENT-T ---------- */
+
+// Continued fraction for the regularized incomplete beta (Numerical Recipes).
+inline double
+IncompleteBetaCf(double a, double b, double x)
+{
+    const double tiny = 1e-300;
+    double qab = a + b;
+    double qap = a + 1.0;
+    double qam = a - 1.0;
+    double c = 1.0;
+    double d = 1.0 - qab * x / qap;
+    if (std::fabs(d) < tiny)
+    {
+        d = tiny;
+    }
+    d = 1.0 / d;
+    double h = d;
+    for (int m = 1; m <= 300; m++)
+    {
+        int m2 = 2 * m;
+        double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+        d = 1.0 + aa * d;
+        d = std::fabs(d) < tiny ? tiny : d;
+        c = 1.0 + aa / c;
+        c = std::fabs(c) < tiny ? tiny : c;
+        d = 1.0 / d;
+        h *= d * c;
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+        d = 1.0 + aa * d;
+        d = std::fabs(d) < tiny ? tiny : d;
+        c = 1.0 + aa / c;
+        c = std::fabs(c) < tiny ? tiny : c;
+        d = 1.0 / d;
+        double del = d * c;
+        h *= del;
+        if (std::fabs(del - 1.0) < 1e-14)
+        {
+            break;
+        }
+    }
+    return h;
+}
+
+inline double
+RegularizedIncompleteBeta(double a, double b, double x)
+{
+    if (x <= 0.0)
+    {
+        return 0.0;
+    }
+    if (x >= 1.0)
+    {
+        return 1.0;
+    }
+    double lbeta = std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b);
+    double front = std::exp(lbeta + a * std::log(x) + b * std::log(1.0 - x));
+    if (x < (a + 1.0) / (a + b + 2.0))
+    {
+        return front * IncompleteBetaCf(a, b, x) / a;
+    }
+    return 1.0 - front * IncompleteBetaCf(b, a, 1.0 - x) / b;
+}
+
+// P(T <= t) for Student's t with df degrees of freedom.
+inline double
+StudentTCdf(double t, double df)
+{
+    double tail = 0.5 * RegularizedIncompleteBeta(df / 2.0, 0.5, df / (df + t * t));
+    return t >= 0 ? 1.0 - tail : tail;
+}
+
+// Upper quantile: the t with P(T <= t) = p, for p in (0.5, 1).
+inline double
+StudentTQuantile(double p, double df)
+{
+    double lo = 0.0;
+    double hi = 1.0;
+    while (StudentTCdf(hi, df) < p && hi < 1e12)
+    {
+        hi *= 2.0;
+    }
+    for (int i = 0; i < 200 && hi - lo > 1e-12 * hi; i++)
+    {
+        double mid = 0.5 * (lo + hi);
+        if (StudentTCdf(mid, df) < p)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return 0.5 * (lo + hi);
+}
+
+/* ---------- RUNNING STATISTIC ---------- */
+
+// Welford accumulator; numerically stable for many replications.
+struct RunningStat
+{
+    uint32_t n = 0;
+    double mean = 0;
+    double m2 = 0;
+
+    void Add(double x)
+    {
+        n++;
+        double delta = x - mean;
+        mean += delta / n;
+        m2 += delta * (x - mean);
+    }
+
+    double Variance() const
+    {
+        return n > 1 ? m2 / (n - 1) : 0.0;
+    }
+
+    // Half-width of the two-sided confidence interval around the mean.
+    double HalfWidth(double confidence) const
+    {
+        if (n < 2)
+        {
+            return INFINITY;
+        }
+        double t = StudentTQuantile(0.5 + confidence / 2.0, n - 1);
+        return t * std::sqrt(Variance() / n);
+    }
+};
+
+/* ---------- REPLICATION DRIVER ---------- */
+
+struct ReplicationConfig
+{
+    uint32_t maxReplications = 30;
+    uint32_t minReplications = 3;
+    uint32_t firstRun = 1;          // RngRun of replication 0
+    uint32_t jobs = DefaultParallelJobs();
+    double confidence = 0.95;
+    // Stop once halfWidth <= relativePrecision * |mean| for every metric.
+    // 0 disables early stopping.
+    double relativePrecision = 0.05;
+};
+
+inline bool
+ReplicationPrecisionReached(const std::vector<RunningStat> &stats,
+                            const ReplicationConfig &cfg)
+{
+    if (cfg.relativePrecision <= 0 || stats.empty() || stats[0].n < cfg.minReplications)
+    {
+        return false;
+    }
+    for (auto const &s : stats)
+    {
+        double hw = s.HalfWidth(cfg.confidence);
+        if (hw > cfg.relativePrecision * std::fabs(s.mean))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * What one replication hands back to the parent: its metric values and an
+ * optional free-form payload (e.g. serialized latency sketches) that the
+ * parent receives unchanged.
+ */
+struct ReplicationOutput
+{
+    std::vector<double> values;
+    std::string payload;
+};
+
+/*
+ * Runs up to cfg.maxReplications replications of runOne(rngRun), each in
+ * its own process, and returns one accumulator per metric. runOne must
+ * return metrics.size() values in the same order every time. onPayload is
+ * called in the parent with the payload of every successful replication.
+ * Replications still running when the precision target is reached are
+ * added to the result and counted in a note after the run.
+ */
+inline std::vector<RunningStat>
+RunReplications(const ReplicationConfig &cfg,
+                const std::vector<std::string> &metrics,
+                const std::function<ReplicationOutput(uint32_t)> &runOne,
+                const std::function<void(const std::string &)> &onPayload)
+{
+    std::vector<RunningStat> stats(metrics.size());
+    uint32_t failed = 0;
+    uint32_t reachedAt = 0; // replications when the precision target was reached
+    uint32_t late = 0;      // successful replications collected after that
+
+    RunParallel(
+        cfg.maxReplications, cfg.jobs,
+        [&](uint32_t i) {
+            ReplicationOutput result = runOne(cfg.firstRun + i);
+            // First line: metric values; everything after it: the payload
+            std::ostringstream out;
+            out << std::setprecision(17);
+            for (double v : result.values)
+            {
+                out << v << " ";
+            }
+            out << "\n" << result.payload;
+            return out.str();
+        },
+        [&](const ParallelJobResult &r) {
+            size_t eol = r.output.find('\n');
+            std::istringstream in(r.output.substr(0, eol));
+            std::vector<double> values;
+            double v;
+            while (in >> v)
+            {
+                values.push_back(v);
+            }
+            if (!r.ok || eol == std::string::npos || values.size() != metrics.size())
+            {
+                failed++;
+                std::cerr << "Replication " << r.index << " (RngRun "
+                          << cfg.firstRun + r.index << ") failed" << std::endl;
+                return true;
+            }
+            for (size_t m = 0; m < metrics.size(); m++)
+            {
+                stats[m].Add(values[m]);
+            }
+            if (onPayload)
+            {
+                onPayload(r.output.substr(eol + 1));
+            }
+            if (reachedAt > 0)
+            {
+                // Already running when the target was reached; kept, as
+                // every replication is an independent sample.
+                late++;
+                return false;
+            }
+            if (ReplicationPrecisionReached(stats, cfg))
+            {
+                reachedAt = stats[0].n;
+                std::cout << "Precision target reached after " << reachedAt
+                          << " replications" << std::endl;
+                return false;
+            }
+            return true;
+        });
+
+    if (late > 0)
+    {
+        std::cout << late << " replications still running at that point were added ("
+                  << stats[0].n << " in total)" << std::endl;
+    }
+    if (failed > 0)
+    {
+        std::cerr << failed << " replications failed" << std::endl;
+    }
+    return stats;
+}
+
+inline std::vector<RunningStat>
+RunReplications(const ReplicationConfig &cfg,
+                const std::vector<std::string> &metrics,
+                const std::function<std::vector<double>(uint32_t)> &runOne)
+{
+    return RunReplications(
+        cfg, metrics,
+        [&](uint32_t run) { return ReplicationOutput{runOne(run), ""}; },
+        nullptr);
+}
+
+inline void
+PrintReplicationSummary(const ReplicationConfig &cfg,
+                        const std::vector<std::string> &metrics,
+                        const std::vector<RunningStat> &stats)
+{
+    std::cout << "\n=== REPLICATION SUMMARY (" << (stats.empty() ? 0 : stats[0].n)
+              << " runs, " << cfg.confidence * 100 << "% CI) ===\n";
+    for (size_t m = 0; m < metrics.size(); m++)
+    {
+        double hw = stats[m].HalfWidth(cfg.confidence);
+        std::cout << std::left << std::setw(28) << metrics[m] << std::right
+                  << std::setw(14) << stats[m].mean << " +/- " << hw;
+        if (stats[m].mean != 0 && std::isfinite(hw))
+        {
+            std::cout << "  (" << 100.0 * hw / std::fabs(stats[m].mean) << "%)";
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+}
+
+#endif /* REPLICATION_H */
@@ -0,0 +1,452 @@
+/*
+ * Simulator performance benchmark for the repository's scenarios.
+ *
+ * Each benchmark case rebuilds one of our workloads from the shared
+ * helpers at a given scale and simulated duration:
+ *
+ *   dumbbell-tcp  BulkSend flows over the 5p PfifoFast dumbbell (2 * scale clients)
+ *   dumbbell-udp  20Mbps OnOff flows over the same dumbbell     (2 * scale clients)
+ *   red           BulkSend flows over the aqmred RED bottleneck (2 * scale clients)
+ *   spoofing      spoofed floods through an ingress filter      (scale attackers, 1000 pps each)
+ *   multihop      CBR flow over a chain                         (2 * scale links)
+ *
+ * Every case runs in a forked child (parallel-runner.h), which reports
+ *   - wall-clock time of Simulator::Run(),
+ *   - events executed (Simulator::GetEventCount()) and events per second,
+ *   - events scheduled, i.e. executed + cancelled + still pending,
+ *   - peak RSS of the child (getrusage), setup included.
+ *
+ * Every case can be repeated under several event schedulers
+ * (--schedulers=Map,Heap,List,Calendar,PriorityQueue); "auto" first probes
+ * the case for --probeTime simulated seconds under each of them
+ * (scheduler-select.h) and then runs it under the fastest, reported as
+ * auto:<winner>.
+ *
+ * Results are written as CSV (--output). Passing --baseline compares each
+ * case against a previous CSV and exits non-zero when wall time or peak RSS
+ * grew by more than --threshold. Run with --jobs=1 (the default) when the
+ * numbers are meant to be compared.
+ *
+ * Example:
+ *   ./ns3 run "scenario-bench --scales=1,4,16 --durations=10 --output=bench-base.csv"
+ *   ./ns3 run "scenario-bench --scales=1,4,16 --durations=10 --baseline=bench-base.csv"
+ *   ./ns3 run "scenario-bench --scales=16 --schedulers=Map,Heap,List,Calendar,PriorityQueue,auto"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+#include "dumbbell-helper.h"
+#include "ingress-filter.h"
+#include "parallel-runner.h"
+#include "scheduler-select.h"
+#include "spoof-flood-app.h"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ScenarioBench");
+
+static const char *kBenchHeader =
+    "scenario,scale,duration_s,wall_s,events,events_per_s,scheduled,peak_rss_kb,scheduler";
+
+struct BenchCase
+{
+    std::string scenario;
+    uint32_t scale;
+    double duration;
+    std::string scheduler;
+};
+
+/* ---------- SCENARIOS ---------- */
+
+static void
+BuildDumbbellBench(uint32_t scale, double duration, const std::string &variant)
+{
+    DumbbellConfig cfg;
+    cfg.nClients = 2 * scale;
+    Dumbbell d = BuildDumbbell(cfg);
+
+    TrafficControlHelper tch;
+    tch.Uninstall(d.BottleneckDevice());
+    if (variant == "red")
+    {
+        tch.SetRootQueueDisc("ns3::RedQueueDisc",
+                             "MinTh", DoubleValue(2),
+                             "MaxTh", DoubleValue(5),
+                             "MaxSize", QueueSizeValue(QueueSize("20p")),
+                             "LinkBandwidth", StringValue(cfg.bottleneckRate),
+                             "LinkDelay", StringValue(cfg.bottleneckDelay),
+                             "MeanPktSize", UintegerValue(1500),
+                             "Gentle", BooleanValue(true));
+    }
+    else
+    {
+        tch.SetRootQueueDisc("ns3::PfifoFastQueueDisc", "MaxSize", QueueSizeValue(QueueSize("5p")));
+    }
+    tch.Install(d.BottleneckDevice());
+
+    bool udp = (variant == "udp");
+    std::string factory = udp ? "ns3::UdpSocketFactory" : "ns3::TcpSocketFactory";
+    for (uint32_t i = 0; i < cfg.nClients; i++)
+    {
+        uint16_t port = 5000 + i;
+        PacketSinkHelper sink(factory, InetSocketAddress(Ipv4Address::GetAny(), port));
+        sink.Install(d.server.Get(0)).Start(Seconds(0.0));
+
+        ApplicationContainer app;
+        if (udp)
+        {
+            OnOffHelper onoff(factory, Address(InetSocketAddress(d.ServerAddress(), port)));
+            onoff.SetAttribute("DataRate", StringValue("20Mbps"));
+            onoff.SetAttribute("PacketSize", UintegerValue(1024));
+            onoff.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
+            onoff.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0]"));
+            app = onoff.Install(d.clients.Get(i));
+        }
+        else
+        {
+            BulkSendHelper bulk(factory, InetSocketAddress(d.ServerAddress(), port));
+            bulk.SetAttribute("MaxBytes", UintegerValue(0));
+            app = bulk.Install(d.clients.Get(i));
+        }
+        app.Start(Seconds(1.0));
+        app.Stop(Seconds(duration));
+    }
+}
+
+static void
+BuildSpoofingBench(uint32_t scale, double duration)
+{
+    // attackers -> router (ingress filter) -> victim
+    NodeContainer router;
+    router.Create(1);
+    NodeContainer victim;
+    victim.Create(1);
+    NodeContainer attackers;
+    attackers.Create(scale);
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    p2p.SetChannelAttribute("Delay", StringValue("2ms"));
+
+    InternetStackHelper internet;
+    internet.Install(router);
+    internet.Install(victim);
+    internet.Install(attackers);
+
+    Ipv4AddressHelper addr;
+    addr.SetBase("10.2.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer victimIf = addr.Assign(p2p.Install(router.Get(0), victim.Get(0)));
+    addr.SetBase("10.3.0.0", "255.255.255.0");
+    std::vector<NetDeviceContainer> dAttack;
+    for (uint32_t i = 0; i < scale; i++)
+    {
+        dAttack.push_back(p2p.Install(attackers.Get(i), router.Get(0)));
+        addr.Assign(dAttack.back());
+        addr.NewNetwork();
+    }
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    Ptr<IngressFilter> filter = InstallIngressFilter(router.Get(0), true);
+    Ptr<Ipv4> ipv4 = router.Get(0)->GetObject<Ipv4>();
+    for (auto &d : dAttack)
+    {
+        filter->EnableInterface(ipv4->GetInterfaceForDevice(d.Get(1)));
+    }
+
+    PacketSinkHelper sink("ns3::UdpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), 9));
+    sink.Install(victim.Get(0)).Start(Seconds(0.0));
+
+    for (uint32_t i = 0; i < scale; i++)
+    {
+        Ptr<SpoofedFloodApplication> app = CreateObject<SpoofedFloodApplication>();
+        app->SetAttribute("Remote", Ipv4AddressValue(victimIf.GetAddress(1)));
+        app->SetAttribute("PacketRate", DoubleValue(1000));
+        app->SetAttribute("SourceMode", StringValue("random"));
+        app->SetAttribute("SpoofPrefix", Ipv4AddressValue("172.16.0.0"));
+        app->SetAttribute("SpoofPrefixLength", UintegerValue(12));
+        app->SetAttribute("Device", PointerValue(dAttack[i].Get(0)));
+        app->AssignStreams(2 * i);
+        app->SetStartTime(Seconds(1.0));
+        app->SetStopTime(Seconds(duration));
+        attackers.Get(i)->AddApplication(app);
+    }
+}
+
+static void
+BuildMultihopBench(uint32_t scale, double duration)
+{
+    uint32_t links = 2 * scale;
+    NodeContainer nodes;
+    nodes.Create(links + 1);
+
+    InternetStackHelper stack;
+    stack.Install(nodes);
+
+    // Alternating multihop-routing links: 10Mbps/5ms, 5Mbps/10ms, ...
+    Ipv4AddressHelper addr;
+    addr.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer last;
+    for (uint32_t i = 0; i < links; i++)
+    {
+        PointToPointHelper p2p;
+        p2p.SetDeviceAttribute("DataRate", StringValue(i % 2 == 0 ? "10Mbps" : "5Mbps"));
+        p2p.SetChannelAttribute("Delay", StringValue(i % 2 == 0 ? "5ms" : "10ms"));
+        last = addr.Assign(p2p.Install(nodes.Get(i), nodes.Get(i + 1)));
+        addr.NewNetwork();
+    }
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+    uint16_t port = 9;
+    PacketSinkHelper sink("ns3::UdpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), port));
+    sink.Install(nodes.Get(links)).Start(Seconds(0.0));
+
+    OnOffHelper onoff("ns3::UdpSocketFactory", Address(InetSocketAddress(last.GetAddress(1), port)));
+    onoff.SetAttribute("DataRate", StringValue("4Mbps"));
+    onoff.SetAttribute("PacketSize", UintegerValue(1024));
+    onoff.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
+    onoff.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0]"));
+    ApplicationContainer app = onoff.Install(nodes.Get(0));
+    app.Start(Seconds(1.0));
+    app.Stop(Seconds(duration));
+}
+
+static void
+NoOp()
+{
+}
+
+static void
+BuildBenchCase(const BenchCase &c)
+{
+    if (c.scenario == "dumbbell-tcp")
+        BuildDumbbellBench(c.scale, c.duration, "tcp");
+    else if (c.scenario == "dumbbell-udp")
+        BuildDumbbellBench(c.scale, c.duration, "udp");
+    else if (c.scenario == "red")
+        BuildDumbbellBench(c.scale, c.duration, "red");
+    else if (c.scenario == "spoofing")
+        BuildSpoofingBench(c.scale, c.duration);
+    else if (c.scenario == "multihop")
+        BuildMultihopBench(c.scale, c.duration);
+    else
+        NS_FATAL_ERROR("Unknown scenario " << c.scenario);
+}
+
+// Runs one case in the current (child) process; returns the CSV row.
+static std::string
+RunBenchCase(const BenchCase &c, double probeTime)
+{
+    std::string scheduler = c.scheduler;
+    if (scheduler == "auto")
+    {
+        scheduler = SelectScheduler(SplitList(kSchedulerNames), std::min(probeTime, c.duration),
+                                    [&c]() {
+                                        BuildBenchCase(c);
+                                        Simulator::Stop(Seconds(c.duration));
+                                        Simulator::Run();
+                                        Simulator::Destroy();
+                                    },
+                                    false);
+        scheduler = "auto:" + scheduler;
+    }
+    UseScheduler(scheduler.substr(scheduler.find(':') + 1));
+    BuildBenchCase(c);
+
+    Simulator::Stop(Seconds(c.duration));
+    auto wallStart = std::chrono::steady_clock::now();
+    Simulator::Run();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    uint64_t events = Simulator::GetEventCount();
+    // Event uids are handed out sequentially from EventId::UID::VALID, so
+    // the uid of one more event is the number of events ever scheduled.
+    EventId probe = Simulator::Schedule(Seconds(0), &NoOp);
+    uint64_t scheduled = probe.GetUid() - EventId::UID::VALID;
+    Simulator::Cancel(probe);
+    Simulator::Destroy();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::ostringstream row;
+    row << c.scenario << "," << c.scale << "," << c.duration << "," << wall << "," << events
+        << "," << (wall > 0 ? events / wall : 0) << "," << scheduled << "," << usage.ru_maxrss << ","
+        << scheduler;
+    return row.str();
+}
+
+/* ---------- BASELINE ---------- */
+
+struct BenchRow
+{
+    double wall = 0;
+    double eventsPerSec = 0;
+    uint64_t rssKb = 0;
+};
+
+// Baselines written before the scheduler column ran on the default (Map)
+static std::string
+BenchKey(const std::vector<std::string> &fields)
+{
+    // auto:<winner> rows compare against the baseline's auto row, whatever it picked
+    std::string scheduler = fields.size() > 8 ? fields[8].substr(0, fields[8].find(':')) : "Map";
+    return fields[0] + "," + fields[1] + "," + fields[2] + "," + scheduler;
+}
+
+static BenchRow
+ParseBenchRow(const std::vector<std::string> &fields)
+{
+    BenchRow r;
+    r.wall = std::stod(fields[3]);
+    r.eventsPerSec = std::stod(fields[5]);
+    r.rssKb = std::stoull(fields[7]);
+    return r;
+}
+
+static std::map<std::string, BenchRow>
+LoadBaseline(const std::string &fileName)
+{
+    std::map<std::string, BenchRow> rows;
+    std::ifstream in(fileName);
+    if (!in)
+    {
+        NS_FATAL_ERROR("Cannot open baseline " << fileName);
+    }
+    std::string line;
+    std::getline(in, line); // header
+    while (std::getline(in, line))
+    {
+        std::vector<std::string> fields = SplitList(line);
+        if (fields.size() == 8 || fields.size() == 9)
+        {
+            rows[BenchKey(fields)] = ParseBenchRow(fields);
+        }
+    }
+    return rows;
+}
+
+int main(int argc, char *argv[])
+{
+    // --- 1. CONFIGURATION ---
+    std::string scenarios = "dumbbell-tcp,dumbbell-udp,red,spoofing,multihop";
+    std::string scales = "1,4,16";
+    std::string durations = "10";
+    std::string output = "scenario-bench.csv";
+    std::string baseline = "";
+    double threshold = 0.2;
+    uint32_t jobs = 1;
+    std::string schedulers = "Map";
+    double probeTime = 2.0;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("scenarios", "Comma-separated scenarios to run", scenarios);
+    cmd.AddValue("scales", "Comma-separated scale factors (flows / nodes / attackers)", scales);
+    cmd.AddValue("durations", "Comma-separated simulated durations in seconds", durations);
+    cmd.AddValue("output", "CSV file for this run (usable as a later baseline)", output);
+    cmd.AddValue("baseline", "CSV from an earlier run to compare against", baseline);
+    cmd.AddValue("threshold", "Allowed relative growth of wall time and peak RSS", threshold);
+    cmd.AddValue("jobs", "Cases run concurrently (1 for comparable timings)", jobs);
+    cmd.AddValue("schedulers", "Comma-separated event schedulers (Map, Heap, List, Calendar, PriorityQueue, auto)",
+                 schedulers);
+    cmd.AddValue("probeTime", "Simulated seconds of each auto-selection probe", probeTime);
+    cmd.Parse(argc, argv);
+
+    // --- 2. GRID ---
+    std::vector<BenchCase> grid;
+    for (auto const &s : SplitList(scenarios))
+    {
+        for (auto const &sc : SplitList(scales))
+        {
+            for (auto const &du : SplitList(durations))
+            {
+                for (auto const &sched : SplitList(schedulers))
+                {
+                    grid.push_back({s, static_cast<uint32_t>(std::stoul(sc)), std::stod(du), sched});
+                }
+            }
+        }
+    }
+
+    // --- 3. RUN ---
+    std::vector<ParallelJobResult> results = RunParallel(
+        grid.size(), jobs,
+        [&](uint32_t i) { return RunBenchCase(grid[i], probeTime); },
+        [&](const ParallelJobResult &r) {
+            std::cout << (r.ok ? r.output : grid[r.index].scenario + " FAILED") << std::endl;
+            return true;
+        });
+
+    std::vector<std::string> rows(grid.size());
+    uint32_t failed = 0;
+    for (auto const &r : results)
+    {
+        if (r.ok)
+            rows[r.index] = r.output;
+        else
+            failed++;
+    }
+
+    std::ofstream csv(output);
+    csv << kBenchHeader << "\n";
+    for (auto const &row : rows)
+    {
+        if (!row.empty())
+        {
+            csv << row << "\n";
+        }
+    }
+    csv.close();
+    std::cout << "Wrote " << output << std::endl;
+
+    // --- 4. COMPARE ---
+    uint32_t regressions = 0;
+    if (!baseline.empty())
+    {
+        std::map<std::string, BenchRow> base = LoadBaseline(baseline);
+        std::cout << std::left << std::setw(36) << "case" << std::right << std::setw(10)
+                  << "wall" << std::setw(12) << "events/s" << std::setw(10) << "rss"
+                  << "  (ratio to baseline)\n";
+        for (auto const &row : rows)
+        {
+            if (row.empty())
+            {
+                continue;
+            }
+            std::vector<std::string> fields = SplitList(row);
+            auto it = base.find(BenchKey(fields));
+            if (it == base.end())
+            {
+                std::cout << std::left << std::setw(36) << BenchKey(fields) << " not in baseline\n";
+                continue;
+            }
+            BenchRow now = ParseBenchRow(fields);
+            double wallRatio = it->second.wall > 0 ? now.wall / it->second.wall : 1;
+            double rateRatio = it->second.eventsPerSec > 0 ? now.eventsPerSec / it->second.eventsPerSec : 1;
+            double rssRatio = it->second.rssKb > 0 ? double(now.rssKb) / it->second.rssKb : 1;
+            bool regressed = wallRatio > 1 + threshold || rssRatio > 1 + threshold;
+            if (regressed)
+            {
+                regressions++;
+            }
+            std::cout << std::left << std::setw(36) << BenchKey(fields) << std::right
+                      << std::fixed << std::setprecision(2) << std::setw(10) << wallRatio
+                      << std::setw(12) << rateRatio << std::setw(10) << rssRatio
+                      << (regressed ? "  REGRESSION" : "") << "\n";
+        }
+        std::cout << regressions << " regressions above " << threshold * 100 << "%" << std::endl;
+    }
+
+    return (failed > 0 || regressions > 0) ? 1 : 0;
+}
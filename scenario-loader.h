@@ -0,0 +1,606 @@
+/*
+ * Builds a simulation from a declarative scenario file.
+ *
+ * A scenario is a list of directives, one per line ('#' starts a comment).
+ * Lower-case key=value words are interpreted by the loader; words whose key
+ * starts with an upper-case letter are passed unchanged to the ns-3
+ * attribute system as strings, so any attribute of the created object can
+ * be set without the loader knowing about it.
+ *
+ *   set <var> <value>                 default for ${var} (overridable from the CLI)
+ *   config <ns3 path>=<value>         Config::SetDefault
+ *   rng run=<n> [seed=<n>]
+ *   stop <seconds>
+ *   node <name> [count]               count > 1 creates name0 .. name<count-1>
+ *   link <a> <b> [rate=] [delay=] [queue=] [Attr=...]
+ *   qdisc <node> <peer> <type|none> [Attr=...]
+ *   app <type|bulk|onoff|sink|echo-server|echo-client|flood> on=<node>
+ *       [to=<node>:<port>] [listen=<port>] [start=] [stop=] [Attr=...]
+ *   trace flowmon [file=<xml>]
+ *   trace drops node=<n> peer=<p> file=<droplog>
+ *   trace packets file=<pkt> [events=] [sample=]
+ *   trace pcap prefix=<prefix>
+ *
+ * "name*" in a node position expands to every node of group "name". Each
+ * link gets the next /24 starting at 10.1.1.0, in file order, so the
+ * dumbbell examples keep the addressing of dumbbell-helper.h. Routes come
+ * from Ipv4GlobalRoutingHelper.
+ *
+ * Errors are reported with file:line and abort, like every other
+ * configuration error in these programs.
+ */
+
+#ifndef SCENARIO_LOADER_H
+#define SCENARIO_LOADER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/flow-monitor-module.h"
+
+#include "binary-trace.h"
+#include "drop-logger.h"
+#include "parallel-runner.h"
+#include "spoof-flood-app.h"
+
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct ScenarioDirective
+{
+    std::string where; // file:line
+    std::vector<std::string> words;                          // positional words
+    std::map<std::string, std::string> keys;                 // loader keys
+    std::vector<std::pair<std::string, std::string>> attrs;  // ns-3 attributes
+
+    std::string Key(const std::string &k, const std::string &def = "") const
+    {
+        auto it = keys.find(k);
+        return it == keys.end() ? def : it->second;
+    }
+};
+
+class ScenarioLoader
+{
+  public:
+    // Overrides "set" defaults; call before Load.
+    void SetVariable(const std::string &name, const std::string &value)
+    {
+        m_overrides[name] = value;
+        m_vars[name] = value;
+    }
+
+    void Load(const std::string &fileName)
+    {
+        std::ifstream in(fileName);
+        if (!in)
+        {
+            NS_FATAL_ERROR("Cannot open scenario " << fileName);
+        }
+        std::string line;
+        uint32_t lineNo = 0;
+        while (std::getline(in, line))
+        {
+            lineNo++;
+            size_t hash = line.find('#');
+            if (hash != std::string::npos)
+            {
+                line.erase(hash);
+            }
+            std::istringstream words(line);
+            ScenarioDirective d;
+            d.where = fileName + ":" + std::to_string(lineNo);
+            std::string w;
+            while (words >> w)
+            {
+                w = Expand(w, d.where);
+                size_t eq = w.find('=');
+                if (eq == std::string::npos || d.words.empty() || d.words[0] == "config")
+                {
+                    d.words.push_back(w);
+                }
+                else if (std::isupper(static_cast<unsigned char>(w[0])))
+                {
+                    d.attrs.emplace_back(w.substr(0, eq), w.substr(eq + 1));
+                }
+                else
+                {
+                    d.keys[w.substr(0, eq)] = w.substr(eq + 1);
+                }
+            }
+            if (d.words.empty())
+            {
+                continue;
+            }
+            if (d.words[0] == "set")
+            {
+                Require(d, 3);
+                if (!m_overrides.count(d.words[1]))
+                {
+                    m_vars[d.words[1]] = d.words[2];
+                }
+                continue;
+            }
+            m_directives.push_back(d);
+        }
+    }
+
+    /*
+     * Creates everything, in phases so the file order of directives of
+     * different kinds does not matter: defaults, nodes, links, stack and
+     * addresses, queue discs, applications, traces.
+     */
+    void Build()
+    {
+        using namespace ns3;
+
+        for (auto const &d : Of("config"))
+        {
+            for (size_t i = 1; i < d.words.size(); i++)
+            {
+                size_t eq = d.words[i].find('=');
+                if (eq == std::string::npos)
+                {
+                    NS_FATAL_ERROR(d.where << ": config expects <path>=<value>");
+                }
+                Config::SetDefault(d.words[i].substr(0, eq), StringValue(d.words[i].substr(eq + 1)));
+            }
+        }
+        for (auto const &d : Of("rng"))
+        {
+            RngSeedManager::SetRun(std::stoul(d.Key("run", "1")));
+            RngSeedManager::SetSeed(std::stoul(d.Key("seed", "1")));
+        }
+        for (auto const &d : Of("stop"))
+        {
+            Require(d, 2);
+            m_stopTime = std::stod(d.words[1]);
+        }
+
+        BuildNodes();
+        BuildLinks();
+        BuildQueueDiscs();
+        BuildApplications();
+        BuildTraces();
+    }
+
+    double GetStopTime() const
+    {
+        return m_stopTime;
+    }
+
+    ns3::Ptr<ns3::Node> GetNode(const std::string &name) const
+    {
+        auto it = m_nodes.find(name);
+        return it == m_nodes.end() ? nullptr : it->second;
+    }
+
+    uint32_t GetNNodes() const
+    {
+        return m_nodes.size();
+    }
+
+    /* ---------- RESULTS ---------- */
+
+    // Call after Simulator::Run() and before Simulator::Destroy().
+    void Report(std::ostream &os)
+    {
+        using namespace ns3;
+
+        for (auto const &s : m_sinks)
+        {
+            double active = m_stopTime - s.start;
+            os << "sink " << s.label << ": " << s.sink->GetTotalRx() << " bytes, "
+               << (active > 0 ? s.sink->GetTotalRx() * 8.0 / active / 1e6 : 0) << " Mbps\n";
+        }
+        for (auto const &q : m_qdiscs)
+        {
+            const QueueDisc::Stats &st = q.second->GetStats();
+            os << "qdisc " << q.first << ": " << st.nTotalReceivedPackets << " enqueued, "
+               << st.nTotalDroppedPackets << " dropped, " << st.nTotalMarkedPackets << " marked\n";
+        }
+        if (m_dropLogger)
+        {
+            m_dropLogger->Close();
+            os << "drop log: " << m_dropLogger->GetTotalDrops() << " drops\n";
+        }
+        if (m_packetTrace)
+        {
+            m_packetTrace->Close();
+            os << "packet trace: " << m_packetTrace->GetRecordCount() << " records\n";
+        }
+        if (m_monitor)
+        {
+            m_monitor->CheckForLostPackets();
+            Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(m_flowmon.GetClassifier());
+            for (auto const &flow : m_monitor->GetFlowStats())
+            {
+                Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+                const FlowMonitor::FlowStats &st = flow.second;
+                os << "flow " << flow.first << " " << t.sourceAddress << ":" << t.sourcePort
+                   << " -> " << t.destinationAddress << ":" << t.destinationPort << " proto "
+                   << unsigned(t.protocol) << ": tx " << st.txPackets << ", rx " << st.rxPackets
+                   << ", lost " << st.lostPackets << ", mean delay "
+                   << (st.rxPackets > 0 ? st.delaySum.GetSeconds() / st.rxPackets * 1e3 : 0)
+                   << " ms\n";
+            }
+            if (!m_flowmonFile.empty())
+            {
+                m_monitor->SerializeToXmlFile(m_flowmonFile, true, true);
+            }
+        }
+    }
+
+  private:
+    struct SinkEntry
+    {
+        std::string label;
+        ns3::Ptr<ns3::PacketSink> sink;
+        double start;
+    };
+
+    /* ---------- PARSING ---------- */
+
+    std::string Expand(const std::string &w, const std::string &where) const
+    {
+        std::string out;
+        size_t i = 0;
+        while (i < w.size())
+        {
+            if (w.compare(i, 2, "${") == 0)
+            {
+                size_t end = w.find('}', i);
+                if (end == std::string::npos)
+                {
+                    NS_FATAL_ERROR(where << ": unterminated ${");
+                }
+                std::string name = w.substr(i + 2, end - i - 2);
+                auto it = m_vars.find(name);
+                if (it == m_vars.end())
+                {
+                    NS_FATAL_ERROR(where << ": undefined variable " << name);
+                }
+                out += it->second;
+                i = end + 1;
+            }
+            else
+            {
+                out += w[i++];
+            }
+        }
+        return out;
+    }
+
+    static void Require(const ScenarioDirective &d, size_t nWords)
+    {
+        if (d.words.size() < nWords)
+        {
+            NS_FATAL_ERROR(d.where << ": '" << d.words[0] << "' needs " << nWords - 1 << " arguments");
+        }
+    }
+
+    std::vector<ScenarioDirective> Of(const std::string &kind) const
+    {
+        std::vector<ScenarioDirective> out;
+        for (auto const &d : m_directives)
+        {
+            if (d.words[0] == kind)
+            {
+                out.push_back(d);
+            }
+        }
+        return out;
+    }
+
+    // "name*" -> every member of group name; otherwise the node itself.
+    std::vector<std::string> Resolve(const std::string &name, const std::string &where) const
+    {
+        if (!name.empty() && name.back() == '*')
+        {
+            auto it = m_groups.find(name.substr(0, name.size() - 1));
+            if (it == m_groups.end())
+            {
+                NS_FATAL_ERROR(where << ": unknown node group " << name);
+            }
+            return it->second;
+        }
+        if (!m_nodes.count(name))
+        {
+            NS_FATAL_ERROR(where << ": unknown node " << name);
+        }
+        return {name};
+    }
+
+    static void ApplyAttributes(ns3::Ptr<ns3::Object> obj, const ScenarioDirective &d)
+    {
+        for (auto const &a : d.attrs)
+        {
+            if (!obj->SetAttributeFailSafe(a.first, ns3::StringValue(a.second)))
+            {
+                NS_FATAL_ERROR(d.where << ": " << obj->GetInstanceTypeId().GetName()
+                                       << " has no attribute " << a.first << "=" << a.second);
+            }
+        }
+    }
+
+    /* ---------- PHASES ---------- */
+
+    void BuildNodes()
+    {
+        for (auto const &d : Of("node"))
+        {
+            Require(d, 2);
+            uint32_t count = d.words.size() > 2 ? std::stoul(d.words[2]) : 1;
+            std::vector<std::string> &group = m_groups[d.words[1]];
+            for (uint32_t i = 0; i < count; i++)
+            {
+                std::string name = count > 1 ? d.words[1] + std::to_string(i) : d.words[1];
+                if (m_nodes.count(name))
+                {
+                    NS_FATAL_ERROR(d.where << ": node " << name << " already exists");
+                }
+                m_nodes[name] = ns3::CreateObject<ns3::Node>();
+                m_allNodes.Add(m_nodes[name]);
+                group.push_back(name);
+            }
+        }
+    }
+
+    void BuildLinks()
+    {
+        using namespace ns3;
+
+        std::vector<NetDeviceContainer> links;
+        for (auto const &d : Of("link"))
+        {
+            Require(d, 3);
+            PointToPointHelper p2p;
+            p2p.SetDeviceAttribute("DataRate", StringValue(d.Key("rate", "10Mbps")));
+            p2p.SetChannelAttribute("Delay", StringValue(d.Key("delay", "2ms")));
+            if (!d.Key("queue").empty())
+            {
+                p2p.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", QueueSizeValue(QueueSize(d.Key("queue"))));
+            }
+            for (auto const &a : d.attrs)
+            {
+                p2p.SetDeviceAttribute(a.first, StringValue(a.second));
+            }
+
+            for (auto const &a : Resolve(d.words[1], d.where))
+            {
+                for (auto const &b : Resolve(d.words[2], d.where))
+                {
+                    NetDeviceContainer devs = p2p.Install(m_nodes[a], m_nodes[b]);
+                    m_devices[a + ":" + b] = devs.Get(0);
+                    m_devices[b + ":" + a] = devs.Get(1);
+                    m_allDevices.Add(devs);
+                    links.push_back(devs);
+                }
+            }
+        }
+
+        InternetStackHelper stack;
+        stack.Install(m_allNodes);
+
+        Ipv4AddressHelper addr;
+        addr.SetBase("10.1.1.0", "255.255.255.0");
+        for (auto const &devs : links)
+        {
+            addr.Assign(devs);
+            addr.NewNetwork();
+        }
+        Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    }
+
+    ns3::Ptr<ns3::NetDevice> Device(const std::string &node, const std::string &peer,
+                                    const std::string &where) const
+    {
+        auto it = m_devices.find(node + ":" + peer);
+        if (it == m_devices.end())
+        {
+            NS_FATAL_ERROR(where << ": no link " << node << " - " << peer);
+        }
+        return it->second;
+    }
+
+    void BuildQueueDiscs()
+    {
+        using namespace ns3;
+
+        for (auto const &d : Of("qdisc"))
+        {
+            Require(d, 4);
+            for (auto const &a : Resolve(d.words[1], d.where))
+            {
+                for (auto const &b : Resolve(d.words[2], d.where))
+                {
+                    Ptr<NetDevice> dev = Device(a, b, d.where);
+                    TrafficControlHelper tch;
+                    tch.Uninstall(dev);
+                    if (d.words[3] == "none")
+                    {
+                        continue;
+                    }
+                    tch.SetRootQueueDisc(d.words[3]);
+                    Ptr<QueueDisc> qd = tch.Install(dev).Get(0);
+                    ApplyAttributes(qd, d);
+                    m_qdiscs.emplace_back(a + "->" + b, qd);
+                }
+            }
+        }
+    }
+
+    ns3::Ipv4Address NodeAddress(const std::string &name) const
+    {
+        // Interface 0 is loopback; the first link's address identifies the node.
+        return m_nodes.at(name)->GetObject<ns3::Ipv4>()->GetAddress(1, 0).GetLocal();
+    }
+
+    void BuildApplications()
+    {
+        using namespace ns3;
+
+        static const std::map<std::string, std::string> aliases = {
+            {"bulk", "ns3::BulkSendApplication"},
+            {"onoff", "ns3::OnOffApplication"},
+            {"sink", "ns3::PacketSink"},
+            {"echo-server", "ns3::UdpEchoServer"},
+            {"echo-client", "ns3::UdpEchoClient"},
+            {"flood", "ns3::SpoofedFloodApplication"},
+        };
+
+        for (auto const &d : Of("app"))
+        {
+            Require(d, 2);
+            std::string type = aliases.count(d.words[1]) ? aliases.at(d.words[1]) : d.words[1];
+            double start = std::stod(d.Key("start", "0"));
+            double stop = std::stod(d.Key("stop", std::to_string(m_stopTime)));
+
+            for (auto const &name : Resolve(d.Key("on"), d.where))
+            {
+                ObjectFactory factory;
+                factory.SetTypeId(type);
+                Ptr<Application> app = factory.Create<Application>();
+                ApplyAttributes(app, d);
+                SetEndpoints(app, d);
+                app->SetStartTime(Seconds(start));
+                app->SetStopTime(Seconds(stop));
+                m_nodes[name]->AddApplication(app);
+
+                Ptr<PacketSink> sink = DynamicCast<PacketSink>(app);
+                if (sink)
+                {
+                    m_sinks.push_back({name + ":" + d.Key("listen"), sink, start});
+                }
+            }
+        }
+    }
+
+    // to=<node>:<port> sets Remote (and RemotePort where the app has one),
+    // listen=<port> sets Local (sinks) or Port (echo server).
+    void SetEndpoints(ns3::Ptr<ns3::Application> app, const ScenarioDirective &d) const
+    {
+        using namespace ns3;
+
+        TypeId tid = app->GetInstanceTypeId();
+        struct TypeId::AttributeInformation info;
+
+        std::string to = d.Key("to");
+        if (!to.empty())
+        {
+            size_t colon = to.rfind(':');
+            if (colon == std::string::npos)
+            {
+                NS_FATAL_ERROR(d.where << ": to= expects <node>:<port>");
+            }
+            Ipv4Address remote = NodeAddress(Resolve(to.substr(0, colon), d.where).at(0));
+            uint16_t port = std::stoul(to.substr(colon + 1));
+
+            if (tid.LookupAttributeByName("RemoteAddress", &info))
+            {
+                // Echo client: address and port are separate attributes
+                app->SetAttribute("RemoteAddress", AddressValue(remote));
+                app->SetAttribute("RemotePort", UintegerValue(port));
+            }
+            else if (tid.LookupAttributeByName("RemotePort", &info))
+            {
+                // SpoofedFloodApplication: Ipv4Address + port
+                app->SetAttribute("Remote", Ipv4AddressValue(remote));
+                app->SetAttribute("RemotePort", UintegerValue(port));
+            }
+            else
+            {
+                app->SetAttribute("Remote", AddressValue(InetSocketAddress(remote, port)));
+            }
+        }
+
+        std::string listen = d.Key("listen");
+        if (!listen.empty())
+        {
+            uint16_t port = std::stoul(listen);
+            if (tid.LookupAttributeByName("Local", &info))
+            {
+                app->SetAttribute("Local", AddressValue(InetSocketAddress(Ipv4Address::GetAny(), port)));
+            }
+            else
+            {
+                app->SetAttribute("Port", UintegerValue(port));
+            }
+        }
+    }
+
+    void BuildTraces()
+    {
+        using namespace ns3;
+
+        for (auto const &d : Of("trace"))
+        {
+            Require(d, 2);
+            const std::string &kind = d.words[1];
+            if (kind == "flowmon")
+            {
+                m_monitor = m_flowmon.InstallAll();
+                m_flowmonFile = d.Key("file");
+            }
+            else if (kind == "drops")
+            {
+                Ptr<NetDevice> dev = Device(d.Key("node"), d.Key("peer"), d.where);
+                Ptr<QueueDisc> qd =
+                    dev->GetNode()->GetObject<TrafficControlLayer>()->GetRootQueueDiscOnDevice(dev);
+                if (!qd)
+                {
+                    NS_FATAL_ERROR(d.where << ": no queue disc on " << d.Key("node") << " -> " << d.Key("peer"));
+                }
+                m_dropLogger.reset(new DropLogger(d.Key("file", "scenario.droplog")));
+                m_dropLogger->Attach(qd);
+            }
+            else if (kind == "packets")
+            {
+                m_packetTrace.reset(new BinaryTraceSink(d.Key("file", "scenario.pkt")));
+                m_packetTrace->SetEventMask(ParseTraceEvents(d.Key("events", "all")));
+                m_packetTrace->SetSampling(std::stoul(d.Key("sample", "1")));
+                m_packetTrace->Attach(m_allDevices);
+            }
+            else if (kind == "pcap")
+            {
+                PointToPointHelper p2p;
+                p2p.EnablePcap(d.Key("prefix", "scenario"), m_allDevices, true);
+            }
+            else
+            {
+                NS_FATAL_ERROR(d.where << ": unknown trace " << kind);
+            }
+        }
+    }
+
+    std::map<std::string, std::string> m_vars;
+    std::map<std::string, std::string> m_overrides;
+    std::vector<ScenarioDirective> m_directives;
+    double m_stopTime = 10.0;
+
+    std::map<std::string, ns3::Ptr<ns3::Node>> m_nodes;
+    std::map<std::string, std::vector<std::string>> m_groups;
+    ns3::NodeContainer m_allNodes;
+    std::map<std::string, ns3::Ptr<ns3::NetDevice>> m_devices; // "node:peer"
+    ns3::NetDeviceContainer m_allDevices;
+
+    std::vector<std::pair<std::string, ns3::Ptr<ns3::QueueDisc>>> m_qdiscs;
+    std::vector<SinkEntry> m_sinks;
+
+    ns3::FlowMonitorHelper m_flowmon;
+    ns3::Ptr<ns3::FlowMonitor> m_monitor;
+    std::string m_flowmonFile;
+    std::unique_ptr<DropLogger> m_dropLogger;
+    std::unique_ptr<BinaryTraceSink> m_packetTrace;
+};
+
+#endif /* SCENARIO_LOADER_H */
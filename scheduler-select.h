@@ -0,0 +1,136 @@
+/*
+ * Event scheduler selection.
+ *
+ * ns-3 ships five interchangeable event schedulers (Map, the default, Heap,
+ * List, Calendar and PriorityQueue) whose cost depends on the event profile:
+ * a handful of long-lived timers, millions of near-future per-packet
+ * events, or a deep queue of far-future ones. UseScheduler() switches the
+ * simulator to one of them; SelectScheduler() runs a short probe of a
+ * scenario under every candidate, each in its own forked process
+ * (parallel-runner.h, one at a time so the timings are comparable), and
+ * returns the one that executed the most events per wall-clock second.
+ *
+ * The probe only times the simulation itself: wall time from the first
+ * event to the probe horizon, where it stops the scenario early.
+ */
+
+#ifndef SCHEDULER_SELECT_H
+#define SCHEDULER_SELECT_H
+
+#include "parallel-runner.h"
+
+#include "ns3/core-module.h"
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const char *kSchedulerNames = "Map,Heap,List,Calendar,PriorityQueue";
+
+// Accepts "Heap" or "ns3::HeapScheduler"
+inline std::string
+SchedulerTypeName(const std::string &name)
+{
+    if (name.find("::") != std::string::npos)
+    {
+        return name;
+    }
+    return "ns3::" + name + "Scheduler";
+}
+
+// Call before any event is scheduled (pending events are moved otherwise)
+inline void
+UseScheduler(const std::string &name)
+{
+    ns3::ObjectFactory factory;
+    factory.SetTypeId(SchedulerTypeName(name));
+    ns3::Simulator::SetScheduler(factory);
+}
+
+/* ---------- PROBE ---------- */
+
+struct SchedulerProbe
+{
+    std::chrono::steady_clock::time_point start;
+    double wall = 0;
+    uint64_t events = 0;
+};
+
+inline void
+SchedulerProbeStart(SchedulerProbe *p)
+{
+    p->start = std::chrono::steady_clock::now();
+}
+
+inline void
+SchedulerProbeEnd(SchedulerProbe *p)
+{
+    p->wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - p->start).count();
+    p->events = ns3::Simulator::GetEventCount();
+    ns3::Simulator::Stop();
+}
+
+/*
+ * Runs scenario() (which builds, runs and destroys its simulation) for
+ * probeTime simulated seconds under each candidate and returns the fastest.
+ * Candidates that fail are skipped; with none left, "Map" is returned.
+ */
+inline std::string
+SelectScheduler(const std::vector<std::string> &candidates, double probeTime,
+                const std::function<void()> &scenario, bool verbose = true)
+{
+    std::vector<double> rate(candidates.size(), -1);
+    RunParallel(
+        candidates.size(), 1,
+        [&](uint32_t i) {
+            // The scenario's own report is noise here
+            std::cout.setstate(std::ios::badbit);
+            static SchedulerProbe probe;
+            UseScheduler(candidates[i]);
+            ns3::Simulator::Schedule(ns3::Seconds(0), &SchedulerProbeStart, &probe);
+            ns3::Simulator::Schedule(ns3::Seconds(probeTime), &SchedulerProbeEnd, &probe);
+            scenario();
+            std::ostringstream out;
+            out << std::setprecision(17) << probe.events << " " << probe.wall;
+            return out.str();
+        },
+        [&](const ParallelJobResult &r) {
+            std::istringstream in(r.output);
+            uint64_t events = 0;
+            double wall = 0;
+            if (r.ok && (in >> events >> wall) && wall > 0)
+            {
+                rate[r.index] = events / wall;
+            }
+            return true;
+        });
+
+    size_t best = candidates.size();
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        if (rate[i] > 0 && (best == candidates.size() || rate[i] > rate[best]))
+        {
+            best = i;
+        }
+    }
+    if (verbose)
+    {
+        std::cout << "Scheduler probe (" << probeTime << " s simulated):";
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            std::cout << " " << candidates[i] << "=";
+            if (rate[i] > 0)
+                std::cout << std::fixed << std::setprecision(0) << rate[i] << std::defaultfloat;
+            else
+                std::cout << "failed";
+        }
+        std::cout << " events/s -> " << (best < candidates.size() ? candidates[best] : "Map") << std::endl;
+    }
+    return best < candidates.size() ? candidates[best] : "Map";
+}
+
+#endif /* SCHEDULER_SELECT_H */
@@ -0,0 +1,579 @@
+/*
+ * Shared-table routing for large static topologies.
+ *
+ * Ipv4GlobalRoutingHelper::PopulateRoutingTables() runs an SPF on every
+ * node and stores a route per destination network in every node, so both
+ * setup time and memory grow with nodes x links. SharedRoutingTable instead
+ * keeps one copy of the graph (node -> links, address -> node) for the
+ * whole simulation, and per destination node a hop-count vector from a
+ * single BFS. Every node's SharedTableRouting points at the same table and
+ * forwards to a neighbour one hop closer to the destination, so a node
+ * costs a pointer, and a destination costs 2 bytes per node, computed once
+ * for all nodes together - up front with Precompute(), or lazily the first
+ * time a packet heads there.
+ *
+ * With FlowEcmp every neighbour one hop closer is a candidate and the flow's
+ * 5-tuple hash (salted per node, so successive hops do not polarise) picks
+ * one: a flow keeps its path, different flows spread over equal-cost paths.
+ * The pick is rendezvous hashing (highest hash of flow and neighbour), so
+ * when a candidate disappears only the flows that used it move.
+ * UDP sockets look their route up before the UDP header is added, so a UDP
+ * sender hashes on addresses and protocol only; routers downstream see the
+ * ports. TCP segments carry their header at lookup time.
+ *
+ * SetLinkState() takes a link down or up and repairs the computed hop
+ * counts incrementally instead of redoing every BFS: a failed link only
+ * matters to the destinations for which its far end loses its last
+ * neighbour one hop closer, and then only to the nodes below it that had
+ * no other such neighbour; a restored link only to the nodes it brings
+ * closer. The routing protocols see the change on their next lookup.
+ *
+ * Scope: unicast over point-to-point (or any channel whose devices all
+ * have IPv4 addresses), hop-count metric, destinations are interface
+ * addresses of nodes in the table. Local delivery is left to
+ * Ipv4ListRouting, which checks it before asking any protocol.
+ */
+
+#ifndef SHARED_ROUTING_H
+#define SHARED_ROUTING_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <deque>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+/* ---------- SHARED TABLE ---------- */
+
+class SharedRoutingTable : public ns3::SimpleRefCount<SharedRoutingTable>
+{
+  public:
+    static constexpr uint16_t kUnreachable = 0xffff;
+
+    struct Link
+    {
+        uint32_t neighbor; // node id
+        uint32_t ifIndex;  // local interface
+        ns3::Ipv4Address gateway;
+        bool up;
+    };
+
+    // Work done by one SetLinkState()
+    struct RepairStats
+    {
+        uint32_t destinations = 0; // whose hop counts changed
+        uint64_t entries = 0;      // hop counts rewritten
+    };
+
+    /*
+     * Reads links and addresses off the nodes' IPv4 interfaces. Call once
+     * every address is assigned.
+     */
+    void Build(const ns3::NodeContainer &nodes)
+    {
+        using namespace ns3;
+
+        for (uint32_t i = 0; i < nodes.GetN(); i++)
+        {
+            Ptr<Node> node = nodes.Get(i);
+            Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+            uint32_t id = node->GetId();
+            if (id >= m_links.size())
+            {
+                m_links.resize(id + 1);
+            }
+            for (uint32_t ifIndex = 1; ifIndex < ipv4->GetNInterfaces(); ifIndex++)
+            {
+                for (uint32_t a = 0; a < ipv4->GetNAddresses(ifIndex); a++)
+                {
+                    m_addrNode[ipv4->GetAddress(ifIndex, a).GetLocal().Get()] = id;
+                }
+                Ptr<NetDevice> dev = ipv4->GetNetDevice(ifIndex);
+                Ptr<Channel> channel = dev->GetChannel();
+                if (!channel)
+                {
+                    continue;
+                }
+                for (std::size_t d = 0; d < channel->GetNDevices(); d++)
+                {
+                    Ptr<NetDevice> peer = channel->GetDevice(d);
+                    Ptr<Ipv4> peerIpv4 = peer->GetNode()->GetObject<Ipv4>();
+                    if (peer == dev || !peerIpv4)
+                    {
+                        continue;
+                    }
+                    int32_t peerIf = peerIpv4->GetInterfaceForDevice(peer);
+                    if (peerIf < 0 || peerIpv4->GetNAddresses(peerIf) == 0)
+                    {
+                        continue;
+                    }
+                    m_links[id].push_back(
+                        {peer->GetNode()->GetId(), ifIndex, peerIpv4->GetAddress(peerIf, 0).GetLocal(), true});
+                }
+            }
+        }
+        m_dist.assign(m_links.size(), std::vector<uint16_t>());
+        m_mark.assign(m_links.size(), 0);
+    }
+
+    // Computes the hop counts towards every listed destination now
+    void Precompute(const ns3::NodeContainer &destinations)
+    {
+        for (uint32_t i = 0; i < destinations.GetN(); i++)
+        {
+            Distances(destinations.Get(i)->GetId());
+        }
+    }
+
+    // Node owning addr, or -1
+    int64_t FindNode(ns3::Ipv4Address addr) const
+    {
+        auto it = m_addrNode.find(addr.Get());
+        return it == m_addrNode.end() ? -1 : int64_t(it->second);
+    }
+
+    /*
+     * Link out of node towards dst, or nullptr if dst is unreachable. Of
+     * several equal-cost links, hash picks one (hash 0: always the first).
+     */
+    const Link *NextHop(uint32_t node, uint32_t dst, uint32_t hash = 0)
+    {
+        const std::vector<uint16_t> &dist = Distances(dst);
+        if (node >= dist.size() || dist[node] == kUnreachable || dist[node] == 0)
+        {
+            return nullptr;
+        }
+        const Link *best = nullptr;
+        uint32_t bestScore = 0;
+        for (const Link &l : m_links[node])
+        {
+            if (!l.up || dist[l.neighbor] + 1 != dist[node])
+            {
+                continue;
+            }
+            if (hash == 0)
+            {
+                return &l;
+            }
+            uint32_t score = Scramble(hash ^ (l.neighbor * 0x9e3779b9u));
+            if (!best || score > bestScore)
+            {
+                best = &l;
+                bestScore = score;
+            }
+        }
+        return best;
+    }
+
+    /*
+     * Marks every link between nodes a and b up or down and repairs the
+     * hop counts computed so far.
+     */
+    RepairStats SetLinkState(uint32_t a, uint32_t b, bool up)
+    {
+        for (auto ends : {std::make_pair(a, b), std::make_pair(b, a)})
+        {
+            for (Link &l : m_links[ends.first])
+            {
+                if (l.neighbor == ends.second)
+                {
+                    l.up = up;
+                }
+            }
+        }
+        RepairStats stats;
+        for (auto &dist : m_dist)
+        {
+            if (dist.empty())
+            {
+                continue;
+            }
+            uint64_t n = up ? RepairUp(dist, a, b) : RepairDown(dist, a, b);
+            stats.destinations += (n > 0);
+            stats.entries += n;
+        }
+        return stats;
+    }
+
+    // Drops every computed hop count and redoes the BFS for each (the
+    // non-incremental reference)
+    void RecomputeAll()
+    {
+        for (uint32_t dst = 0; dst < m_dist.size(); dst++)
+        {
+            if (!m_dist[dst].empty())
+            {
+                m_dist[dst].clear();
+                m_computed--;
+                Distances(dst);
+            }
+        }
+    }
+
+    // Hop counts held: computed destinations x nodes
+    uint64_t GetNEntries() const { return uint64_t(m_computed) * m_links.size(); }
+
+    const std::vector<Link> &GetLinks(uint32_t node) const { return m_links[node]; }
+
+    uint32_t GetNComputed() const { return m_computed; }
+
+    std::size_t GetMemoryBytes() const
+    {
+        std::size_t bytes = m_links.capacity() * sizeof(std::vector<Link>) +
+                            m_dist.capacity() * sizeof(std::vector<uint16_t>) +
+                            m_addrNode.size() * (sizeof(uint32_t) * 2 + 2 * sizeof(void *)) +
+                            m_addrNode.bucket_count() * sizeof(void *);
+        for (auto const &l : m_links)
+        {
+            bytes += l.capacity() * sizeof(Link);
+        }
+        for (auto const &d : m_dist)
+        {
+            bytes += d.capacity() * sizeof(uint16_t);
+        }
+        return bytes + m_mark.capacity();
+    }
+
+  private:
+    static uint32_t Scramble(uint32_t x)
+    {
+        x ^= x >> 16;
+        x *= 0x85ebca6bu;
+        x ^= x >> 13;
+        x *= 0xc2b2ae35u;
+        return x ^ (x >> 16);
+    }
+
+    // Hop counts from every node to dst, one BFS on first use (links are
+    // symmetric, so distances from dst are distances to it)
+    const std::vector<uint16_t> &Distances(uint32_t dst)
+    {
+        std::vector<uint16_t> &dist = m_dist[dst];
+        if (!dist.empty())
+        {
+            return dist;
+        }
+        dist.assign(m_links.size(), kUnreachable);
+        dist[dst] = 0;
+        std::deque<uint32_t> queue(1, dst);
+        while (!queue.empty())
+        {
+            uint32_t u = queue.front();
+            queue.pop_front();
+            for (const Link &l : m_links[u])
+            {
+                if (l.up && dist[l.neighbor] == kUnreachable)
+                {
+                    dist[l.neighbor] = dist[u] + 1;
+                    queue.push_back(l.neighbor);
+                }
+            }
+        }
+        m_computed++;
+        return dist;
+    }
+
+    // A restored link can only shorten paths: relax outwards from the end
+    // it brings closer
+    uint64_t RepairUp(std::vector<uint16_t> &dist, uint32_t a, uint32_t b)
+    {
+        if (dist[b] < dist[a])
+        {
+            std::swap(a, b);
+        }
+        if (dist[a] == kUnreachable || dist[a] + 1 >= dist[b])
+        {
+            return 0;
+        }
+        uint64_t changed = 1;
+        dist[b] = dist[a] + 1;
+        std::deque<uint32_t> queue(1, b);
+        while (!queue.empty())
+        {
+            uint32_t u = queue.front();
+            queue.pop_front();
+            for (const Link &l : m_links[u])
+            {
+                if (l.up && dist[u] + 1 < dist[l.neighbor])
+                {
+                    dist[l.neighbor] = dist[u] + 1;
+                    queue.push_back(l.neighbor);
+                    changed++;
+                }
+            }
+        }
+        return changed;
+    }
+
+    /*
+     * A failed link a-b matters only if it joined consecutive levels and
+     * the far end has no other neighbour on the level above. The affected
+     * set grows level by level from there: a node is affected once every
+     * neighbour one hop closer is. Affected nodes then take the best
+     * distance offered by unaffected neighbours and settle among
+     * themselves in Dijkstra order.
+     */
+    uint64_t RepairDown(std::vector<uint16_t> &dist, uint32_t a, uint32_t b)
+    {
+        if (dist[b] < dist[a])
+        {
+            std::swap(a, b);
+        }
+        if (dist[a] == kUnreachable || dist[a] + 1 != dist[b] || HasCloserNeighbor(dist, b))
+        {
+            return 0;
+        }
+
+        // Level order: every affected node of a level is marked before
+        // the next level is examined
+        std::vector<uint32_t> affected(1, b);
+        m_mark[b] = 1;
+        for (size_t i = 0; i < affected.size(); i++)
+        {
+            uint32_t u = affected[i];
+            for (const Link &l : m_links[u])
+            {
+                uint32_t w = l.neighbor;
+                if (l.up && !m_mark[w] && dist[w] == dist[u] + 1 && !HasCloserNeighbor(dist, w))
+                {
+                    m_mark[w] = 1;
+                    affected.push_back(w);
+                }
+            }
+        }
+
+        typedef std::pair<uint32_t, uint32_t> Entry; // (distance, node)
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+        for (uint32_t u : affected)
+        {
+            uint32_t best = kUnreachable;
+            for (const Link &l : m_links[u])
+            {
+                if (l.up && !m_mark[l.neighbor] && dist[l.neighbor] != kUnreachable)
+                {
+                    best = std::min<uint32_t>(best, dist[l.neighbor] + 1);
+                }
+            }
+            dist[u] = best;
+            if (best != kUnreachable)
+            {
+                heap.push(Entry(best, u));
+            }
+        }
+        while (!heap.empty())
+        {
+            Entry e = heap.top();
+            heap.pop();
+            if (e.first != dist[e.second])
+            {
+                continue;
+            }
+            for (const Link &l : m_links[e.second])
+            {
+                uint32_t w = l.neighbor;
+                if (l.up && m_mark[w] && e.first + 1 < dist[w])
+                {
+                    dist[w] = e.first + 1;
+                    heap.push(Entry(dist[w], w));
+                }
+            }
+        }
+        for (uint32_t u : affected)
+        {
+            m_mark[u] = 0;
+        }
+        return affected.size();
+    }
+
+    // Has an up link to a neighbour one hop closer that is not affected
+    bool HasCloserNeighbor(const std::vector<uint16_t> &dist, uint32_t node) const
+    {
+        for (const Link &l : m_links[node])
+        {
+            if (l.up && !m_mark[l.neighbor] && dist[l.neighbor] + 1 == dist[node])
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::vector<Link>> m_links;
+    std::unordered_map<uint32_t, uint32_t> m_addrNode;
+    std::vector<std::vector<uint16_t>> m_dist;
+    std::vector<uint8_t> m_mark; // scratch for RepairDown
+    uint32_t m_computed = 0;
+};
+
+/* ---------- ROUTING PROTOCOL ---------- */
+
+namespace ns3
+{
+
+class SharedTableRouting : public Ipv4RoutingProtocol
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::SharedTableRouting")
+                .SetParent<Ipv4RoutingProtocol>()
+                .AddConstructor<SharedTableRouting>()
+                .AddAttribute("FlowEcmp",
+                              "Spread flows over equal-cost next hops by 5-tuple hash",
+                              BooleanValue(false),
+                              MakeBooleanAccessor(&SharedTableRouting::m_flowEcmp),
+                              MakeBooleanChecker());
+        return tid;
+    }
+
+    SharedTableRouting()
+        : m_flowEcmp(false)
+    {
+    }
+
+    void SetTable(Ptr<SharedRoutingTable> table) { m_table = table; }
+
+    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
+                               const Ipv4Header &header,
+                               Ptr<NetDevice> oif,
+                               Socket::SocketErrno &sockerr) override
+    {
+        // Only TCP hands the packet over with its transport header on
+        bool ports = p && header.GetProtocol() == 6;
+        Ptr<Ipv4Route> route = Lookup(header.GetDestination(), FlowHash(p, header, ports));
+        sockerr = route ? Socket::ERROR_NOTERROR : Socket::ERROR_NOROUTETOHOST;
+        return route;
+    }
+
+    bool RouteInput(Ptr<const Packet> p,
+                    const Ipv4Header &header,
+                    Ptr<const NetDevice> idev,
+                    const UnicastForwardCallback &ucb,
+                    const MulticastForwardCallback &mcb,
+                    const LocalDeliverCallback &lcb,
+                    const ErrorCallback &ecb) override
+    {
+        bool ports = header.GetProtocol() == 6 || header.GetProtocol() == 17;
+        Ptr<Ipv4Route> route = Lookup(header.GetDestination(), FlowHash(p, header, ports));
+        if (!route)
+        {
+            return false;
+        }
+        ucb(idev, route, p, header);
+        return true;
+    }
+
+    void NotifyInterfaceUp(uint32_t interface) override
+    {
+    }
+
+    void NotifyInterfaceDown(uint32_t interface) override
+    {
+    }
+
+    void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override
+    {
+    }
+
+    void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override
+    {
+    }
+
+    void SetIpv4(Ptr<Ipv4> ipv4) override
+    {
+        m_ipv4 = ipv4;
+    }
+
+    void PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const override
+    {
+        *stream->GetStream() << "Node " << m_ipv4->GetObject<Node>()->GetId()
+                             << ": shared table routing, " << (m_table ? m_table->GetNComputed() : 0)
+                             << " destinations computed\n";
+    }
+
+  private:
+    uint32_t FlowHash(Ptr<const Packet> p, const Ipv4Header &header, bool ports) const
+    {
+        if (!m_flowEcmp)
+        {
+            return 0;
+        }
+        uint32_t portPair = 0;
+        if (ports && p->GetSize() >= 4)
+        {
+            uint8_t buf[4];
+            p->CopyData(buf, 4);
+            portPair = (uint32_t(buf[0]) << 24) | (uint32_t(buf[1]) << 16) | (uint32_t(buf[2]) << 8) | buf[3];
+        }
+        uint64_t h = 0x9e3779b97f4a7c15ULL;
+        for (uint64_t v : {header.GetSource().Get(), header.GetDestination().Get(), portPair,
+                           uint32_t(header.GetProtocol()), m_ipv4->GetObject<Node>()->GetId()})
+        {
+            h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h *= 0xff51afd7ed558ccdULL;
+        }
+        return uint32_t(h ^ (h >> 33));
+    }
+
+    Ptr<Ipv4Route> Lookup(Ipv4Address dest, uint32_t hash)
+    {
+        if (!m_table || dest.IsMulticast() || dest.IsBroadcast())
+        {
+            return nullptr;
+        }
+        int64_t dst = m_table->FindNode(dest);
+        if (dst < 0)
+        {
+            return nullptr;
+        }
+        const SharedRoutingTable::Link *link =
+            m_table->NextHop(m_ipv4->GetObject<Node>()->GetId(), uint32_t(dst), hash);
+        if (!link)
+        {
+            return nullptr;
+        }
+        Ptr<Ipv4Route> route = Create<Ipv4Route>();
+        route->SetDestination(dest);
+        route->SetGateway(link->gateway);
+        route->SetSource(m_ipv4->GetAddress(link->ifIndex, 0).GetLocal());
+        route->SetOutputDevice(m_ipv4->GetNetDevice(link->ifIndex));
+        return route;
+    }
+
+    Ptr<Ipv4> m_ipv4;
+    Ptr<SharedRoutingTable> m_table;
+    bool m_flowEcmp;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(SharedTableRouting);
+
+// For InternetStackHelper::SetRoutingHelper(), usually inside an
+// Ipv4ListRoutingHelper next to static routing
+class SharedTableRoutingHelper : public Ipv4RoutingHelper
+{
+  public:
+    explicit SharedTableRoutingHelper(Ptr<SharedRoutingTable> table)
+        : m_table(table)
+    {
+    }
+
+    SharedTableRoutingHelper *Copy() const override { return new SharedTableRoutingHelper(*this); }
+
+    Ptr<Ipv4RoutingProtocol> Create(Ptr<Node> node) const override
+    {
+        Ptr<SharedTableRouting> routing = CreateObject<SharedTableRouting>();
+        routing->SetTable(m_table);
+        return routing;
+    }
+
+  private:
+    Ptr<SharedRoutingTable> m_table;
+};
+
+} // namespace ns3
+
+#endif /* SHARED_ROUTING_H */
@@ -0,0 +1,319 @@
+/*
+ * Spoofed-source flood generator for DDoS scenarios.
+ *
+ * SpoofedFloodApplication sends UDP packets with forged IPv4 source
+ * addresses through a raw socket (IpHeaderInclude), like the hand-rolled
+ * SendSpoofedPacket() it replaces, but:
+ *
+ *   - every packet is a Copy() of a prebuilt template (payload + UDP +
+ *     IPv4 header). Packet::Copy is copy-on-write, so no header is
+ *     serialized per send;
+ *   - spoofed sources are either one fixed address, a round-robin pool,
+ *     or drawn at random from the pool. A template is built once per pool
+ *     address, inside SpoofPrefix/SpoofPrefixLength (by default the
+ *     198.18.0.0/15 benchmarking block, clear of the simulation's own
+ *     10/8 subnets). 0/8, 127/8 and 224/3 (multicast, reserved, broadcast)
+ *     are never drawn, whatever the prefix;
+ *   - sends are scheduled one at a time (constant, Poisson or pulsing
+ *     inter-packet gaps), so a flood of millions of packets keeps a single
+ *     pending event per attacker instead of filling the event queue at
+ *     setup.
+ *
+ * The raw socket is bound to Device, or to the device the node routes
+ * Remote through, so forged packets leave by the attacker's own link.
+ */
+
+#ifndef SPOOF_FLOOD_APP_H
+#define SPOOF_FLOOD_APP_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+class SpoofedFloodApplication : public Application
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid =
+            TypeId("ns3::SpoofedFloodApplication")
+                .SetParent<Application>()
+                .AddConstructor<SpoofedFloodApplication>()
+                .AddAttribute("Remote", "Victim address",
+                              Ipv4AddressValue(),
+                              MakeIpv4AddressAccessor(&SpoofedFloodApplication::m_remote),
+                              MakeIpv4AddressChecker())
+                .AddAttribute("RemotePort", "Victim UDP port",
+                              UintegerValue(9),
+                              MakeUintegerAccessor(&SpoofedFloodApplication::m_remotePort),
+                              MakeUintegerChecker<uint16_t>())
+                .AddAttribute("PacketSize", "UDP payload bytes",
+                              UintegerValue(512),
+                              MakeUintegerAccessor(&SpoofedFloodApplication::m_packetSize),
+                              MakeUintegerChecker<uint32_t>())
+                .AddAttribute("PacketRate", "Packets per second (mean for poisson, on-phase for pulse)",
+                              DoubleValue(1000),
+                              MakeDoubleAccessor(&SpoofedFloodApplication::m_rate),
+                              MakeDoubleChecker<double>(1e-9))
+                .AddAttribute("Device", "Device the raw socket is bound to (null = the route's to Remote)",
+                              PointerValue(),
+                              MakePointerAccessor(&SpoofedFloodApplication::m_device),
+                              MakePointerChecker<NetDevice>())
+                .AddAttribute("Pattern", "constant, poisson or pulse",
+                              StringValue("constant"),
+                              MakeStringAccessor(&SpoofedFloodApplication::m_pattern),
+                              MakeStringChecker())
+                .AddAttribute("PulseOn", "Sending part of every pulse period",
+                              TimeValue(MilliSeconds(100)),
+                              MakeTimeAccessor(&SpoofedFloodApplication::m_pulseOn),
+                              MakeTimeChecker())
+                .AddAttribute("PulsePeriod", "Length of one pulse period",
+                              TimeValue(Seconds(1)),
+                              MakeTimeAccessor(&SpoofedFloodApplication::m_pulsePeriod),
+                              MakeTimeChecker())
+                .AddAttribute("SourceMode", "fixed, pool (round-robin) or random (from the pool)",
+                              StringValue("fixed"),
+                              MakeStringAccessor(&SpoofedFloodApplication::m_sourceMode),
+                              MakeStringChecker())
+                .AddAttribute("SpoofedSource", "Source address in fixed mode",
+                              Ipv4AddressValue("10.1.2.10"),
+                              MakeIpv4AddressAccessor(&SpoofedFloodApplication::m_fixedSource),
+                              MakeIpv4AddressChecker())
+                .AddAttribute("SpoofPrefix", "Prefix pool addresses are drawn from",
+                              Ipv4AddressValue("198.18.0.0"),
+                              MakeIpv4AddressAccessor(&SpoofedFloodApplication::m_spoofPrefix),
+                              MakeIpv4AddressChecker())
+                .AddAttribute("SpoofPrefixLength", "Length of SpoofPrefix",
+                              UintegerValue(15),
+                              MakeUintegerAccessor(&SpoofedFloodApplication::m_spoofPrefixLength),
+                              MakeUintegerChecker<uint8_t>(0, 32))
+                .AddAttribute("PoolSize", "Number of spoofed sources (= prebuilt templates)",
+                              UintegerValue(1024),
+                              MakeUintegerAccessor(&SpoofedFloodApplication::m_poolSize),
+                              MakeUintegerChecker<uint32_t>(1))
+                .AddAttribute("MaxPackets", "Stop after this many packets (0 = no limit)",
+                              UintegerValue(0),
+                              MakeUintegerAccessor(&SpoofedFloodApplication::m_maxPackets),
+                              MakeUintegerChecker<uint64_t>())
+                .AddTraceSource("Tx", "A spoofed packet was sent",
+                                MakeTraceSourceAccessor(&SpoofedFloodApplication::m_txTrace),
+                                "ns3::Packet::TracedCallback");
+        return tid;
+    }
+
+    SpoofedFloodApplication()
+        : m_sent(0),
+          m_next(0)
+    {
+        m_pick = CreateObject<UniformRandomVariable>();
+        m_gap = CreateObject<ExponentialRandomVariable>();
+    }
+
+    uint64_t GetSent() const
+    {
+        return m_sent;
+    }
+
+    // Also reached through Application, so ApplicationContainer-wide
+    // stream assignment (and with it RngRun) covers pool and gap draws.
+    int64_t AssignStreams(int64_t stream) override
+    {
+        m_pick->SetStream(stream);
+        m_gap->SetStream(stream + 1);
+        return 2;
+    }
+
+  protected:
+    void DoDispose() override
+    {
+        m_socket = nullptr;
+        m_device = nullptr;
+        m_templates.clear();
+        Application::DoDispose();
+    }
+
+  private:
+    void StartApplication() override
+    {
+        if (!m_socket)
+        {
+            m_socket = Socket::CreateSocket(GetNode(), Ipv4RawSocketFactory::GetTypeId());
+            m_socket->SetAttribute("Protocol", UintegerValue(UdpL4Protocol::PROT_NUMBER));
+            m_socket->SetAttribute("IpHeaderInclude", BooleanValue(true));
+            if (!m_device)
+            {
+                m_device = OutputDevice();
+            }
+            if (m_device)
+            {
+                m_socket->BindToNetDevice(m_device);
+            }
+        }
+        if (m_templates.empty())
+        {
+            BuildTemplates();
+        }
+        m_startTime = Simulator::Now();
+        m_sendEvent = Simulator::ScheduleNow(&SpoofedFloodApplication::SendNext, this);
+    }
+
+    void StopApplication() override
+    {
+        Simulator::Cancel(m_sendEvent);
+    }
+
+    // The device the node's routing would send Remote's packets out of
+    Ptr<NetDevice> OutputDevice() const
+    {
+        Ptr<Ipv4> ipv4 = GetNode()->GetObject<Ipv4>();
+        Ipv4Header header;
+        header.SetDestination(m_remote);
+        Socket::SocketErrno err;
+        Ptr<Ipv4Route> route = ipv4->GetRoutingProtocol()->RouteOutput(nullptr, header, nullptr, err);
+        return route ? route->GetOutputDevice() : nullptr;
+    }
+
+    Ptr<Packet> MakeTemplate(Ipv4Address src)
+    {
+        Ptr<Packet> p = Create<Packet>(m_packetSize);
+
+        UdpHeader udp;
+        udp.SetSourcePort(1024 + m_pick->GetInteger(0, 64511));
+        udp.SetDestinationPort(m_remotePort);
+        p->AddHeader(udp);
+
+        Ipv4Header ip;
+        ip.SetSource(src);
+        ip.SetDestination(m_remote);
+        ip.SetProtocol(UdpL4Protocol::PROT_NUMBER);
+        ip.SetPayloadSize(p->GetSize());
+        ip.SetTtl(64);
+        p->AddHeader(ip);
+        return p;
+    }
+
+    void BuildTemplates()
+    {
+        if (m_sourceMode == "fixed")
+        {
+            m_templates.push_back(MakeTemplate(m_fixedSource));
+            return;
+        }
+
+        NS_ABORT_MSG_UNLESS(m_sourceMode == "pool" || m_sourceMode == "random",
+                            "Unknown SourceMode " << m_sourceMode);
+        uint32_t hostBits = 32 - m_spoofPrefixLength;
+        uint32_t base = hostBits == 32 ? 0 : m_spoofPrefix.Get() & ~((uint32_t(1) << hostBits) - 1);
+        uint32_t maxHost = hostBits == 32 ? 0xffffffff : (uint32_t(1) << hostBits) - 1;
+
+        m_templates.reserve(m_poolSize);
+        for (uint32_t i = 0; i < m_poolSize; i++)
+        {
+            uint32_t addr;
+            uint32_t tries = 0;
+            do
+            {
+                NS_ABORT_MSG_IF(++tries > 64, "SpoofPrefix " << m_spoofPrefix << "/" << int(m_spoofPrefixLength)
+                                                             << " lies in 0/8, 127/8 or 224/3");
+                // Avoid the all-zeros/all-ones host part where there is a choice.
+                uint32_t host =
+                    maxHost > 1 ? m_pick->GetInteger(1, maxHost - 1) : m_pick->GetInteger(0, maxHost);
+                addr = base | host;
+            } while (!IsUsableSource(addr));
+            m_templates.push_back(MakeTemplate(Ipv4Address(addr)));
+        }
+    }
+
+    // Not "this host", loopback, multicast, reserved or broadcast
+    static bool IsUsableSource(uint32_t addr)
+    {
+        uint32_t first = addr >> 24;
+        return first != 0 && first != 127 && first < 224;
+    }
+
+    Time NextGap()
+    {
+        double mean = 1.0 / m_rate;
+        if (m_pattern == "poisson")
+        {
+            return Seconds(m_gap->GetValue(mean, 0));
+        }
+
+        Time gap = Seconds(mean);
+        if (m_pattern == "pulse")
+        {
+            // Skip over the silent part of the period.
+            int64_t period = m_pulsePeriod.GetNanoSeconds();
+            int64_t offset = (Simulator::Now() - m_startTime + gap).GetNanoSeconds() % period;
+            if (offset >= m_pulseOn.GetNanoSeconds())
+            {
+                gap += NanoSeconds(period - offset);
+            }
+        }
+        else
+        {
+            NS_ABORT_MSG_UNLESS(m_pattern == "constant", "Unknown Pattern " << m_pattern);
+        }
+        return gap;
+    }
+
+    void SendNext()
+    {
+        uint32_t idx;
+        if (m_sourceMode == "random")
+        {
+            idx = m_pick->GetInteger(0, m_templates.size() - 1);
+        }
+        else
+        {
+            idx = m_next;
+            m_next = (m_next + 1) % m_templates.size();
+        }
+
+        Ptr<Packet> p = m_templates[idx]->Copy();
+        m_txTrace(p);
+        m_socket->SendTo(p, 0, InetSocketAddress(m_remote, m_remotePort));
+        m_sent++;
+
+        if (m_maxPackets == 0 || m_sent < m_maxPackets)
+        {
+            m_sendEvent = Simulator::Schedule(NextGap(), &SpoofedFloodApplication::SendNext, this);
+        }
+    }
+
+    Ipv4Address m_remote;
+    uint16_t m_remotePort;
+    uint32_t m_packetSize;
+    double m_rate;
+    std::string m_pattern;
+    Time m_pulseOn;
+    Time m_pulsePeriod;
+    std::string m_sourceMode;
+    Ipv4Address m_fixedSource;
+    Ipv4Address m_spoofPrefix;
+    uint8_t m_spoofPrefixLength;
+    uint32_t m_poolSize;
+    uint64_t m_maxPackets;
+
+    Ptr<NetDevice> m_device;
+    Ptr<Socket> m_socket;
+    std::vector<Ptr<Packet>> m_templates;
+    Ptr<UniformRandomVariable> m_pick;
+    Ptr<ExponentialRandomVariable> m_gap;
+    Time m_startTime;
+    EventId m_sendEvent;
+    uint64_t m_sent;
+    uint32_t m_next;
+    TracedCallback<Ptr<const Packet>> m_txTrace;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(SpoofedFloodApplication);
+
+} // namespace ns3
+
+#endif /* SPOOF_FLOOD_APP_H */
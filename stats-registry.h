@@ -0,0 +1,347 @@
+/*
+ * Statistics registry: named counters, gauges and histograms in one place.
+ *
+ * Every statistic belongs to an owner (a node, an application or a device,
+ * named by StatsOwner()) and lives in a dense array of 8-byte words: a
+ * counter or gauge takes one word, a histogram one word per bucket. The
+ * words come in 64-byte aligned blocks of 512 that never move, so a trace
+ * callback holds a plain pointer to its words, statistics registered
+ * together (one application's) share cache lines, and a histogram starts
+ * on a line of its own.
+ *
+ * Connect() is the one trace adapter for all of them: for any trace
+ * signature it increments a counter (by one, or by a value taken from the
+ * trace arguments, e.g. PacketBytes), sets a gauge or records into a
+ * histogram. No per-flow or per-client callback has to be written, so
+ * thousands of applications can be instrumented in a loop.
+ *
+ *   StatsRegistry stats;
+ *   StatsRegistry::StatId tx = stats.AddCounter(StatsOwner(app), "txPackets");
+ *   stats.Connect<Ptr<const Packet>>(app, "Tx", tx);
+ *   ...
+ *   stats.Write("stats.json"); // or .csv
+ */
+
+#ifndef STATS_REGISTRY_H
+#define STATS_REGISTRY_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+enum StatKind : uint8_t
+{
+    STAT_COUNTER,
+    STAT_GAUGE,
+    STAT_HISTOGRAM,
+};
+
+static const char *kStatKindNames[] = {"counter", "gauge", "histogram"};
+
+/* ---------- OWNER NAMES ---------- */
+
+inline std::string
+StatsOwner(ns3::Ptr<ns3::Node> node)
+{
+    return "node" + std::to_string(node->GetId());
+}
+
+// "node3/app1": the application's index on its node
+inline std::string
+StatsOwner(ns3::Ptr<ns3::Application> app)
+{
+    ns3::Ptr<ns3::Node> node = app->GetNode();
+    uint32_t i = 0;
+    while (i < node->GetNApplications() && node->GetApplication(i) != app)
+    {
+        i++;
+    }
+    return StatsOwner(node) + "/app" + std::to_string(i);
+}
+
+inline std::string
+StatsOwner(ns3::Ptr<ns3::NetDevice> dev)
+{
+    return StatsOwner(dev->GetNode()) + "/dev" + std::to_string(dev->GetIfIndex());
+}
+
+/* ---------- VALUE EXTRACTORS ---------- */
+
+inline double
+PacketBytes(ns3::Ptr<const ns3::Packet> p)
+{
+    return p->GetSize();
+}
+
+// PacketSink "Rx" and the like
+inline double
+PacketBytesFrom(ns3::Ptr<const ns3::Packet> p, const ns3::Address &)
+{
+    return p->GetSize();
+}
+
+// TracedValue sources: the new value
+template <typename T>
+double
+TracedNewValue(T, T newValue)
+{
+    return double(newValue);
+}
+
+/* ---------- REGISTRY ---------- */
+
+class StatsRegistry
+{
+  public:
+    typedef uint32_t StatId;
+
+    static constexpr uint32_t kBlockWords = 512;
+
+    struct Stat
+    {
+        std::string owner;
+        std::string name;
+        StatKind kind;
+        uint64_t *words;
+        uint32_t nBuckets;  // histogram: the last one also takes overflow
+        double bucketWidth; // histogram: bucket k is [k * width, (k+1) * width)
+    };
+
+    StatId AddCounter(const std::string &owner, const std::string &name)
+    {
+        return Add(owner, name, STAT_COUNTER, 1, 0);
+    }
+
+    StatId AddGauge(const std::string &owner, const std::string &name)
+    {
+        return Add(owner, name, STAT_GAUGE, 1, 0);
+    }
+
+    StatId AddHistogram(const std::string &owner, const std::string &name, double bucketWidth, uint32_t nBuckets)
+    {
+        NS_ABORT_MSG_IF(nBuckets == 0 || nBuckets > kBlockWords, "Histogram needs 1.." << kBlockWords << " buckets");
+        NS_ABORT_MSG_IF(bucketWidth <= 0, "Histogram bucket width must be positive");
+        return Add(owner, name, STAT_HISTOGRAM, nBuckets, bucketWidth);
+    }
+
+    void Increment(StatId id, uint64_t n = 1) { *m_stats[id].words += n; }
+
+    void Set(StatId id, double value) { std::memcpy(m_stats[id].words, &value, sizeof(double)); }
+
+    void Record(StatId id, double value) { Update(m_stats[id], value); }
+
+    uint64_t GetCounter(StatId id) const { return *m_stats[id].words; }
+
+    double GetGauge(StatId id) const
+    {
+        double value;
+        std::memcpy(&value, m_stats[id].words, sizeof(double));
+        return value;
+    }
+
+    uint64_t GetBucket(StatId id, uint32_t bucket) const { return m_stats[id].words[bucket]; }
+
+    const Stat &Get(StatId id) const { return m_stats[id]; }
+
+    uint32_t GetN() const { return m_stats.size(); }
+
+    // Sum of every counter called name, over all owners
+    uint64_t Total(const std::string &name) const
+    {
+        uint64_t sum = 0;
+        for (const Stat &s : m_stats)
+        {
+            if (s.kind == STAT_COUNTER && s.name == name)
+            {
+                sum += *s.words;
+            }
+        }
+        return sum;
+    }
+
+    /*
+     * Feeds trace source `trace` of `object` into statistic id. Args is the
+     * trace signature; value maps the trace arguments to the amount (counter,
+     * default 1) or the value (gauge and histogram, required).
+     */
+    template <typename... Args>
+    void Connect(ns3::Ptr<ns3::ObjectBase> object, const std::string &trace, StatId id,
+                 double (*value)(Args...) = nullptr)
+    {
+        NS_ABORT_MSG_IF(m_stats[id].kind != STAT_COUNTER && !value,
+                        "Gauge and histogram " << m_stats[id].name << " need a value extractor");
+        auto sink = std::make_unique<TraceSink<Args...>>();
+        sink->stat = &m_stats[id];
+        if (value)
+        {
+            sink->value = value;
+        }
+        TraceSink<Args...> *raw = sink.get();
+        m_sinks.push_back(std::move(sink));
+        bool ok = object->TraceConnectWithoutContext(
+            trace, ns3::MakeBoundCallback(&StatsRegistry::Traced<Args...>, raw));
+        NS_ABORT_MSG_IF(!ok, "No trace source " << trace << " for " << m_stats[id].owner << " " << m_stats[id].name);
+    }
+
+    void WriteJson(std::ostream &os) const
+    {
+        os << "{\"stats\": [";
+        for (size_t i = 0; i < m_stats.size(); i++)
+        {
+            const Stat &s = m_stats[i];
+            os << (i ? ",\n  " : "\n  ") << "{\"owner\": \"" << s.owner << "\", \"name\": \"" << s.name
+               << "\", \"kind\": \"" << kStatKindNames[s.kind] << "\", ";
+            if (s.kind == STAT_HISTOGRAM)
+            {
+                os << "\"bucketWidth\": " << s.bucketWidth << ", \"buckets\": [";
+                for (uint32_t b = 0; b < s.nBuckets; b++)
+                {
+                    os << (b ? ", " : "") << s.words[b];
+                }
+                os << "]}";
+            }
+            else
+            {
+                os << "\"value\": " << ValueOf(s) << "}";
+            }
+        }
+        os << "\n]}\n";
+    }
+
+    // One row per counter and gauge, one per histogram bucket (its lower edge)
+    void WriteCsv(std::ostream &os) const
+    {
+        os << "owner,name,kind,bucket,value\n";
+        for (const Stat &s : m_stats)
+        {
+            if (s.kind == STAT_HISTOGRAM)
+            {
+                for (uint32_t b = 0; b < s.nBuckets; b++)
+                {
+                    os << s.owner << "," << s.name << ",histogram," << b * s.bucketWidth << "," << s.words[b]
+                       << "\n";
+                }
+            }
+            else
+            {
+                os << s.owner << "," << s.name << "," << kStatKindNames[s.kind] << ",," << ValueOf(s) << "\n";
+            }
+        }
+    }
+
+    // CSV if fileName ends in .csv, JSON otherwise
+    void Write(const std::string &fileName) const
+    {
+        std::ofstream out(fileName);
+        if (!out)
+        {
+            NS_FATAL_ERROR("Cannot open stats file " << fileName);
+        }
+        bool csv = fileName.size() >= 4 && fileName.compare(fileName.size() - 4, 4, ".csv") == 0;
+        if (csv)
+        {
+            WriteCsv(out);
+        }
+        else
+        {
+            WriteJson(out);
+        }
+    }
+
+  private:
+    struct alignas(64) Block
+    {
+        uint64_t words[kBlockWords];
+    };
+
+    struct SinkBase
+    {
+        virtual ~SinkBase() = default;
+        Stat *stat = nullptr;
+    };
+
+    // One per Connect(), typed by its trace signature
+    template <typename... Args>
+    struct TraceSink : SinkBase
+    {
+        std::function<double(Args...)> value; // empty: count one per call
+    };
+
+    StatId Add(const std::string &owner, const std::string &name, StatKind kind, uint32_t nWords, double width)
+    {
+        // A histogram starts a cache line; nothing straddles a block
+        if (kind == STAT_HISTOGRAM)
+        {
+            m_used = (m_used + 7) / 8 * 8;
+        }
+        if (m_blocks.empty() || m_used + nWords > kBlockWords)
+        {
+            m_blocks.emplace_back(new Block());
+            m_used = 0;
+        }
+        Stat s{owner, name, kind, m_blocks.back()->words + m_used, nWords, width};
+        m_used += nWords;
+        std::memset(s.words, 0, nWords * sizeof(uint64_t));
+        m_stats.push_back(s);
+        return m_stats.size() - 1;
+    }
+
+    static void Update(Stat &s, double value)
+    {
+        switch (s.kind)
+        {
+        case STAT_COUNTER:
+            *s.words += uint64_t(value);
+            break;
+        case STAT_GAUGE:
+            std::memcpy(s.words, &value, sizeof(double));
+            break;
+        case STAT_HISTOGRAM:
+            s.words[std::min<uint32_t>(value > 0 ? uint32_t(value / s.bucketWidth) : 0, s.nBuckets - 1)]++;
+            break;
+        }
+    }
+
+    template <typename... Args>
+    static void Traced(TraceSink<Args...> *sink, Args... args)
+    {
+        if (!sink->value)
+        {
+            (*sink->stat->words)++;
+            return;
+        }
+        Update(*sink->stat, sink->value(args...));
+    }
+
+    static std::string ValueOf(const Stat &s)
+    {
+        if (s.kind == STAT_COUNTER)
+        {
+            return std::to_string(*s.words);
+        }
+        double value;
+        std::memcpy(&value, s.words, sizeof(double));
+        std::ostringstream out;
+        out << value;
+        return out.str();
+    }
+
+    std::vector<std::unique_ptr<Block>> m_blocks;
+    uint32_t m_used = 0; // words used in the last block
+    // Trace callbacks hold pointers to stats (a deque never moves them)
+    // and to sinks
+    std::deque<Stat> m_stats;
+    std::vector<std::unique_ptr<SinkBase>> m_sinks;
+};
+
+#endif /* STATS_REGISTRY_H */
@@ -0,0 +1,290 @@
+/*
+ * Online steady-state detection and automatic early termination.
+ *
+ * Every metric is observed once per window (e.g. throughput over the last
+ * 100 ms, queue length at the window's end). Mser5Detector groups the
+ * observations into batches of five and applies MSER-5 (White, 1997): the
+ * warm-up truncation point d* is the batch count that minimises the
+ * standard error of the mean of the batches left after it. The metric is
+ * steady when
+ *   - d* lies in the first half of the batches seen so far (otherwise the
+ *     run is still too short to tell the transient from the steady state),
+ *   - at least minBatches batches remain after d*, and
+ *   - the batch-means confidence interval of the truncated mean is within
+ *     tolerance * |mean|.
+ *
+ * SteadyStateMonitor samples a set of metrics every interval and, once all
+ * of them are steady, records the time and (with auto-stop) calls
+ * Simulator::Stop(). The truncated means are the warm-up-free estimates to
+ * report; the fixed stop time of a script becomes an upper bound only.
+ */
+
+#ifndef STEADY_STATE_H
+#define STEADY_STATE_H
+
+#include "replication.h"
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* ---------- MSER-5 ---------- */
+
+class Mser5Detector
+{
+  public:
+    static const uint32_t kBatch = 5;
+
+    void Add(double x)
+    {
+        m_partial += x;
+        if (++m_inBatch == kBatch)
+        {
+            m_batches.push_back(m_partial / kBatch);
+            m_partial = 0;
+            m_inBatch = 0;
+            Update();
+        }
+    }
+
+    uint32_t GetBatches() const { return m_batches.size(); }
+
+    // Warm-up truncation in observations (d* batches of five)
+    uint32_t GetWarmupObservations() const { return m_truncation * kBatch; }
+
+    // Mean of the batches after the truncation point
+    double GetMean() const { return m_mean; }
+
+    double GetHalfWidth(double confidence) const
+    {
+        uint32_t m = m_batches.size() - m_truncation;
+        if (m < 2)
+        {
+            return INFINITY;
+        }
+        return StudentTQuantile(0.5 + confidence / 2.0, m - 1) * std::sqrt(m_variance / m);
+    }
+
+    bool IsSteady(double tolerance, double confidence, uint32_t minBatches) const
+    {
+        uint32_t n = m_batches.size();
+        if (n < 2 * minBatches || 2 * m_truncation > n || n - m_truncation < minBatches)
+        {
+            return false;
+        }
+        return GetHalfWidth(confidence) <= tolerance * std::fabs(m_mean);
+    }
+
+  private:
+    // d* = argmin over d of sum_{j>=d} (b_j - mean_d)^2 / (n - d)^2, from
+    // suffix sums in one backward pass
+    void Update()
+    {
+        uint32_t n = m_batches.size();
+        double s = 0, q = 0;
+        double best = INFINITY;
+        for (uint32_t d = n; d-- > 0;)
+        {
+            s += m_batches[d];
+            q += m_batches[d] * m_batches[d];
+            uint32_t m = n - d;
+            if (m < 2)
+            {
+                continue;
+            }
+            double ss = std::max(0.0, q - s * s / m);
+            double mser = ss / (double(m) * m);
+            if (mser <= best)
+            {
+                best = mser;
+                m_truncation = d;
+                m_mean = s / m;
+                m_variance = ss / (m - 1);
+            }
+        }
+    }
+
+    std::vector<double> m_batches;
+    double m_partial = 0;
+    uint32_t m_inBatch = 0;
+    uint32_t m_truncation = 0;
+    double m_mean = 0;
+    double m_variance = 0;
+};
+
+/* ---------- MONITOR ---------- */
+
+// Windowed rate in Mbps of a monotonically growing byte counter
+inline std::function<double()>
+WindowedRateMbps(std::function<uint64_t()> bytes, ns3::Time interval)
+{
+    auto last = std::make_shared<uint64_t>(0);
+    return [bytes, interval, last]() {
+        uint64_t now = bytes();
+        double mbps = (now - *last) * 8.0 / interval.GetSeconds() / 1e6;
+        *last = now;
+        return mbps;
+    };
+}
+
+// Bytes a PacketSink received from each of a set of source addresses, for
+// per-flow windowed rates when one sink serves several senders
+class SourceRxCounter
+{
+  public:
+    // Returns the source's index
+    uint32_t AddSource(ns3::Ipv4Address addr)
+    {
+        m_sources.push_back(addr);
+        m_bytes.push_back(0);
+        return m_sources.size() - 1;
+    }
+
+    void Track(ns3::Ptr<ns3::Application> sink)
+    {
+        sink->TraceConnectWithoutContext("Rx", ns3::MakeBoundCallback(&SourceRxCounter::Rx, this));
+    }
+
+    uint64_t GetBytes(uint32_t i) const { return m_bytes[i]; }
+
+    std::function<uint64_t()> Counter(uint32_t i) const
+    {
+        return [this, i]() { return m_bytes[i]; };
+    }
+
+  private:
+    static void Rx(SourceRxCounter *self, ns3::Ptr<const ns3::Packet> p, const ns3::Address &from)
+    {
+        if (!ns3::InetSocketAddress::IsMatchingType(from))
+        {
+            return;
+        }
+        ns3::Ipv4Address src = ns3::InetSocketAddress::ConvertFrom(from).GetIpv4();
+        for (size_t i = 0; i < self->m_sources.size(); i++)
+        {
+            if (self->m_sources[i] == src)
+            {
+                self->m_bytes[i] += p->GetSize();
+                return;
+            }
+        }
+    }
+
+    std::vector<ns3::Ipv4Address> m_sources;
+    std::vector<uint64_t> m_bytes;
+};
+
+class SteadyStateMonitor
+{
+  public:
+    SteadyStateMonitor(ns3::Time interval, double tolerance = 0.05, double confidence = 0.95,
+                       uint32_t minBatches = 8)
+        : m_interval(interval),
+          m_tolerance(tolerance),
+          m_confidence(confidence),
+          m_minBatches(minBatches)
+    {
+    }
+
+    void AddMetric(const std::string &name, std::function<double()> sample)
+    {
+        m_metrics.push_back({name, sample, Mser5Detector()});
+    }
+
+    // Stop the simulation as soon as every metric is steady
+    void SetAutoStop(bool autoStop) { m_autoStop = autoStop; }
+
+    // First window ends at start + interval
+    void Start(ns3::Time start)
+    {
+        m_start = start;
+        ns3::Simulator::Schedule(start + m_interval - ns3::Simulator::Now(), &SteadyStateMonitor::Sample,
+                                 this);
+    }
+
+    bool IsSteady() const { return !m_steadyAt.IsNegative(); }
+
+    ns3::Time GetSteadyTime() const { return m_steadyAt; }
+
+    // End of the longest warm-up among the metrics
+    ns3::Time GetWarmupEnd() const
+    {
+        uint32_t obs = 0;
+        for (auto const &m : m_metrics)
+        {
+            obs = std::max(obs, m.detector.GetWarmupObservations());
+        }
+        return m_start + ns3::Seconds(m_interval.GetSeconds() * obs);
+    }
+
+    // Warm-up-free mean of metric i
+    double GetMean(size_t i) const { return m_metrics[i].detector.GetMean(); }
+
+    double GetHalfWidth(size_t i) const { return m_metrics[i].detector.GetHalfWidth(m_confidence); }
+
+    void Print(std::ostream &os) const
+    {
+        if (IsSteady())
+        {
+            os << "Steady state after " << m_steadyAt.GetSeconds() << " s (warm-up until "
+               << GetWarmupEnd().GetSeconds() << " s discarded)\n";
+        }
+        else
+        {
+            os << "No steady state within tolerance " << m_tolerance << " by "
+               << ns3::Simulator::Now().GetSeconds() << " s; means below are MSER-5 truncated\n";
+        }
+        for (size_t i = 0; i < m_metrics.size(); i++)
+        {
+            os << "  " << std::left << std::setw(28) << m_metrics[i].name << std::right << std::setw(12)
+               << GetMean(i) << " +/- " << GetHalfWidth(i) << "\n";
+        }
+    }
+
+  private:
+    struct Metric
+    {
+        std::string name;
+        std::function<double()> sample;
+        Mser5Detector detector;
+    };
+
+    void Sample()
+    {
+        bool steady = !m_metrics.empty();
+        for (auto &m : m_metrics)
+        {
+            m.detector.Add(m.sample());
+            steady = steady && m.detector.IsSteady(m_tolerance, m_confidence, m_minBatches);
+        }
+        if (steady && !IsSteady())
+        {
+            m_steadyAt = ns3::Simulator::Now();
+            if (m_autoStop)
+            {
+                ns3::Simulator::Stop();
+                return;
+            }
+        }
+        ns3::Simulator::Schedule(m_interval, &SteadyStateMonitor::Sample, this);
+    }
+
+    ns3::Time m_interval;
+    double m_tolerance;
+    double m_confidence;
+    uint32_t m_minBatches;
+    bool m_autoStop = false;
+    ns3::Time m_start;
+    ns3::Time m_steadyAt = ns3::Seconds(-1);
+    std::vector<Metric> m_metrics;
+};
+
+#endif /* STEADY_STATE_H */
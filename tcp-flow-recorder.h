@@ -0,0 +1,215 @@
+/*
+ * Per-flow congestion-window / RTT time series for BulkSend TCP senders.
+ *
+ * BulkSendApplication only creates its TCP socket in StartApplication(), so
+ * the recorder polls for it from the application's start time until its
+ * stop time and then connects to the socket's CongestionWindow, SlowStartThreshold, RTT
+ * and BytesInFlight trace sources.
+ *
+ * Samples go into per-flow columnar buffers (one vector per variable).
+ * Every trace change updates the flow's current state; with a
+ * sampleInterval, a row holding that state is appended at every interval
+ * boundary from attach time until the application's stop time, so
+ * thousands of flows can be traced at a bounded rate and each row is the
+ * state at its timestamp. Nothing is written until WriteCsv() is called at
+ * the end of the run.
+ */
+
+#ifndef TCP_FLOW_RECORDER_H
+#define TCP_FLOW_RECORDER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class TcpFlowRecorder
+{
+  public:
+    // sampleInterval = 0 keeps every change instead.
+    explicit TcpFlowRecorder(ns3::Time sampleInterval = ns3::Time(0))
+        : m_interval(sampleInterval)
+    {
+    }
+
+    /*
+     * Starts tracing the socket app will create at startTime (absolute, as
+     * this is called before Simulator::Run). Returns the flow index used in
+     * the output.
+     */
+    uint32_t Track(ns3::Ptr<ns3::BulkSendApplication> app, ns3::Time startTime,
+                   const std::string &label)
+    {
+        uint32_t idx = m_flows.size();
+        m_flows.emplace_back();
+        m_flows.back().label = label;
+        ns3::Simulator::Schedule(startTime, &TcpFlowRecorder::TryAttach, this, app, idx);
+        return idx;
+    }
+
+    // Tracks every BulkSendApplication in the container, labelled by node id.
+    void TrackAll(const ns3::ApplicationContainer &apps, ns3::Time startTime)
+    {
+        for (uint32_t i = 0; i < apps.GetN(); i++)
+        {
+            ns3::Ptr<ns3::BulkSendApplication> app =
+                ns3::DynamicCast<ns3::BulkSendApplication>(apps.Get(i));
+            if (app)
+            {
+                Track(app, startTime, "node" + std::to_string(app->GetNode()->GetId()));
+            }
+        }
+    }
+
+    uint64_t GetSampleCount() const
+    {
+        uint64_t n = 0;
+        for (auto const &f : m_flows)
+        {
+            n += f.timeNs.size();
+        }
+        return n;
+    }
+
+    // One write of every buffered sample.
+    void WriteCsv(const std::string &fileName) const
+    {
+        std::ofstream out(fileName);
+        out << "flow,label,time_s,cwnd,ssthresh,rtt_ms,bytes_in_flight\n";
+        for (uint32_t f = 0; f < m_flows.size(); f++)
+        {
+            const Flow &fl = m_flows[f];
+            for (size_t i = 0; i < fl.timeNs.size(); i++)
+            {
+                out << f << "," << fl.label << "," << fl.timeNs[i] / 1e9 << "," << fl.cwnd[i]
+                    << "," << fl.ssthresh[i] << "," << fl.rttUs[i] / 1e3 << ","
+                    << fl.bytesInFlight[i] << "\n";
+            }
+        }
+    }
+
+  private:
+    struct Flow
+    {
+        std::string label;
+
+        // Current state, updated on every trace event
+        uint32_t curCwnd = 0;
+        uint32_t curSsthresh = 0;
+        uint32_t curRttUs = 0;
+        uint32_t curBytesInFlight = 0;
+        ns3::Time stop; // the application's StopTime, 0 = none
+
+        // Columns
+        std::vector<int64_t> timeNs;
+        std::vector<uint32_t> cwnd;
+        std::vector<uint32_t> ssthresh;
+        std::vector<uint32_t> rttUs;
+        std::vector<uint32_t> bytesInFlight;
+    };
+
+    void TryAttach(ns3::Ptr<ns3::BulkSendApplication> app, uint32_t idx)
+    {
+        using namespace ns3;
+
+        Ptr<Socket> socket = app->GetSocket();
+        if (!socket)
+        {
+            TimeValue start;
+            TimeValue stop;
+            app->GetAttribute("StartTime", start);
+            app->GetAttribute("StopTime", stop);
+            Time now = Simulator::Now();
+            if (!stop.Get().IsZero() && now >= stop.Get())
+            {
+                // Stopped (or never started) without a socket: nothing to trace.
+                return;
+            }
+            // Sleep until the start time, then poll until StartApplication
+            // has run at or just after it.
+            Time wait = now < start.Get() ? start.Get() - now : MicroSeconds(1);
+            Simulator::Schedule(wait, &TcpFlowRecorder::TryAttach, this, app, idx);
+            return;
+        }
+
+        socket->TraceConnectWithoutContext("CongestionWindow",
+                                           MakeBoundCallback(&TcpFlowRecorder::CwndChange, this, idx));
+        socket->TraceConnectWithoutContext("SlowStartThreshold",
+                                           MakeBoundCallback(&TcpFlowRecorder::SsthreshChange, this, idx));
+        socket->TraceConnectWithoutContext("RTT",
+                                           MakeBoundCallback(&TcpFlowRecorder::RttChange, this, idx));
+        socket->TraceConnectWithoutContext("BytesInFlight",
+                                           MakeBoundCallback(&TcpFlowRecorder::InFlightChange, this, idx));
+
+        if (!m_interval.IsZero())
+        {
+            TimeValue stop;
+            app->GetAttribute("StopTime", stop);
+            m_flows[idx].stop = stop.Get();
+            Simulator::Schedule(m_interval, &TcpFlowRecorder::Tick, this, idx);
+        }
+    }
+
+    // One row per interval boundary, holding the latest state
+    void Tick(uint32_t idx)
+    {
+        Append(idx);
+        ns3::Time next = ns3::Simulator::Now() + m_interval;
+        if (m_flows[idx].stop.IsZero() || next <= m_flows[idx].stop)
+        {
+            ns3::Simulator::Schedule(m_interval, &TcpFlowRecorder::Tick, this, idx);
+        }
+    }
+
+    // Without an interval every change is a row
+    void Changed(uint32_t idx)
+    {
+        if (m_interval.IsZero())
+        {
+            Append(idx);
+        }
+    }
+
+    void Append(uint32_t idx)
+    {
+        Flow &f = m_flows[idx];
+        f.timeNs.push_back(ns3::Simulator::Now().GetNanoSeconds());
+        f.cwnd.push_back(f.curCwnd);
+        f.ssthresh.push_back(f.curSsthresh);
+        f.rttUs.push_back(f.curRttUs);
+        f.bytesInFlight.push_back(f.curBytesInFlight);
+    }
+
+    static void CwndChange(TcpFlowRecorder *r, uint32_t idx, uint32_t, uint32_t v)
+    {
+        r->m_flows[idx].curCwnd = v;
+        r->Changed(idx);
+    }
+
+    static void SsthreshChange(TcpFlowRecorder *r, uint32_t idx, uint32_t, uint32_t v)
+    {
+        r->m_flows[idx].curSsthresh = v;
+        r->Changed(idx);
+    }
+
+    static void RttChange(TcpFlowRecorder *r, uint32_t idx, ns3::Time, ns3::Time v)
+    {
+        r->m_flows[idx].curRttUs = static_cast<uint32_t>(v.GetMicroSeconds());
+        r->Changed(idx);
+    }
+
+    static void InFlightChange(TcpFlowRecorder *r, uint32_t idx, uint32_t, uint32_t v)
+    {
+        r->m_flows[idx].curBytesInFlight = v;
+        r->Changed(idx);
+    }
+
+    ns3::Time m_interval;
+    std::vector<Flow> m_flows;
+};
+
+#endif /* TCP_FLOW_RECORDER_H */
@@ -5,56 +5,97 @@
 #include "ns3/applications-module.h"
 #include "ns3/flow-monitor-module.h"
 
+#include "dumbbell-helper.h"
+#include "edge-flow-monitor.h"
+#include "latency-sketch.h"
+#include "replication.h"
+#include "scheduler-select.h"
+#include "steady-state.h"
+#include "tcp-flow-recorder.h"
+#include "flow-window-sampler.h"
+
+#include <memory>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("TcpVsUdpBottleneck");
 
-void CwndTracer(uint32_t oldCwnd, uint32_t newCwnd)
+static const double kStopTime = 10.0;
+
+struct TcpVsUdpOptions
 {
-    std::cout << Simulator::Now().GetSeconds() << "s: CWND changed from "
-              << oldCwnd << " to " << newCwnd << " bytes" << std::endl;
+    uint32_t run = 1;
+    bool verbose = true;
+
+    // Each application start is pushed back by up to startJitter seconds;
+    // the scenario has no other random component, so replications need it.
+    double startJitter = 0.0;
+
+    // cwnd/ssthresh/RTT/bytes-in-flight of both TCP senders, sampled every
+    // cwndInterval seconds (empty file = off)
+    std::string cwndFile = "";
+    double cwndInterval = 0.001;
+
+    // Per-flow throughput/loss/delay every windowInterval seconds
+    // (0 = off), streamed to windowFile
+    double windowInterval = 0.1;
+    std::string windowFile = "tcpvsudp-windows.csv";
+
+    // full: FlowMonitor on every node; edge: EdgeFlowMonitor on the
+    // clients' egress and the server's ingress, drops counted where they
+    // happen
+    std::string monitor = "full";
+
+    // Tail-latency SLO on every flow (sloMs = 0: off)
+    double sloQuantile = 0.99;
+    double sloMs = 0;
+
+    // Stop once the three flows' windowed throughputs are steady (MSER-5);
+    // kStopTime becomes an upper bound and the throughput metrics exclude
+    // the detected warm-up
+    bool autoStop = false;
+    double ssInterval = 0.1;
+    double ssTolerance = 0.05;
+};
+
+/*
+ * Throughput over the time the flow could have been sending: from its first
+ * transmitted packet to the end of the run. Dividing by
+ * timeLastRxPacket - timeFirstTxPacket instead blows up for flows that are
+ * starved or only deliver a packet or two.
+ */
+static double FlowThroughputMbps(const FlowTotals &flow, double stopTime)
+{
+    double span = stopTime - flow.firstTxNs / 1e9;
+    return span > 0 ? flow.rxBytes * 8.0 / span / 1e6 : 0.0;
 }
 
-int main(int argc, char *argv[])
+/*
+ * Runs the TCP-vs-UDP bottleneck once. Returns lost packets, mean delay (s)
+ * and throughput (Mbps) for TCP client 0, TCP client 1 and the UDP flow of
+ * client 1, in that order; the payload carries their delay and jitter
+ * sketches.
+ */
+static ReplicationOutput RunTcpVsUdp(const TcpVsUdpOptions &opt)
 {
-    CommandLine cmd;
-    cmd.Parse(argc, argv);
+    RngSeedManager::SetRun(opt.run);
+
+    Ptr<UniformRandomVariable> jitter = CreateObject<UniformRandomVariable>();
+    jitter->SetAttribute("Min", DoubleValue(0.0));
+    jitter->SetAttribute("Max", DoubleValue(opt.startJitter));
 
-    NodeContainer clients, router, server;
-    clients.Create(2);
-    router.Create(1);
-    server.Create(1);
-
-    // Access links: 100 Mbps
-    PointToPointHelper accessLink;
-    accessLink.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
-    accessLink.SetChannelAttribute("Delay", StringValue("2ms"));
-
-    // Bottleneck link: 5 Mbps, 5-packet queue
-    PointToPointHelper bottleneck;
-    bottleneck.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
-    bottleneck.SetChannelAttribute("Delay", StringValue("10ms"));
-    bottleneck.SetQueue("ns3::DropTailQueue<Packet>",
-                        "MaxSize", QueueSizeValue(QueueSize(QueueSizeUnit::PACKETS, 5)));
-
-    NetDeviceContainer d02 = accessLink.Install(clients.Get(0), router.Get(0));
-    NetDeviceContainer d12 = accessLink.Install(clients.Get(1), router.Get(0));
-    NetDeviceContainer d23 = bottleneck.Install(router.Get(0), server.Get(0));
-
-    InternetStackHelper stack;
-    stack.Install(clients);
-    stack.Install(router);
-    stack.Install(server);
-
-    Ipv4AddressHelper address;
-    address.SetBase("10.1.1.0", "255.255.255.0");
-    address.Assign(d02);
-    address.SetBase("10.1.2.0", "255.255.255.0");
-    address.Assign(d12);
-    address.SetBase("10.1.3.0", "255.255.255.0");
-    Ipv4InterfaceContainer serverIf = address.Assign(d23);
-
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    // Access links: 100 Mbps, bottleneck link: 5 Mbps, 5-packet queue
+    DumbbellConfig cfg;
+    cfg.accessRate = "100Mbps";
+    cfg.accessDelay = "2ms";
+    cfg.bottleneckRate = "5Mbps";
+    cfg.bottleneckDelay = "10ms";
+    cfg.bottleneckDeviceQueue = "5p";
+    Dumbbell dumbbell = BuildDumbbell(cfg);
+
+    NodeContainer &clients = dumbbell.clients;
+    NodeContainer &server = dumbbell.server;
+    Ipv4InterfaceContainer &serverIf = dumbbell.bottleneckInterfaces;
 
     // === TCP Application ===
     uint16_t tcpPort = 9000;
@@ -63,18 +104,27 @@ int main(int argc, char *argv[])
     tcpClientHelper.SetAttribute("MaxBytes", UintegerValue(0)); // unlimited
 
     ApplicationContainer tcpApps = tcpClientHelper.Install(clients);
-    tcpApps.Start(Seconds(1.0));
-    tcpApps.Stop(Seconds(10.0));
+    Time tcpStart[2] = {Seconds(1.0 + jitter->GetValue()), Seconds(1.0 + jitter->GetValue())};
+    tcpApps.Get(0)->SetStartTime(tcpStart[0]);
+    tcpApps.Get(1)->SetStartTime(tcpStart[1]);
+    tcpApps.Stop(Seconds(kStopTime));
 
     PacketSinkHelper tcpSinkHelper("ns3::TcpSocketFactory",
                                    InetSocketAddress(Ipv4Address::GetAny(), tcpPort));
     ApplicationContainer tcpSinks = tcpSinkHelper.Install(server);
     tcpSinks.Start(Seconds(0.0));
-    tcpSinks.Stop(Seconds(10.0));
+    tcpSinks.Stop(Seconds(kStopTime));
 
-    // Trace congestion window of first TCP client
-    Ptr<Socket> tcpSocket = Socket::CreateSocket(clients.Get(0), TcpSocketFactory::GetTypeId());
-    tcpSocket->TraceConnectWithoutContext("CongestionWindow", MakeCallback(&CwndTracer));
+    // Trace the sockets the BulkSend applications actually use
+    TcpFlowRecorder cwndRecorder(Seconds(opt.cwndInterval));
+    if (!opt.cwndFile.empty())
+    {
+        for (uint32_t i = 0; i < tcpApps.GetN(); i++)
+        {
+            cwndRecorder.Track(DynamicCast<BulkSendApplication>(tcpApps.Get(i)), tcpStart[i],
+                               "client" + std::to_string(i));
+        }
+    }
 
     // === UDP Application (comparison) ===
     uint16_t udpPort = 8000;
@@ -86,35 +136,215 @@ int main(int argc, char *argv[])
     udpClient.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0]"));
 
     ApplicationContainer udpApps = udpClient.Install(clients.Get(1));
-    udpApps.Start(Seconds(1.0));
-    udpApps.Stop(Seconds(10.0));
+    udpApps.Start(Seconds(1.0 + jitter->GetValue()));
+    udpApps.Stop(Seconds(kStopTime));
 
     PacketSinkHelper udpSinkHelper("ns3::UdpSocketFactory",
                                    InetSocketAddress(Ipv4Address::GetAny(), udpPort));
     ApplicationContainer udpSinks = udpSinkHelper.Install(server);
     udpSinks.Start(Seconds(0.0));
-    udpSinks.Stop(Seconds(10.0));
+    udpSinks.Stop(Seconds(kStopTime));
+
+    // === Steady-state detection ===
+    SourceRxCounter tcpRx;
+    SteadyStateMonitor steady(Seconds(opt.ssInterval), opt.ssTolerance);
+    if (opt.autoStop)
+    {
+        tcpRx.Track(tcpSinks.Get(0));
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            uint32_t idx = tcpRx.AddSource(dumbbell.accessInterfaces[i].GetAddress(0));
+            steady.AddMetric("TCP client " + std::to_string(i) + " throughput (Mbps)",
+                             WindowedRateMbps(tcpRx.Counter(idx), Seconds(opt.ssInterval)));
+        }
+        Ptr<PacketSink> udpSink = DynamicCast<PacketSink>(udpSinks.Get(0));
+        steady.AddMetric("UDP client 1 throughput (Mbps)",
+                         WindowedRateMbps([udpSink]() { return udpSink->GetTotalRx(); }, Seconds(opt.ssInterval)));
+        steady.SetAutoStop(true);
+        // Measure from the latest possible application start
+        steady.Start(Seconds(1.0 + opt.startJitter));
+    }
+
+    // === Per-packet delay and jitter sketches ===
+    FlowLatencyTracker latency;
+    latency.Install(clients);
+    latency.Install(server);
 
     // === FlowMonitor to measure throughput and packet drops ===
     FlowMonitorHelper flowmon;
-    Ptr<FlowMonitor> monitor = flowmon.InstallAll();
+    Ptr<FlowMonitor> monitor;
+    Ptr<Ipv4FlowClassifier> classifier;
+    EdgeFlowMonitor edge(EDGE_RX_PACKETS | EDGE_RX_BYTES | EDGE_DELAY | EDGE_FIRST_TX | EDGE_DROPS);
+    std::unique_ptr<FlowWindowSampler> windows;
+    if (opt.monitor == "edge")
+    {
+        // Only the clients' egress and the server's ingress are probed per
+        // packet, so the TCP ACKs flowing back are not counted
+        edge.InstallSenders(clients);
+        edge.InstallReceivers(server);
+        edge.InstallDropPoints(NodeContainer::GetGlobal());
+        windows.reset(new FlowWindowSampler(&edge, Seconds(opt.windowInterval)));
+    }
+    else
+    {
+        monitor = flowmon.InstallAll();
+        classifier = DynamicCast<Ipv4FlowClassifier>(flowmon.GetClassifier());
+        windows.reset(new FlowWindowSampler(monitor, classifier, Seconds(opt.windowInterval)));
+    }
+
+    // Convergence / starvation over time, in constant memory
+    if (opt.windowInterval > 0)
+    {
+        if (!opt.windowFile.empty())
+            windows->SetOutput(opt.windowFile);
+        windows->Start(Seconds(1.0));
+    }
 
-    Simulator::Stop(Seconds(10.0));
+    Simulator::Stop(Seconds(kStopTime));
     Simulator::Run();
+    double stopTime = Simulator::Now().GetSeconds();
 
-    monitor->CheckForLostPackets();
-    Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmon.GetClassifier());
-    std::map<FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats();
+    // [TCP client 0, TCP client 1, UDP client 1] x [lost, delay, throughput]
+    std::vector<double> metrics(9, 0.0);
 
-    for (auto it = stats.begin(); it != stats.end(); ++it)
+    std::vector<FlowTotals> totals = monitor ? CollectFlowTotals(monitor, classifier) : CollectFlowTotals(edge);
+    for (const FlowTotals &flow : totals)
     {
-        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(it->first);
-        double throughput = it->second.rxBytes * 8.0 / (it->second.timeLastRxPacket.GetSeconds() - it->second.timeFirstTxPacket.GetSeconds()) / 1e6;
-        std::cout << "Flow " << it->first << " (" << t.sourceAddress << " -> " << t.destinationAddress << ") ";
-        std::cout << "Throughput: " << throughput << " Mbps, Lost packets: " << it->second.lostPackets << std::endl;
+        double throughput = FlowThroughputMbps(flow, stopTime);
+        if (opt.verbose)
+        {
+            std::cout << "Flow " << flow.id << " (" << flow.src << " -> " << flow.dst << ") ";
+            std::cout << "Throughput: " << throughput << " Mbps, Lost packets: " << flow.lostPackets << std::endl;
+        }
+
+        int slot = -1;
+        if (flow.protocol == 6 && flow.src == dumbbell.accessInterfaces[0].GetAddress(0))
+            slot = 0;
+        else if (flow.protocol == 6 && flow.src == dumbbell.accessInterfaces[1].GetAddress(0))
+            slot = 1;
+        else if (flow.protocol == 17 && flow.src == dumbbell.accessInterfaces[1].GetAddress(0))
+            slot = 2;
+        if (slot < 0)
+            continue;
+
+        metrics[3 * slot] = flow.lostPackets;
+        if (flow.rxPackets > 0)
+            metrics[3 * slot + 1] = flow.delaySumNs / 1e9 / flow.rxPackets;
+        metrics[3 * slot + 2] = opt.autoStop ? steady.GetMean(slot) : throughput;
+    }
+
+    if (opt.verbose && opt.autoStop)
+        steady.Print(std::cout);
+
+    FlowLatencyMap flows;
+    flows["TCP client 0"] = latency.GetFlow(dumbbell.accessInterfaces[0].GetAddress(0), 6);
+    flows["TCP client 1"] = latency.GetFlow(dumbbell.accessInterfaces[1].GetAddress(0), 6);
+    flows["UDP client 1"] = latency.GetFlow(dumbbell.accessInterfaces[1].GetAddress(0), 17);
+    if (opt.verbose)
+    {
+        std::cout << "\nLatency:\n";
+        PrintFlowLatency(std::cout, flows);
+    }
+
+    if (!opt.cwndFile.empty())
+    {
+        cwndRecorder.WriteCsv(opt.cwndFile);
+        if (opt.verbose)
+            std::cout << cwndRecorder.GetSampleCount() << " TCP samples written to " << opt.cwndFile << std::endl;
     }
 
     Simulator::Destroy();
-    return 0;
+    return ReplicationOutput{metrics, SerializeFlowLatency(flows)};
 }
 
+int main(int argc, char *argv[])
+{
+    ReplicationConfig rep;
+    rep.maxReplications = 1;
+    double startJitter = 0.1;
+    TcpVsUdpOptions opt;
+    std::string scheduler = "";
+    double schedulerProbe = 3.0;
+
+    CommandLine cmd;
+    cmd.AddValue("run", "RngRun of the (first) replication", rep.firstRun);
+    cmd.AddValue("replications", "Maximum number of replications", rep.maxReplications);
+    cmd.AddValue("minReplications", "Replications before early stop is considered", rep.minReplications);
+    cmd.AddValue("precision", "Stop once CI half-width <= precision * |mean| (0 = never)", rep.relativePrecision);
+    cmd.AddValue("confidence", "Confidence level of the intervals", rep.confidence);
+    cmd.AddValue("jobs", "Replications run concurrently", rep.jobs);
+    cmd.AddValue("startJitter", "Max random start offset (s) per application when replicating", startJitter);
+    cmd.AddValue("cwndFile", "CSV for the TCP cwnd/RTT time series (empty = off)", opt.cwndFile);
+    cmd.AddValue("cwndInterval", "Sampling interval (s) of the cwnd time series (0 = every change)", opt.cwndInterval);
+    cmd.AddValue("windowInterval", "Per-flow statistics window (s, 0 = off)", opt.windowInterval);
+    cmd.AddValue("windowFile", "CSV receiving every per-flow window", opt.windowFile);
+    cmd.AddValue("monitor", "Flow statistics: full (FlowMonitor on every node) or edge (EdgeFlowMonitor)",
+                 opt.monitor);
+    cmd.AddValue("autoStop", "Stop at steady state (MSER-5) instead of at the fixed stop time", opt.autoStop);
+    cmd.AddValue("ssInterval", "Steady-state detection window (s)", opt.ssInterval);
+    cmd.AddValue("ssTolerance", "Steady when every CI half-width <= tolerance * |mean|", opt.ssTolerance);
+    cmd.AddValue("scheduler", "Event scheduler (Map, Heap, List, Calendar, PriorityQueue; auto = fastest in a probe run)",
+                 scheduler);
+    cmd.AddValue("schedulerProbe", "Simulated seconds of each --scheduler=auto probe", schedulerProbe);
+    cmd.AddValue("sloQuantile", "Delay quantile checked against sloMs", opt.sloQuantile);
+    cmd.AddValue("sloMs", "Fail unless every flow's delay quantile is <= sloMs (0 = off)", opt.sloMs);
+    cmd.Parse(argc, argv);
+
+    if (opt.monitor != "full" && opt.monitor != "edge")
+        NS_FATAL_ERROR("Unknown --monitor=" << opt.monitor);
+
+    if (scheduler == "auto")
+    {
+        TcpVsUdpOptions probe = opt;
+        probe.run = rep.firstRun;
+        probe.verbose = false;
+        probe.cwndFile = "";
+        probe.windowInterval = 0;
+        scheduler = SelectScheduler(SplitList(kSchedulerNames), schedulerProbe, [probe]() { RunTcpVsUdp(probe); });
+    }
+
+    if (rep.maxReplications <= 1)
+    {
+        if (!scheduler.empty())
+            UseScheduler(scheduler);
+        opt.run = rep.firstRun;
+        FlowLatencyMap flows;
+        MergeFlowLatency(flows, RunTcpVsUdp(opt).payload);
+        if (opt.sloMs > 0 && !CheckLatencySlo(std::cout, flows, opt.sloQuantile, opt.sloMs))
+            return 1;
+        return 0;
+    }
+
+    // Replications only report the aggregate metrics
+    opt.verbose = false;
+    opt.startJitter = startJitter;
+    opt.cwndFile = "";
+    opt.windowInterval = 0;
+
+    std::vector<std::string> names;
+    for (const char *flow : {"TCP client 0", "TCP client 1", "UDP client 1"})
+    {
+        names.push_back(std::string(flow) + " lost packets");
+        names.push_back(std::string(flow) + " mean delay (s)");
+        names.push_back(std::string(flow) + " throughput (Mbps)");
+    }
+
+    // Sketches merge exactly: quantiles over every packet of every replication
+    FlowLatencyMap flows;
+    std::vector<RunningStat> stats = RunReplications(
+        rep, names,
+        [opt, scheduler](uint32_t run) {
+            if (!scheduler.empty())
+                UseScheduler(scheduler);
+            TcpVsUdpOptions o = opt;
+            o.run = run;
+            return RunTcpVsUdp(o);
+        },
+        [&flows](const std::string &payload) { MergeFlowLatency(flows, payload); });
+    PrintReplicationSummary(rep, names, stats);
+    std::cout << "\nLatency, all replications:\n";
+    PrintFlowLatency(std::cout, flows);
+    if (opt.sloMs > 0 && !CheckLatencySlo(std::cout, flows, opt.sloQuantile, opt.sloMs))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * Scalable topology generator for routing experiments.
+ *
+ * GenerateTopologyGraph() produces the bare graph (node count, edge list,
+ * host set) of
+ *   chain    size nodes in a line
+ *   grid     size x size nodes, 4-neighbour mesh
+ *   fattree  k-ary fat-tree, k = size (even): (k/2)^2 core, k pods of k/2
+ *            aggregation + k/2 edge switches, k/2 hosts per edge switch
+ *   random   BRITE-style Barabasi-Albert graph: size nodes, each new node
+ *            attaches to `degree` existing ones by preferential attachment
+ * and BuildTopology() turns it into ns-3 nodes with point-to-point links,
+ * one /30 per link from 10.0.0.0 (room for a million links). The Internet
+ * stack is installed with whatever routing helper the caller passes in, so
+ * the same graph can be set up with global, Nix-vector or shared-table
+ * routing and compared.
+ */
+
+#ifndef TOPOLOGY_GEN_H
+#define TOPOLOGY_GEN_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct TopologySpec
+{
+    std::string kind = "grid";
+    uint32_t size = 10;
+    uint32_t degree = 2; // random: links per new node
+    std::string rate = "100Mbps";
+    std::string delay = "1ms";
+    uint32_t seed = 1;
+};
+
+struct TopologyGraph
+{
+    uint32_t nNodes = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    // Traffic endpoints: fat-tree hosts, every node otherwise
+    std::vector<uint32_t> hosts;
+};
+
+/* ---------- GRAPHS ---------- */
+
+inline TopologyGraph
+GenerateTopologyGraph(const TopologySpec &spec)
+{
+    TopologyGraph g;
+    uint32_t n = spec.size;
+    if (spec.kind == "chain")
+    {
+        g.nNodes = n;
+        for (uint32_t i = 0; i + 1 < n; i++)
+        {
+            g.edges.emplace_back(i, i + 1);
+        }
+    }
+    else if (spec.kind == "grid")
+    {
+        g.nNodes = n * n;
+        for (uint32_t r = 0; r < n; r++)
+        {
+            for (uint32_t c = 0; c < n; c++)
+            {
+                uint32_t id = r * n + c;
+                if (c + 1 < n)
+                    g.edges.emplace_back(id, id + 1);
+                if (r + 1 < n)
+                    g.edges.emplace_back(id, id + n);
+            }
+        }
+    }
+    else if (spec.kind == "fattree")
+    {
+        NS_ABORT_MSG_IF(n < 2 || n % 2, "fattree needs an even k >= 2");
+        uint32_t half = n / 2;
+        uint32_t nCore = half * half;
+        // Node ids: core, then per pod aggregation and edge, then hosts
+        auto agg = [&](uint32_t pod, uint32_t i) { return nCore + pod * n + i; };
+        auto edge = [&](uint32_t pod, uint32_t i) { return nCore + pod * n + half + i; };
+        uint32_t firstHost = nCore + n * n;
+        g.nNodes = firstHost + n * half * half;
+        for (uint32_t pod = 0; pod < n; pod++)
+        {
+            for (uint32_t a = 0; a < half; a++)
+            {
+                // Aggregation switch a reaches core group a
+                for (uint32_t c = 0; c < half; c++)
+                    g.edges.emplace_back(a * half + c, agg(pod, a));
+                for (uint32_t e = 0; e < half; e++)
+                    g.edges.emplace_back(agg(pod, a), edge(pod, e));
+            }
+            for (uint32_t e = 0; e < half; e++)
+            {
+                for (uint32_t h = 0; h < half; h++)
+                {
+                    uint32_t host = firstHost + (pod * half + e) * half + h;
+                    g.edges.emplace_back(edge(pod, e), host);
+                    g.hosts.push_back(host);
+                }
+            }
+        }
+    }
+    else if (spec.kind == "random")
+    {
+        uint32_t m = std::max<uint32_t>(1, spec.degree);
+        NS_ABORT_MSG_IF(n <= m, "random needs size > degree");
+        g.nNodes = n;
+        std::mt19937 rng(spec.seed);
+        // Every edge endpoint once: sampling it is preferential attachment
+        std::vector<uint32_t> ends;
+        for (uint32_t i = 0; i <= m; i++)
+        {
+            for (uint32_t j = 0; j < i; j++)
+            {
+                g.edges.emplace_back(j, i);
+                ends.push_back(i);
+                ends.push_back(j);
+            }
+        }
+        for (uint32_t v = m + 1; v < n; v++)
+        {
+            std::vector<uint32_t> targets;
+            while (targets.size() < m)
+            {
+                uint32_t t = ends[std::uniform_int_distribution<size_t>(0, ends.size() - 1)(rng)];
+                if (std::find(targets.begin(), targets.end(), t) == targets.end())
+                    targets.push_back(t);
+            }
+            for (uint32_t t : targets)
+            {
+                g.edges.emplace_back(t, v);
+                ends.push_back(t);
+                ends.push_back(v);
+            }
+        }
+    }
+    else
+    {
+        NS_FATAL_ERROR("Unknown topology " << spec.kind);
+    }
+
+    if (g.hosts.empty())
+    {
+        for (uint32_t i = 0; i < g.nNodes; i++)
+            g.hosts.push_back(i);
+    }
+    return g;
+}
+
+/* ---------- NS-3 BUILD ---------- */
+
+struct Topology
+{
+    TopologyGraph graph;
+    ns3::NodeContainer nodes;
+    // links[i] / interfaces[i] belong to graph.edges[i]
+    std::vector<ns3::NetDeviceContainer> links;
+    std::vector<ns3::Ipv4InterfaceContainer> interfaces;
+
+    // An address of node i (its first link's local end)
+    ns3::Ipv4Address Address(uint32_t node) const
+    {
+        return nodes.Get(node)->GetObject<ns3::Ipv4>()->GetAddress(1, 0).GetLocal();
+    }
+};
+
+/*
+ * Creates the nodes, installs `stack` (carrying the routing helper under
+ * test), links and addresses. Routing tables are left to the caller.
+ */
+inline Topology
+BuildTopology(const TopologySpec &spec, ns3::InternetStackHelper &stack)
+{
+    using namespace ns3;
+
+    Topology t;
+    t.graph = GenerateTopologyGraph(spec);
+    t.nodes.Create(t.graph.nNodes);
+    stack.Install(t.nodes);
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue(spec.rate));
+    p2p.SetChannelAttribute("Delay", StringValue(spec.delay));
+
+    Ipv4AddressHelper addr;
+    addr.SetBase("10.0.0.0", "255.255.255.252");
+    t.links.reserve(t.graph.edges.size());
+    t.interfaces.reserve(t.graph.edges.size());
+    for (auto const &e : t.graph.edges)
+    {
+        t.links.push_back(p2p.Install(t.nodes.Get(e.first), t.nodes.Get(e.second)));
+        t.interfaces.push_back(addr.Assign(t.links.back()));
+        addr.NewNetwork();
+    }
+    return t;
+}
+
+#endif /* TOPOLOGY_GEN_H */
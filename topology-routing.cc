@@ -0,0 +1,230 @@
+/*
+ * Routing setup cost on large generated topologies.
+ *
+ * Builds one topology (topology-gen.h: chain, grid, fat-tree or a
+ * BRITE-style random graph) once per routing mode, each in its own forked
+ * process so the heap figures do not mix:
+ *   global  Ipv4GlobalRoutingHelper::PopulateRoutingTables(), an SPF on
+ *           every node and a route per network in every node
+ *   nix     Nix-vector routing, paths computed on demand per destination
+ *           and cached in the packets' nix-vectors
+ *   shared  one SharedRoutingTable for all nodes (shared-routing.h), hop
+ *           counts per host destination precomputed with a BFS each
+ *           (--precompute=false: on first use)
+ *
+ * Then --flows UDP echoes between random host pairs check that every mode
+ * delivers. Per mode it reports wall time for building the topology, the
+ * routing setup and the traffic run, and the heap kept by the routing setup
+ * and grown during the run (on-demand routing pays there), per node.
+ *
+ * Example:
+ *   ./ns3 run "topology-routing --topology=grid --size=100 --routing=global,nix,shared"
+ *   ./ns3 run "topology-routing --topology=fattree --size=16 --flows=1000"
+ *   ./ns3 run "topology-routing --topology=random --size=10000 --degree=2 --routing=nix,shared"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/nix-vector-routing-module.h"
+
+#include "memory-probe.h"
+#include "parallel-runner.h"
+#include "shared-routing.h"
+#include "topology-gen.h"
+
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <set>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("TopologyRouting");
+
+static void
+EchoRx(uint32_t *count, Ptr<const Packet>)
+{
+    (*count)++;
+}
+
+static double
+SecondsSince(std::chrono::steady_clock::time_point t)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+/*
+ * Builds, routes and runs one mode. Returns "buildS routeS runS
+ * routeBytes runBytes delivered".
+ */
+static std::string
+RunRoutingMode(const TopologySpec &spec, const std::string &mode, uint32_t flows, bool precompute)
+{
+    // --- TOPOLOGY ---
+    InternetStackHelper stack;
+    stack.SetIpv6StackInstall(false);
+    Ptr<SharedRoutingTable> table;
+    Ipv4NixVectorHelper nix;
+    Ipv4ListRoutingHelper list;
+    Ipv4StaticRoutingHelper staticRouting;
+    if (mode == "nix")
+    {
+        stack.SetRoutingHelper(nix);
+    }
+    else if (mode == "shared")
+    {
+        table = Create<SharedRoutingTable>();
+        list.Add(staticRouting, 0);
+        list.Add(SharedTableRoutingHelper(table), -10);
+        stack.SetRoutingHelper(list);
+    }
+    else if (mode != "global")
+    {
+        NS_FATAL_ERROR("Unknown routing mode " << mode);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    Topology topo = BuildTopology(spec, stack);
+    double buildS = SecondsSince(t0);
+
+    // Endpoints picked before routing so shared mode can precompute them
+    std::mt19937 rng(spec.seed);
+    std::uniform_int_distribution<size_t> pick(0, topo.graph.hosts.size() - 1);
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    std::set<uint32_t> servers;
+    for (uint32_t i = 0; i < flows && topo.graph.hosts.size() > 1; i++)
+    {
+        uint32_t a = topo.graph.hosts[pick(rng)];
+        uint32_t b = a;
+        while (b == a)
+        {
+            b = topo.graph.hosts[pick(rng)];
+        }
+        pairs.emplace_back(a, b);
+        servers.insert(b);
+    }
+
+    // --- ROUTING ---
+    int64_t heap0 = HeapInUseBytes();
+    t0 = std::chrono::steady_clock::now();
+    if (mode == "global")
+    {
+        Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    }
+    else if (mode == "shared")
+    {
+        table->Build(topo.nodes);
+        if (precompute)
+        {
+            NodeContainer hosts;
+            for (uint32_t h : topo.graph.hosts)
+            {
+                hosts.Add(topo.nodes.Get(h));
+            }
+            table->Precompute(hosts);
+        }
+    }
+    double routeS = SecondsSince(t0);
+    int64_t routeBytes = HeapInUseBytes() - heap0;
+
+    // --- TRAFFIC ---
+    uint16_t port = 9;
+    double appStart = 1.0;
+    UdpEchoServerHelper echoServer(port);
+    for (uint32_t s : servers)
+    {
+        echoServer.Install(topo.nodes.Get(s)).Start(Seconds(0.0));
+    }
+    uint32_t delivered = 0;
+    for (uint32_t i = 0; i < pairs.size(); i++)
+    {
+        UdpEchoClientHelper echoClient(topo.Address(pairs[i].second), port);
+        echoClient.SetAttribute("MaxPackets", UintegerValue(1));
+        echoClient.SetAttribute("PacketSize", UintegerValue(64));
+        ApplicationContainer app = echoClient.Install(topo.nodes.Get(pairs[i].first));
+        app.Start(Seconds(appStart + i * 1e-4));
+        app.Get(0)->TraceConnectWithoutContext("Rx", MakeBoundCallback(&EchoRx, &delivered));
+    }
+
+    int64_t heap1 = HeapInUseBytes();
+    t0 = std::chrono::steady_clock::now();
+    Simulator::Stop(Seconds(appStart + pairs.size() * 1e-4 + 10.0));
+    Simulator::Run();
+    double runS = SecondsSince(t0);
+    int64_t runBytes = HeapInUseBytes() - heap1;
+    Simulator::Destroy();
+
+    std::ostringstream out;
+    out << buildS << " " << routeS << " " << runS << " " << routeBytes << " " << runBytes << " "
+        << delivered;
+    return out.str();
+}
+
+int main(int argc, char *argv[])
+{
+    // --- 1. CONFIGURATION ---
+    TopologySpec spec;
+    std::string routing = "global,nix,shared";
+    uint32_t flows = 100;
+    bool precompute = true;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("topology", "chain, grid, fattree or random", spec.kind);
+    cmd.AddValue("size", "chain/random: nodes, grid: side, fattree: k", spec.size);
+    cmd.AddValue("degree", "random: links per new node", spec.degree);
+    cmd.AddValue("rate", "Link rate", spec.rate);
+    cmd.AddValue("delay", "Link delay", spec.delay);
+    cmd.AddValue("seed", "Seed for the random graph and the echo pairs", spec.seed);
+    cmd.AddValue("routing", "Comma-separated modes: global, nix, shared", routing);
+    cmd.AddValue("flows", "UDP echoes between random host pairs", flows);
+    cmd.AddValue("precompute", "shared: compute host destinations during setup", precompute);
+    cmd.Parse(argc, argv);
+
+    TopologyGraph graph = GenerateTopologyGraph(spec);
+    std::cout << spec.kind << " " << spec.size << ": " << graph.nNodes << " nodes, " << graph.edges.size()
+              << " links, " << graph.hosts.size() << " hosts, " << flows << " echo flows" << std::endl;
+
+    // --- 2. RUN (one mode at a time, so wall times are comparable) ---
+    std::vector<std::string> modes = SplitList(routing);
+    std::vector<std::string> rows(modes.size());
+    RunParallel(
+        modes.size(), 1,
+        [&](uint32_t i) { return RunRoutingMode(spec, modes[i], flows, precompute); },
+        [&](const ParallelJobResult &r) {
+            rows[r.index] = r.ok ? r.output : "";
+            return true;
+        });
+
+    // --- 3. REPORT ---
+    std::cout << std::left << std::setw(8) << "routing" << std::right << std::setw(10) << "build_s"
+              << std::setw(10) << "route_s" << std::setw(10) << "run_s" << std::setw(14) << "route_B/node"
+              << std::setw(14) << "run_B/node" << std::setw(12) << "delivered" << "\n";
+    int status = 0;
+    for (size_t i = 0; i < modes.size(); i++)
+    {
+        std::istringstream in(rows[i]);
+        double buildS, routeS, runS;
+        int64_t routeBytes, runBytes;
+        uint32_t delivered;
+        if (!(in >> buildS >> routeS >> runS >> routeBytes >> runBytes >> delivered))
+        {
+            std::cout << std::left << std::setw(8) << modes[i] << std::right << "  FAILED\n";
+            status = 1;
+            continue;
+        }
+        std::cout << std::left << std::setw(8) << modes[i] << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << buildS << std::setw(10) << routeS << std::setw(10) << runS
+                  << std::setprecision(0) << std::setw(14) << double(routeBytes) / graph.nNodes
+                  << std::setw(14) << double(runBytes) / graph.nNodes << std::defaultfloat
+                  << std::setw(12) << (std::to_string(delivered) + "/" + std::to_string(flows)) << "\n";
+        if (delivered < flows)
+        {
+            status = 1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,247 @@
+/*
+ * Query tool for the binary packet traces written by BinaryTraceSink
+ * (binary-trace.h), e.g. by multihop-routing and point-to-pointdelay.
+ *
+ * The file is memory-mapped and scanned once as an array of fixed records,
+ * so even multi-gigabyte traces are answered without parsing any text.
+ *
+ * To run:
+ *   ./ns3 run "trace-query --input=mesh-routing-analysis.pkt"                (summary)
+ *   ./ns3 run "trace-query --input=mesh-routing-analysis.pkt --uid=0"        (path of one packet)
+ *   ./ns3 run "trace-query --input=mesh-routing-analysis.pkt --query=hops"   (per-hop delay)
+ *   ./ns3 run "trace-query --input=mesh-routing-analysis.pkt --query=dump --node=1"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include "binary-trace.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+
+using namespace ns3;
+
+static const char *kEventNames[] = {"enqueue", "tx", "rx", "drop"};
+
+static void
+PrintRecord(const PacketTraceRecord &r)
+{
+    std::cout << std::fixed << std::setprecision(9) << r.timeNs / 1e9 << " node " << r.node
+              << " dev " << r.device << " " << std::setw(7) << std::left
+              << kEventNames[r.event & 3] << std::right << " uid " << r.uid << " "
+              << Ipv4Address(r.src) << ":" << r.srcPort << " -> " << Ipv4Address(r.dst) << ":"
+              << r.dstPort << " proto " << unsigned(r.protocol) << " " << r.size << " B\n";
+}
+
+/* ---------- QUERIES ---------- */
+
+static void
+Summary(const PacketTraceRecord *recs, size_t n)
+{
+    std::map<uint32_t, std::array<uint64_t, 4>> perNode;
+    for (size_t i = 0; i < n; i++)
+    {
+        perNode[recs[i].node][recs[i].event & 3]++;
+    }
+    std::cout << "node,enqueue,tx,rx,drop\n";
+    for (auto const &nd : perNode)
+    {
+        std::cout << nd.first << "," << nd.second[0] << "," << nd.second[1] << ","
+                  << nd.second[2] << "," << nd.second[3] << "\n";
+    }
+    if (n > 0)
+    {
+        std::cerr << n << " records, " << recs[0].timeNs / 1e9 << " s to "
+                  << recs[n - 1].timeNs / 1e9 << " s" << std::endl;
+    }
+}
+
+// Records are written in event order, so a packet's path is its records in file order.
+static void
+Path(const PacketTraceRecord *recs, size_t n, uint64_t uid)
+{
+    int64_t first = -1;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (recs[i].uid != uid)
+        {
+            continue;
+        }
+        if (first < 0)
+        {
+            first = recs[i].timeNs;
+        }
+        std::cout << "+" << std::fixed << std::setprecision(6) << (recs[i].timeNs - first) / 1e6
+                  << " ms  ";
+        PrintRecord(recs[i]);
+    }
+    if (first < 0)
+    {
+        std::cerr << "uid " << uid << " not in trace (sampled out or filtered?)" << std::endl;
+    }
+}
+
+/*
+ * Per-hop delay: time from a packet being handed to a device on node A
+ * (enqueue, or tx when enqueue events were filtered out) to its reception
+ * on the next node B. Includes queueing, transmission and propagation.
+ */
+static void
+HopDelays(const PacketTraceRecord *recs, size_t n)
+{
+    struct Departure
+    {
+        int64_t timeNs;
+        uint32_t node;
+        uint16_t device;
+    };
+    struct Hop
+    {
+        uint64_t count = 0;
+        double sumMs = 0;
+        double minMs = 1e300;
+        double maxMs = 0;
+    };
+
+    std::unordered_map<uint64_t, Departure> inFlight;
+    std::map<std::pair<uint64_t, uint32_t>, Hop> hops; // ((node << 16 | dev), next node)
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const PacketTraceRecord &r = recs[i];
+        if (r.event == TRACE_ENQUEUE || r.event == TRACE_TX)
+        {
+            auto it = inFlight.find(r.uid);
+            // Keep the enqueue time when the tx record of the same hop follows.
+            if (it == inFlight.end() || it->second.node != r.node || it->second.device != r.device ||
+                r.event == TRACE_ENQUEUE)
+            {
+                inFlight[r.uid] = Departure{r.timeNs, r.node, r.device};
+            }
+        }
+        else if (r.event == TRACE_RX)
+        {
+            auto it = inFlight.find(r.uid);
+            if (it == inFlight.end())
+            {
+                continue;
+            }
+            double ms = (r.timeNs - it->second.timeNs) / 1e6;
+            Hop &h = hops[std::make_pair((uint64_t(it->second.node) << 16) | it->second.device, r.node)];
+            h.count++;
+            h.sumMs += ms;
+            h.minMs = std::min(h.minMs, ms);
+            h.maxMs = std::max(h.maxMs, ms);
+            inFlight.erase(it);
+        }
+        else
+        {
+            inFlight.erase(r.uid);
+        }
+    }
+
+    std::cout << "from_node,from_dev,to_node,packets,mean_ms,min_ms,max_ms\n";
+    for (auto const &h : hops)
+    {
+        std::cout << (h.first.first >> 16) << "," << (h.first.first & 0xffff) << ","
+                  << h.first.second << "," << h.second.count << ","
+                  << h.second.sumMs / h.second.count << "," << h.second.minMs << ","
+                  << h.second.maxMs << "\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string input = "";
+    std::string query = "summary";
+    int64_t uid = -1;
+    int64_t node = -1;
+    std::string events = "all";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "Packet trace written by BinaryTraceSink", input);
+    cmd.AddValue("query", "summary, hops or dump", query);
+    cmd.AddValue("uid", "Print the path of the packet with this uid", uid);
+    cmd.AddValue("node", "dump: only records of this node", node);
+    cmd.AddValue("events", "dump: comma-separated events (enqueue,tx,rx,drop or all)", events);
+    cmd.Parse(argc, argv);
+
+    int fd = open(input.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        std::cerr << "Cannot open " << input << std::endl;
+        return 1;
+    }
+    size_t fileSize = st.st_size;
+    if (fileSize < sizeof(PacketTraceFileHeader))
+    {
+        std::cerr << input << " is not a packet trace" << std::endl;
+        close(fd);
+        return 1;
+    }
+
+    void *map = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << "Cannot map " << input << std::endl;
+        return 1;
+    }
+    madvise(map, fileSize, MADV_SEQUENTIAL);
+
+    const PacketTraceFileHeader *hdr = static_cast<const PacketTraceFileHeader *>(map);
+    if (std::memcmp(hdr->magic, kPacketTraceMagic, sizeof(hdr->magic)) != 0 || hdr->version != kPacketTraceVersion ||
+        hdr->recordSize != sizeof(PacketTraceRecord))
+    {
+        std::cerr << input << " is not a version-" << kPacketTraceVersion << " packet trace" << std::endl;
+        munmap(map, fileSize);
+        return 1;
+    }
+
+    const PacketTraceRecord *recs = reinterpret_cast<const PacketTraceRecord *>(hdr + 1);
+    size_t n = (fileSize - sizeof(PacketTraceFileHeader)) / sizeof(PacketTraceRecord);
+
+    if (uid >= 0)
+    {
+        Path(recs, n, uid);
+    }
+    else if (query == "hops")
+    {
+        HopDelays(recs, n);
+    }
+    else if (query == "dump")
+    {
+        uint32_t mask = ParseTraceEvents(events);
+        for (size_t i = 0; i < n; i++)
+        {
+            if ((node < 0 || recs[i].node == node) && (mask & (1 << recs[i].event)))
+            {
+                PrintRecord(recs[i]);
+            }
+        }
+    }
+    else if (query == "summary")
+    {
+        Summary(recs, n);
+    }
+    else
+    {
+        std::cerr << "Unknown query " << query << std::endl;
+        munmap(map, fileSize);
+        return 1;
+    }
+
+    munmap(map, fileSize);
+    return 0;
+}
@@ -0,0 +1,418 @@
+/*
+ * Trace-driven traffic: replays recorded packets (timestamp, size,
+ * 5-tuple) onto a simulated topology.
+ *
+ * Input is a flat binary file (ReplayTraceHeader followed by time-sorted
+ * 24-byte ReplayRecords) that is memory-mapped, never read into RAM:
+ * pages are faulted in as the replay cursor reaches them and handed back
+ * (MADV_DONTNEED) once it has passed, so the resident part of a trace of
+ * hundreds of millions of packets stays a few MB. ConvertCsvReplayTrace()
+ * produces the file from CSV exports.
+ *
+ * TraceReplayer keeps only a sliding window of upcoming sends in the event
+ * queue: it schedules the first `window` records, and every send schedules
+ * the next unscheduled one, so pending events never exceed the window
+ * however long the trace is.
+ *
+ * The trace's addresses do not exist in the simulation, so every flow is
+ * mapped by hashing: the 5-tuple picks the sender node (a flow always
+ * leaves from the same node) and the destination address picks the
+ * receiver. Each trace flow gets its own UDP socket, bound to the recorded
+ * source port (an ephemeral one if that port is taken on the node) and
+ * sending to the recorded destination port, so flows stay distinct
+ * 5-tuples for ECMP and per-flow monitors. Sockets are opened on a flow's
+ * first packet and at most maxSockets stay open; the least recently used
+ * one is closed to make room. The receiver opens a counting socket on
+ * every destination port it is sent to. Packets go out as UDP datagrams
+ * whose IP size is the recorded size; the recorded protocol only tells
+ * flows apart, and TCP dynamics are not replayed, only the timing.
+ */
+
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* ---------- FILE FORMAT ---------- */
+
+static const char kReplayTraceMagic[8] = {'P', 'K', 'T', 'R', 'P', 'L', '0', '1'};
+
+struct ReplayTraceHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+};
+
+struct ReplayRecord
+{
+    uint64_t timeNs; // since the start of the trace
+    uint32_t src;    // IPv4 addresses, host order
+    uint32_t dst;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint16_t size; // IP packet size (bytes)
+    uint8_t protocol;
+    uint8_t reserved;
+};
+
+static_assert(sizeof(ReplayRecord) == 24, "ReplayRecord layout changed");
+
+/*
+ * Converts CSV lines "time_s,src,dst,src_port,dst_port,protocol,size"
+ * (dotted-quad addresses; a non-numeric first line is taken as a header)
+ * into the binary format. Records must already be in time order. Returns
+ * the number of records written.
+ */
+inline uint64_t
+ConvertCsvReplayTrace(const std::string &csvFile, const std::string &binFile)
+{
+    std::ifstream in(csvFile);
+    NS_ABORT_MSG_IF(!in, "Cannot open " << csvFile);
+    std::ofstream out(binFile, std::ios::binary);
+    NS_ABORT_MSG_IF(!out, "Cannot create " << binFile);
+
+    ReplayTraceHeader h;
+    std::memcpy(h.magic, kReplayTraceMagic, sizeof(h.magic));
+    h.version = 1;
+    h.recordSize = sizeof(ReplayRecord);
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+    std::string line;
+    uint64_t n = 0;
+    uint64_t lineNo = 0;
+    double first = -1;
+    uint64_t lastNs = 0;
+    while (std::getline(in, line))
+    {
+        lineNo++;
+        if (line.empty() || (lineNo == 1 && !std::isdigit(static_cast<unsigned char>(line[0]))))
+        {
+            continue;
+        }
+        std::vector<std::string> f;
+        std::stringstream ss(line);
+        std::string item;
+        while (std::getline(ss, item, ','))
+        {
+            f.push_back(item);
+        }
+        NS_ABORT_MSG_IF(f.size() < 7, csvFile << ":" << lineNo << ": expected 7 fields");
+
+        double t = std::stod(f[0]);
+        if (first < 0)
+        {
+            first = t;
+        }
+        ReplayRecord r;
+        std::memset(&r, 0, sizeof(r));
+        r.timeNs = uint64_t((t - first) * 1e9 + 0.5);
+        r.src = ns3::Ipv4Address(f[1].c_str()).Get();
+        r.dst = ns3::Ipv4Address(f[2].c_str()).Get();
+        r.srcPort = std::stoul(f[3]);
+        r.dstPort = std::stoul(f[4]);
+        r.protocol = std::stoul(f[5]);
+        r.size = std::min<unsigned long>(std::stoul(f[6]), 65535);
+        NS_ABORT_MSG_IF(r.timeNs < lastNs, csvFile << ":" << lineNo << ": records out of time order");
+        lastNs = r.timeNs;
+        out.write(reinterpret_cast<const char *>(&r), sizeof(r));
+        n++;
+    }
+    return n;
+}
+
+/* ---------- MAPPED FILE ---------- */
+
+class ReplayTraceFile
+{
+  public:
+    explicit ReplayTraceFile(const std::string &fileName)
+    {
+        int fd = open(fileName.c_str(), O_RDONLY);
+        NS_ABORT_MSG_IF(fd < 0, "Cannot open replay trace " << fileName);
+        struct stat st;
+        fstat(fd, &st);
+        m_size = st.st_size;
+        NS_ABORT_MSG_IF(m_size < sizeof(ReplayTraceHeader), fileName << " is not a replay trace");
+        m_base = static_cast<const char *>(mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0));
+        close(fd);
+        NS_ABORT_MSG_IF(m_base == MAP_FAILED, "Cannot map " << fileName);
+        madvise(const_cast<char *>(m_base), m_size, MADV_SEQUENTIAL);
+
+        const ReplayTraceHeader *h = reinterpret_cast<const ReplayTraceHeader *>(m_base);
+        NS_ABORT_MSG_IF(std::memcmp(h->magic, kReplayTraceMagic, sizeof(h->magic)) != 0 || h->version != 1 ||
+                            h->recordSize != sizeof(ReplayRecord),
+                        fileName << " is not a version-1 replay trace");
+        m_records = reinterpret_cast<const ReplayRecord *>(m_base + sizeof(ReplayTraceHeader));
+        m_count = (m_size - sizeof(ReplayTraceHeader)) / sizeof(ReplayRecord);
+    }
+
+    ~ReplayTraceFile()
+    {
+        munmap(const_cast<char *>(m_base), m_size);
+    }
+
+    ReplayTraceFile(const ReplayTraceFile &) = delete;
+    ReplayTraceFile &operator=(const ReplayTraceFile &) = delete;
+
+    uint64_t GetCount() const { return m_count; }
+
+    const ReplayRecord &Get(uint64_t i) const { return m_records[i]; }
+
+    // Drops the pages holding records [0, upTo) from memory
+    void Release(uint64_t upTo)
+    {
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t end = (sizeof(ReplayTraceHeader) + upTo * sizeof(ReplayRecord)) / page * page;
+        if (end > m_released)
+        {
+            madvise(const_cast<char *>(m_base) + m_released, end - m_released, MADV_DONTNEED);
+            m_released = end;
+        }
+    }
+
+  private:
+    const char *m_base = nullptr;
+    size_t m_size = 0;
+    size_t m_released = 0;
+    const ReplayRecord *m_records = nullptr;
+    uint64_t m_count = 0;
+};
+
+/* ---------- REPLAYER ---------- */
+
+class TraceReplayer
+{
+  public:
+    TraceReplayer(const std::string &fileName, uint32_t window = 1024, uint32_t maxSockets = 4096)
+        : m_file(fileName),
+          m_window(window),
+          m_maxSockets(std::max<uint32_t>(maxSockets, 1))
+    {
+    }
+
+    void AddSender(ns3::Ptr<ns3::Node> node) { m_senders.push_back(node); }
+
+    void AddSenders(const ns3::NodeContainer &nodes)
+    {
+        for (uint32_t i = 0; i < nodes.GetN(); i++)
+        {
+            AddSender(nodes.Get(i));
+        }
+    }
+
+    // addr must be one of node's addresses
+    void AddReceiver(ns3::Ptr<ns3::Node> node, ns3::Ipv4Address addr) { m_receivers.push_back({node, addr, {}}); }
+
+    // Simulated time = scale * trace time
+    void SetTimeScale(double scale) { m_scale = scale; }
+
+    // Replay at most this many records (0 = all)
+    void SetLimit(uint64_t records) { m_limit = records; }
+
+    uint64_t GetRecordCount() const
+    {
+        return m_limit ? std::min(m_limit, m_file.GetCount()) : m_file.GetCount();
+    }
+
+    // Simulated duration of the replayed part
+    ns3::Time GetDuration() const
+    {
+        uint64_t n = GetRecordCount();
+        return n ? ns3::NanoSeconds(int64_t(m_file.Get(n - 1).timeNs * m_scale)) : ns3::Time(0);
+    }
+
+    uint64_t GetSent() const { return m_sent; }
+
+    uint64_t GetSentBytes() const { return m_sentBytes; }
+
+    // UDP payload bytes, what a PacketSink counts
+    uint64_t GetSentPayloadBytes() const { return m_sentPayload; }
+
+    // UDP payload bytes received on the receivers' per-port sockets
+    uint64_t GetReceivedPayloadBytes() const { return m_receivedPayload; }
+
+    // Sender sockets opened, one per flow (again after an LRU close)
+    uint64_t GetSocketsOpened() const { return m_socketsOpened; }
+
+    void Start(ns3::Time at)
+    {
+        NS_ABORT_MSG_IF(m_senders.empty() || m_receivers.empty(), "TraceReplayer needs senders and receivers");
+        m_start = at;
+        ns3::Simulator::Schedule(at - ns3::Simulator::Now(), &TraceReplayer::Open, this);
+    }
+
+  private:
+    // The recorded 5-tuple: addresses, then ports and protocol
+    typedef std::pair<uint64_t, uint64_t> FlowKey;
+
+    struct FlowKeyHash
+    {
+        size_t operator()(const FlowKey &k) const
+        {
+            return HashMix(uint32_t(k.first >> 32), uint32_t(k.first), uint32_t(k.second >> 32),
+                           uint32_t(k.second));
+        }
+    };
+
+    struct FlowSocket
+    {
+        FlowKey key;
+        ns3::Ptr<ns3::Socket> socket;
+    };
+
+    struct Receiver
+    {
+        ns3::Ptr<ns3::Node> node;
+        ns3::Ipv4Address addr;
+        std::map<uint16_t, ns3::Ptr<ns3::Socket>> ports;
+    };
+
+    void Open()
+    {
+        uint64_t first = std::min<uint64_t>(m_window, GetRecordCount());
+        for (uint64_t i = 0; i < first; i++)
+        {
+            ScheduleNext();
+        }
+    }
+
+    void ScheduleNext()
+    {
+        if (m_next >= GetRecordCount())
+        {
+            return;
+        }
+        ns3::Time at = m_start + ns3::NanoSeconds(int64_t(m_file.Get(m_next).timeNs * m_scale));
+        ns3::Simulator::Schedule(at - ns3::Simulator::Now(), &TraceReplayer::Send, this, m_next);
+        m_next++;
+    }
+
+    void Send(uint64_t i)
+    {
+        const ReplayRecord &r = m_file.Get(i);
+        Receiver &rx = m_receivers[HashMix(r.dst, 0, 0, 0) % m_receivers.size()];
+        Listen(rx, r.dstPort);
+
+        // UDP (8) + IP (20) headers are added below the socket
+        uint32_t payload = r.size > 28 ? r.size - 28 : 0;
+        ns3::Ptr<ns3::Socket> socket = FlowSocketFor(r);
+        if (socket->SendTo(ns3::Create<ns3::Packet>(payload), 0, ns3::InetSocketAddress(rx.addr, r.dstPort)) >= 0)
+        {
+            m_sent++;
+            m_sentBytes += r.size;
+            m_sentPayload += payload;
+        }
+
+        // Records are consumed in order; give back what lies behind
+        if ((i & 0xffff) == 0)
+        {
+            m_file.Release(i);
+        }
+        ScheduleNext();
+    }
+
+    // The flow's socket, opened (and the least recently used one closed) if needed
+    ns3::Ptr<ns3::Socket> FlowSocketFor(const ReplayRecord &r)
+    {
+        FlowKey key((uint64_t(r.src) << 32) | r.dst,
+                    (uint64_t(r.srcPort) << 32) | (uint64_t(r.dstPort) << 16) | r.protocol);
+        auto it = m_flowIndex.find(key);
+        if (it != m_flowIndex.end())
+        {
+            m_flowLru.splice(m_flowLru.begin(), m_flowLru, it->second);
+            return it->second->socket;
+        }
+
+        if (m_flowIndex.size() >= m_maxSockets)
+        {
+            m_flowLru.back().socket->Close();
+            m_flowIndex.erase(m_flowLru.back().key);
+            m_flowLru.pop_back();
+        }
+
+        uint64_t flow = HashMix(r.src, r.dst, (uint32_t(r.srcPort) << 16) | r.dstPort, r.protocol);
+        ns3::Ptr<ns3::Node> node = m_senders[flow % m_senders.size()];
+        ns3::Ptr<ns3::Socket> socket = ns3::Socket::CreateSocket(node, ns3::UdpSocketFactory::GetTypeId());
+        if (socket->Bind(ns3::InetSocketAddress(ns3::Ipv4Address::GetAny(), r.srcPort)) < 0)
+        {
+            // Port 0, or taken by another flow mapped to this node
+            socket->Bind();
+        }
+        m_socketsOpened++;
+        m_flowLru.push_front({key, socket});
+        m_flowIndex[key] = m_flowLru.begin();
+        return socket;
+    }
+
+    void Listen(Receiver &rx, uint16_t port)
+    {
+        if (rx.ports.count(port))
+        {
+            return;
+        }
+        ns3::Ptr<ns3::Socket> socket = ns3::Socket::CreateSocket(rx.node, ns3::UdpSocketFactory::GetTypeId());
+        if (socket->Bind(ns3::InetSocketAddress(ns3::Ipv4Address::GetAny(), port)) == 0)
+        {
+            socket->SetRecvCallback(ns3::MakeCallback(&TraceReplayer::Received, this));
+        }
+        rx.ports[port] = socket;
+    }
+
+    void Received(ns3::Ptr<ns3::Socket> socket)
+    {
+        ns3::Ptr<ns3::Packet> p;
+        while ((p = socket->Recv()))
+        {
+            m_receivedPayload += p->GetSize();
+        }
+    }
+
+    static uint64_t HashMix(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+    {
+        uint64_t h = 0x9e3779b97f4a7c15ULL;
+        for (uint64_t v : {a, b, c, d})
+        {
+            h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h *= 0xff51afd7ed558ccdULL;
+        }
+        return h ^ (h >> 33);
+    }
+
+    ReplayTraceFile m_file;
+    uint32_t m_window;
+    uint32_t m_maxSockets;
+    double m_scale = 1.0;
+    uint64_t m_limit = 0;
+    ns3::Time m_start;
+    uint64_t m_next = 0;
+    uint64_t m_sent = 0;
+    uint64_t m_sentBytes = 0;
+    uint64_t m_sentPayload = 0;
+    uint64_t m_receivedPayload = 0;
+    uint64_t m_socketsOpened = 0;
+    std::vector<ns3::Ptr<ns3::Node>> m_senders;
+    std::vector<Receiver> m_receivers;
+    std::list<FlowSocket> m_flowLru; // most recently used first
+    std::unordered_map<FlowKey, std::list<FlowSocket>::iterator, FlowKeyHash> m_flowIndex;
+};
+
+#endif /* TRACE_REPLAY_H */